@@ -36,6 +36,7 @@ namespace directx {
 		D3DMULTISAMPLE_TYPE typeMultiSample;
 
 		bool bUseRef;
+		bool bUseNullDevice;		//Resources are created but nothing is rasterized, for headless runs
 		bool bUseTripleBuffer;
 		bool bVSync;
 
@@ -92,6 +92,11 @@ bool DirectSoundManager::Initialize(HWND hWnd) {
 	thisBase_ = this;
 	return true;
 }
+void DirectSoundManager::SetMute(bool bMute) {
+	Lock lock(lock_);
+	if (pDirectSoundPrimaryBuffer_)
+		pDirectSoundPrimaryBuffer_->SetVolume(bMute ? DSBVOLUME_MIN : DSBVOLUME_MAX);
+}
 void DirectSoundManager::Clear() {
 	try {
 		Lock lock(lock_);
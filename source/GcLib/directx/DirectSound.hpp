@@ -64,6 +64,8 @@ namespace directx {
 		virtual bool Initialize(HWND hWnd);
 		void Clear();
 
+		void SetMute(bool bMute);
+
 		const DSCAPS* GetDeviceCaps() const { return &dxSoundCaps_; }
 
 		IDirectSound8* GetDirectSound() { return pDirectSound_; }
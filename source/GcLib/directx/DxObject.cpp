@@ -20,6 +20,10 @@ DxScriptObjectBase::DxScriptObjectBase() {
 	idScript_ = ScriptClientBase::ID_SCRIPT_FREE;
 	typeObject_ = TypeObject::Base;
 
+	maskClass_ = 0;
+	offsetMixin_.fill(0);
+	_AddObjectClass<DxScriptObjectBase>(this);
+
 	bDelete_ = false;
 	bActive_ = false;
 	bVisible_ = true;
@@ -55,6 +59,7 @@ double DxScriptObjectBase::GetRenderPriority() {
 //DxScriptRenderObject
 //****************************************************************************
 DxScriptRenderObject::DxScriptRenderObject() {
+	_AddObjectClass<DxScriptRenderObject>(this);
 	bZWrite_ = false;
 	bZTest_ = false;
 	bFogEnable_ = false;
@@ -121,6 +126,7 @@ void DxScriptShaderObject::Clone(DxScriptObjectBase* _src) {
 //DxScriptPrimitiveObject
 //****************************************************************************
 DxScriptPrimitiveObject::DxScriptPrimitiveObject() {
+	_AddObjectClass<DxScriptPrimitiveObject>(this);
 	angX_ = D3DXVECTOR2(1, 0);
 	angY_ = D3DXVECTOR2(1, 0);
 	angZ_ = D3DXVECTOR2(1, 0);
@@ -263,6 +269,7 @@ void DxScriptPrimitiveObject2D::SetPermitCamera(bool bPermit) {
 //DxScriptSpriteObject2D
 //****************************************************************************
 DxScriptSpriteObject2D::DxScriptSpriteObject2D() {
+	_AddObjectClass<DxScriptSpriteObject2D>(this);
 	typeObject_ = TypeObject::Sprite2D;
 	objRender_ = make_shared<Sprite2D>();
 	objRender_->SetDxObjectReference(this);
@@ -272,6 +279,7 @@ DxScriptSpriteObject2D::DxScriptSpriteObject2D() {
 //DxScriptSpriteListObject2D
 //****************************************************************************
 DxScriptSpriteListObject2D::DxScriptSpriteListObject2D() {
+	_AddObjectClass<DxScriptSpriteListObject2D>(this);
 	typeObject_ = TypeObject::SpriteList2D;
 	objRender_ = make_shared<SpriteList2D>();
 	objRender_->SetDxObjectReference(this);
@@ -429,6 +437,7 @@ D3DXVECTOR3 DxScriptPrimitiveObject3D::GetVertexPosition(size_t index) {
 //DxScriptSpriteObject3D
 //****************************************************************************
 DxScriptSpriteObject3D::DxScriptSpriteObject3D() {
+	_AddObjectClass<DxScriptSpriteObject3D>(this);
 	typeObject_ = TypeObject::Sprite3D;
 	objRender_ = make_shared<Sprite3D>();
 	objRender_->SetDxObjectReference(this);
@@ -438,6 +447,7 @@ DxScriptSpriteObject3D::DxScriptSpriteObject3D() {
 //DxScriptTrajectoryObject3D
 //****************************************************************************
 DxScriptTrajectoryObject3D::DxScriptTrajectoryObject3D() {
+	_AddObjectClass<DxScriptTrajectoryObject3D>(this);
 	typeObject_ = TypeObject::Trajectory3D;
 	objRender_ = make_shared<TrajectoryObject3D>();
 	color_ = 0xffffffff;
@@ -578,6 +588,7 @@ void DxScriptParticleListObject3D::CleanUp() {
 //DxScriptMeshObject
 //****************************************************************************
 DxScriptMeshObject::DxScriptMeshObject() {
+	_AddObjectClass<DxScriptMeshObject>(this);
 	typeObject_ = TypeObject::Mesh;
 	bZWrite_ = true;
 	bZTest_ = true;
@@ -685,6 +696,7 @@ void DxScriptMeshObject::SetAngleZ(float z) {
 //DxScriptTextObject
 //****************************************************************************
 DxScriptTextObject::DxScriptTextObject() {
+	_AddObjectClass<DxScriptTextObject>(this);
 	typeObject_ = TypeObject::Text;
 	change_ = CHANGE_ALL;
 	bAutoCenter_ = true;
@@ -857,6 +869,7 @@ void DxScriptTextObject::SetAngleZ(float z) {
 //DxSoundObject
 //****************************************************************************
 DxSoundObject::DxSoundObject() {
+	_AddObjectClass<DxSoundObject>(this);
 	typeObject_ = TypeObject::Sound;
 }
 DxSoundObject::~DxSoundObject() {
@@ -923,6 +936,7 @@ void DxSoundObject::Play() {
 //DxFileObject
 //****************************************************************************
 DxFileObject::DxFileObject() {
+	_AddObjectClass<DxFileObject>(this);
 	bWritable_ = false;
 }
 DxFileObject::~DxFileObject() {
@@ -999,6 +1013,7 @@ void DxFileObject::Close() {
 //DxTextFileObject
 //****************************************************************************
 DxTextFileObject::DxTextFileObject() {
+	_AddObjectClass<DxTextFileObject>(this);
 	typeObject_ = TypeObject::FileText;
 	encoding_ = Encoding::UTF16LE;
 	bomSize_ = 2U;
@@ -1340,6 +1355,7 @@ void DxTextFileObject::AddLine(const std::wstring& line) {
 //DxBinaryFileObject
 //****************************************************************************
 DxBinaryFileObject::DxBinaryFileObject() {
+	_AddObjectClass<DxBinaryFileObject>(this);
 	typeObject_ = TypeObject::FileBinary;
 	byteOrder_ = ByteOrder::ENDIAN_LITTLE;
 	codePage_ = CP_ACP;
@@ -1374,11 +1390,13 @@ bool DxBinaryFileObject::OpenR(const std::wstring& path) {
 bool DxBinaryFileObject::OpenR(shared_ptr<gstd::FileReader> reader) {
 	reader_ = reader;
 
-	auto srcBuffer = dynamic_cast<ManagedFileReader*>(reader.get())->GetBuffer();
-
 	size_t size = reader->GetFileSize();
 
-	buffer_ = ByteBuffer(*srcBuffer);
+	buffer_ = ByteBuffer(size);
+	if (size > 0) {
+		reader->SetFilePointerBegin();
+		reader->Read(buffer_.GetPointer(), size);
+	}
 	
 	return true;
 }
@@ -1528,6 +1546,7 @@ void DxScriptObjectManager::_DeleteObject(int id) {
 	if (pObj == nullptr) return;
 
 	pObj->bDelete_ = true;
+	pObj->_OnDelete();
 	if (pObj->manager_)
 		pObj->manager_->listUnusedIndex_.push_back(id);
 
@@ -1547,6 +1566,7 @@ void DxScriptObjectManager::DeleteObject(DxScriptObjectBase* obj) {
 	if (obj == nullptr) return;
 	obj->bDelete_ = true;
 	obj->bActive_ = false;
+	obj->_OnDelete();
 	listDeleteObject_.push_back(obj->idObject_);
 }
 
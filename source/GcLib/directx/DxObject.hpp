@@ -15,12 +15,27 @@ namespace directx {
 	class DxScriptObjectManager;
 	class DxScriptObjectBase;
 
+	//Tags a class for DxScriptObjectBase::As, every class passed to As must carry its own tag
+#define DECLARE_OBJECT_CLASS(_class, _id) \
+	public: \
+		using _ObjectClass = _class; \
+		static constexpr uint64_t CLASS_BIT = 1ULL << (uint8_t)(_id);
+	//Tags a class inherited by script objects alongside DxScriptObjectBase, casts to it go through a stored offset
+#define DECLARE_OBJECT_MIXIN(_class, _id, _index) \
+	DECLARE_OBJECT_CLASS(_class, _id) \
+		static constexpr size_t MIXIN_INDEX = _index;
+
 	//****************************************************************************
 	//DxScriptObjectBase
 	//****************************************************************************
 	class DxScriptObjectBase {
 		friend DxScript;
 		friend DxScriptObjectManager;
+		DECLARE_OBJECT_CLASS(DxScriptObjectBase, TypeClass::Base);
+	public:
+		enum {
+			MAX_OBJECT_MIXIN = 2,
+		};
 	protected:
 		DxScriptObjectManager* manager_;
 
@@ -28,6 +43,9 @@ namespace directx {
 		TypeObject typeObject_;
 		int64_t idScript_;
 
+		uint64_t maskClass_;
+		std::array<int32_t, MAX_OBJECT_MIXIN> offsetMixin_;
+
 		bool bDelete_;
 		bool bActive_;
 		bool bVisible_;
@@ -35,12 +53,38 @@ namespace directx {
 
 		uint32_t frameExist_;
 
-		std::unordered_map<std::wstring, gstd::value> mapObjectValue_;
+		gstd::script_value_table mapObjectValue_;
 		std::unordered_map<int64_t, gstd::value> mapObjectValueI_;
+
+		//Called when the object gets marked for deletion
+		virtual void _OnDelete() {}
+
+		//Called by the constructor of every tagged class, mixins are passed as the converted this
+		template<class T> void _AddObjectClass(T* self) {
+			maskClass_ |= T::CLASS_BIT;
+			if constexpr (!std::is_base_of_v<DxScriptObjectBase, T>)
+				offsetMixin_[T::MIXIN_INDEX] = (int32_t)((byte*)self - (byte*)this);
+		}
 	public:
 		DxScriptObjectBase();
 		virtual ~DxScriptObjectBase();
 
+		//Replaces dynamic_cast<T*>(this) with a mask test and a static_cast or offset
+		template<class T> T* As() {
+			static_assert(std::is_same_v<typename T::_ObjectClass, T>, "Class lacks DECLARE_OBJECT_CLASS");
+
+			T* res = nullptr;
+			if (maskClass_ & T::CLASS_BIT) {
+				if constexpr (std::is_base_of_v<DxScriptObjectBase, T>)
+					res = static_cast<T*>(this);
+				else
+					res = (T*)((byte*)this + offsetMixin_[T::MIXIN_INDEX]);
+			}
+			assert(res == dynamic_cast<T*>(this));
+			return res;
+		}
+		uint64_t GetClassMask() { return maskClass_; }
+
 		void SetObjectManager(DxScriptObjectManager* manager) { manager_ = manager; }
 		
 		virtual void Initialize() {}
@@ -69,7 +113,7 @@ namespace directx {
 
 		uint32_t GetExistFrame() { return frameExist_; }
 
-		std::unordered_map<std::wstring, gstd::value>& GetValueMap() { return mapObjectValue_; }
+		gstd::script_value_table& GetValueMap() { return mapObjectValue_; }
 		std::unordered_map<int64_t, gstd::value>& GetValueMapI() { return mapObjectValueI_; }
 	};
 
@@ -98,6 +142,7 @@ namespace directx {
 		bool bEnableMatrix_;
 
 		gstd::ref_count_weak_ptr<DxScriptRenderObject, false> objRelative_;
+		DECLARE_OBJECT_CLASS(DxScriptRenderObject, TypeClass::Render);
 	public:
 		DxScriptRenderObject();
 
@@ -177,6 +222,7 @@ namespace directx {
 		D3DXVECTOR2 angX_;
 		D3DXVECTOR2 angY_;
 		D3DXVECTOR2 angZ_;
+		DECLARE_OBJECT_CLASS(DxScriptPrimitiveObject, TypeClass::Primitive);
 	public:
 		DxScriptPrimitiveObject();
 
@@ -247,6 +293,7 @@ namespace directx {
 	//DxScriptSpriteObject2D
 	//****************************************************************************
 	class DxScriptSpriteObject2D : public DxScriptPrimitiveObject2D {
+		DECLARE_OBJECT_CLASS(DxScriptSpriteObject2D, TypeClass::Sprite2D);
 	public:
 		DxScriptSpriteObject2D();
 
@@ -257,6 +304,7 @@ namespace directx {
 	//DxScriptSpriteListObject2D
 	//****************************************************************************
 	class DxScriptSpriteListObject2D : public DxScriptPrimitiveObject2D {
+		DECLARE_OBJECT_CLASS(DxScriptSpriteListObject2D, TypeClass::SpriteList2D);
 	public:
 		DxScriptSpriteListObject2D();
 
@@ -299,6 +347,7 @@ namespace directx {
 	//DxScriptSpriteObject3D
 	//****************************************************************************
 	class DxScriptSpriteObject3D : public DxScriptPrimitiveObject3D {
+		DECLARE_OBJECT_CLASS(DxScriptSpriteObject3D, TypeClass::Sprite3D);
 	public:
 		DxScriptSpriteObject3D();
 
@@ -309,6 +358,7 @@ namespace directx {
 	//DxScriptTrajectoryObject3D
 	//****************************************************************************
 	class DxScriptTrajectoryObject3D : public DxScriptPrimitiveObject {
+		DECLARE_OBJECT_CLASS(DxScriptTrajectoryObject3D, TypeClass::Trajectory3D);
 	public:
 		DxScriptTrajectoryObject3D();
 
@@ -381,6 +431,7 @@ namespace directx {
 		D3DXVECTOR2 angX_;
 		D3DXVECTOR2 angY_;
 		D3DXVECTOR2 angZ_;
+		DECLARE_OBJECT_CLASS(DxScriptMeshObject, TypeClass::Mesh);
 	public:
 		DxScriptMeshObject();
 
@@ -449,6 +500,7 @@ namespace directx {
 		D3DXVECTOR2 angZ_;
 
 		void _UpdateRenderer();
+		DECLARE_OBJECT_CLASS(DxScriptTextObject, TypeClass::Text);
 	public:
 		DxScriptTextObject();
 
@@ -536,6 +588,7 @@ namespace directx {
 		std::unordered_map<SoundSourceData*, weak_ptr<SoundPlayer>> mapCachedPlayers_;
 		shared_ptr<SoundPlayer> player_;
 		SoundPlayer::PlayStyle style_;
+		DECLARE_OBJECT_CLASS(DxSoundObject, TypeClass::Sound);
 	public:
 		DxSoundObject();
 		~DxSoundObject();
@@ -562,6 +615,7 @@ namespace directx {
 		shared_ptr<gstd::File> file_;
 		shared_ptr<gstd::FileReader> reader_;
 		bool bWritable_;
+		DECLARE_OBJECT_CLASS(DxFileObject, TypeClass::File);
 	public:
 		DxFileObject();
 		virtual ~DxFileObject();
@@ -598,6 +652,7 @@ namespace directx {
 
 		bool _ParseLines(std::vector<char>& src);
 		void _AddLine(const char* pChar, size_t count);
+		DECLARE_OBJECT_CLASS(DxTextFileObject, TypeClass::FileText);
 	public:
 		DxTextFileObject();
 		virtual ~DxTextFileObject();
@@ -630,6 +685,7 @@ namespace directx {
 
 		gstd::ByteBuffer buffer_;
 		size_t lastRead_;
+		DECLARE_OBJECT_CLASS(DxBinaryFileObject, TypeClass::FileBinary);
 	public:
 		DxBinaryFileObject();
 		virtual ~DxBinaryFileObject();
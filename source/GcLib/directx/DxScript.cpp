@@ -2553,12 +2553,8 @@ gstd::value DxScript::Func_Obj_GetValue(gstd::script_machine* machine, int argc,
 	DxScriptObjectBase* obj = script->GetObjectPointer(id);
 	if (obj) {
 		if constexpr (!INTEGER) {
-			std::wstring key = argv[1].as_string();
-
-			auto& pValueMap = obj->GetValueMap();
-			auto itr = pValueMap.find(key);
-			if (itr != pValueMap.end())
-				return itr->second;
+			if (value* pValue = obj->GetValueMap().find(argv[1]))
+				return *pValue;
 		}
 		else {
 			int64_t key = argv[1].as_int();
@@ -2582,10 +2578,8 @@ gstd::value DxScript::Func_Obj_SetValue(gstd::script_machine* machine, int argc,
 	DxScriptObjectBase* obj = script->GetObjectPointer(id);
 	if (obj) {
 		if constexpr (!INTEGER) {
-			std::wstring key = argv[1].as_string();
-
 			auto& pValueMap = obj->GetValueMap();
-			pValueMap[key] = val;
+			pValueMap[argv[1]] = val;
 		}
 		else {
 			int64_t key = argv[1].as_int();
@@ -2605,10 +2599,7 @@ gstd::value DxScript::Func_Obj_DeleteValue(gstd::script_machine* machine, int ar
 	DxScriptObjectBase* obj = script->GetObjectPointer(id);
 	if (obj) {
 		if constexpr (!INTEGER) {
-			std::wstring key = argv[1].as_string();
-
-			auto& pValueMap = obj->GetValueMap();
-			pValueMap.erase(key);
+			obj->GetValueMap().erase(argv[1]);
 		}
 		else {
 			int64_t key = argv[1].as_int();
@@ -2630,10 +2621,7 @@ gstd::value DxScript::Func_Obj_IsValueExists(gstd::script_machine* machine, int
 	DxScriptObjectBase* obj = script->GetObjectPointer(id);
 	if (obj) {
 		if constexpr (!INTEGER) {
-			std::wstring key = argv[1].as_string();
-
-			auto& pValueMap = obj->GetValueMap();
-			res = pValueMap.find(key) != pValueMap.end();
+			res = obj->GetValueMap().find(argv[1]) != nullptr;
 		}
 		else {
 			int64_t key = argv[1].as_int();
@@ -2662,8 +2650,8 @@ gstd::value DxScript::Func_Obj_GetValueCount(gstd::script_machine* machine, int
 	return script->CreateIntValue(res);
 }
 
-template<typename T>
-static void _CopyValueTable(std::unordered_map<T, gstd::value>& srcMap, std::unordered_map<T, gstd::value>& dstMap, int mode) {
+template<typename TMap>
+static void _CopyValueTable(TMap& srcMap, TMap& dstMap, int mode) {
 	//Mode 0 - Clear dest and copy
 	if (mode == 0) {
 		dstMap.clear();
@@ -2689,6 +2677,12 @@ static void _CopyValueTable(std::unordered_map<T, gstd::value>& srcMap, std::uno
 		}
 	}
 }
+static void _CopyValueTable(gstd::script_value_table& srcMap, gstd::script_value_table& dstMap, int mode) {
+	if (&srcMap == &dstMap || mode < 0 || mode > 2) return;
+	if (mode == 0)
+		dstMap.clear();
+	dstMap.insert_from(srcMap, mode != 2);
+}
 
 template<bool INTEGER>
 gstd::value DxScript::Func_Obj_CopyValueTable(gstd::script_machine* machine, int argc, const gstd::value* argv) {
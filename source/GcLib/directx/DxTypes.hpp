@@ -132,6 +132,43 @@ namespace directx {
 		Invalid = 0xff,
 	};
 
+	//Class IDs for DxScriptObjectBase::As. Unlike TypeObject, intermediate classes get their own IDs,
+	//	and an object carries the bits of every tagged class it derives from.
+	enum class TypeClass : uint8_t {
+		Base,
+
+		Render,
+		Primitive,
+		Sprite2D,
+		SpriteList2D,
+		Sprite3D,
+		Trajectory3D,
+		Mesh,
+		Text,
+		Sound,
+		File,
+		FileText,
+		FileBinary,
+
+		//------------------------------
+
+		Move,
+		Intersection,
+
+		Player,
+		PlayerSpell,
+		Enemy,
+		EnemyBossScene,
+		Shot,
+		NormalShot,
+		Laser,
+		StraightLaser,
+		CurveLaser,
+		ShotPattern,
+		Item,
+		ItemUser,
+	};
+
 	//*******************************************************************
 	//DxText
 	//*******************************************************************
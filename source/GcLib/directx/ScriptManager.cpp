@@ -5,6 +5,99 @@
 using namespace gstd;
 using namespace directx;
 
+//*******************************************************************
+//ScriptLoadThreadPool
+//*******************************************************************
+ScriptLoadThreadPool::ScriptLoadThreadPool(size_t countWorker) {
+	for (size_t i = 0; i < countWorker; ++i) {
+		listWorker_.push_back(make_unique<Worker>(this));
+		listWorker_.back()->Start();
+	}
+}
+ScriptLoadThreadPool::~ScriptLoadThreadPool() {
+	for (auto& pWorker : listWorker_)
+		pWorker->Stop();
+	signal_.SetSignal();
+	for (auto& pWorker : listWorker_)
+		pWorker->Join();
+	listWorker_.clear();
+}
+
+ScriptLoadThreadPool* ScriptLoadThreadPool::GetBase() {
+	//Leave one core to the main thread
+	static ScriptLoadThreadPool pool(std::clamp<size_t>(
+		std::thread::hardware_concurrency(), 2, MAX_WORKER + 1) - 1);
+	return &pool;
+}
+
+shared_ptr<FileManager::LoadThreadEvent> ScriptLoadThreadPool::_BeginEvent() {
+	Lock lock(lock_);
+	while (listEvent_.size() > 0) {
+		shared_ptr<FileManager::LoadThreadEvent> event = listEvent_.front();
+		listEvent_.pop_front();
+
+		FileManager::LoadThreadListener* listener = event->GetListener();
+		if (setListener_.find(listener) == setListener_.end()) continue;
+
+		{
+			std::lock_guard<std::mutex> lockRunning(mtxRunning_);
+			++mapRunningCount_[listener];
+		}
+		return event;
+	}
+	return nullptr;
+}
+void ScriptLoadThreadPool::_EndEvent(FileManager::LoadThreadListener* listener) {
+	{
+		std::lock_guard<std::mutex> lockRunning(mtxRunning_);
+		auto itr = mapRunningCount_.find(listener);
+		if (itr == mapRunningCount_.end() || --(itr->second) > 0) return;
+		mapRunningCount_.erase(itr);
+	}
+	cvRunning_.notify_all();
+}
+
+void ScriptLoadThreadPool::AddEvent(shared_ptr<FileManager::LoadThreadEvent> event) {
+	{
+		Lock lock(lock_);
+		listEvent_.push_back(event);
+	}
+	signal_.SetSignal();
+}
+void ScriptLoadThreadPool::AddListener(FileManager::LoadThreadListener* listener) {
+	Lock lock(lock_);
+	setListener_.insert(listener);
+}
+void ScriptLoadThreadPool::RemoveListener(FileManager::LoadThreadListener* listener) {
+	{
+		Lock lock(lock_);
+		setListener_.erase(listener);
+		listEvent_.remove_if([&](shared_ptr<FileManager::LoadThreadEvent>& event) {
+			return event->GetListener() == listener;
+		});
+	}
+
+	//Wait for the events already handed to workers, no new ones can start past this point
+	std::unique_lock<std::mutex> lockRunning(mtxRunning_);
+	cvRunning_.wait(lockRunning, [&]() {
+		return mapRunningCount_.find(listener) == mapRunningCount_.end();
+	});
+}
+
+void ScriptLoadThreadPool::Worker::_Run() {
+	while (this->GetStatus() == RUN) {
+		shared_ptr<FileManager::LoadThreadEvent> event = pool_->_BeginEvent();
+		if (event == nullptr) {
+			pool_->signal_.Wait(10);
+			continue;
+		}
+
+		FileManager::LoadThreadListener* listener = event->GetListener();
+		listener->CallFromLoadThread(event);
+		pool_->_EndEvent(listener);
+	}
+}
+
 //*******************************************************************
 //ScriptManager
 //*******************************************************************
@@ -17,11 +110,11 @@ ScriptManager::ScriptManager() {
 
 	bHasCloseScriptWork_ = false;
 
-	FileManager::GetBase()->AddLoadThreadListener(this);
+	ScriptLoadThreadPool::GetBase()->AddListener(this);
 }
 ScriptManager::~ScriptManager() {
 	//this->WaitForCancel();
-	FileManager::GetBase()->RemoveLoadThreadListener(this);
+	ScriptLoadThreadPool::GetBase()->RemoveListener(this);
 }
 
 void ScriptManager::Work() {
@@ -237,8 +330,15 @@ int64_t ScriptManager::_LoadScript(const std::wstring& path, shared_ptr<ManagedS
 	script->Compile();
 
 	std::map<std::string, script_block*>::iterator itrEvent;
-	if (script->IsEventExists("Loading", itrEvent))
-		script->Run(itrEvent);
+	if (script->IsEventExists("Loading", itrEvent)) {
+		if (GetCurrentThreadId() != mainThreadID_) {
+			Lock lock(ScriptLoadThreadPool::GetBase()->GetEventLock());
+			script->Run(itrEvent);
+		}
+		else {
+			script->Run(itrEvent);
+		}
+	}
 
 	script->bLoad_ = true;
 	script->bRunning_ = false;
@@ -273,7 +373,7 @@ int64_t ScriptManager::LoadScriptInThread(const std::wstring& path, shared_ptr<M
 		mapScriptLoad_[res] = script;
 
 		shared_ptr<FileManager::LoadThreadEvent> event(new FileManager::LoadThreadEvent(this, path, script));
-		FileManager::GetBase()->AddLoadThreadEvent(event);
+		ScriptLoadThreadPool::GetBase()->AddEvent(event);
 	}
 	return res;
 }
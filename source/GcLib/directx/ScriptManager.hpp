@@ -6,6 +6,56 @@
 
 namespace directx {
 	class ManagedScript;
+	//*******************************************************************
+	//ScriptLoadThreadPool
+	//	Worker threads that load and compile scripts queued by LoadScriptInThread
+	//*******************************************************************
+	class ScriptLoadThreadPool {
+	public:
+		enum {
+			MAX_WORKER = 4,
+		};
+	private:
+		class Worker : public gstd::Thread {
+			ScriptLoadThreadPool* pool_;
+		protected:
+			virtual void _Run();
+		public:
+			Worker(ScriptLoadThreadPool* pool) : pool_(pool) {}
+		};
+
+		gstd::CriticalSection lock_;
+		gstd::CriticalSection lockEvent_;
+		gstd::ThreadSignal signal_;
+
+		std::list<shared_ptr<gstd::FileManager::LoadThreadEvent>> listEvent_;
+		std::set<gstd::FileManager::LoadThreadListener*> setListener_;
+
+		//Events handed to workers, per listener. Increments happen under lock_ as well.
+		std::mutex mtxRunning_;
+		std::condition_variable cvRunning_;
+		std::map<gstd::FileManager::LoadThreadListener*, size_t> mapRunningCount_;
+
+		std::vector<unique_ptr<Worker>> listWorker_;
+
+		shared_ptr<gstd::FileManager::LoadThreadEvent> _BeginEvent();
+		void _EndEvent(gstd::FileManager::LoadThreadListener* listener);
+	public:
+		ScriptLoadThreadPool(size_t countWorker);
+		~ScriptLoadThreadPool();
+
+		static ScriptLoadThreadPool* GetBase();
+
+		void AddEvent(shared_ptr<gstd::FileManager::LoadThreadEvent> event);
+		void AddListener(gstd::FileManager::LoadThreadListener* listener);
+		void RemoveListener(gstd::FileManager::LoadThreadListener* listener);
+
+		size_t GetWorkerCount() { return listWorker_.size(); }
+
+		//Compilation is parallel, but script events run by the workers are kept one at a time
+		gstd::CriticalSection& GetEventLock() { return lockEvent_; }
+	};
+
 	//*******************************************************************
 	//ScriptManager
 	//*******************************************************************
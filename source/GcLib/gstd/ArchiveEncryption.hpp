@@ -33,6 +33,14 @@ namespace gstd {
 				base = (byte)(((uint32_t)base + (uint32_t)step) % 0x100);
 			}
 		}
+		//Decrypts count bytes starting at offset within a block into dest, src is left untouched
+		static void ShiftBlockCopy(const byte* src, byte* dest, size_t count, size_t offset, byte base, byte step) {
+			base = (byte)(((uint32_t)base + (uint32_t)step * (uint32_t)(offset & 0xff)) % 0x100);
+			for (size_t i = 0; i < count; ++i) {
+				dest[i] = src[i] ^ base;
+				base = (byte)(((uint32_t)base + (uint32_t)step) % 0x100);
+			}
+		}
 	};
 	inline const std::string ArchiveEncryption::ARCHIVE_ENCRYPTION_KEY = "Mima for Touhou 18";
 }
\ No newline at end of file
@@ -22,8 +22,13 @@ void ArchiveFileEntry::_WriteEntryRecord(std::stringstream& buf) {
 
 	buf.write((char*)&keyBase, sizeof(uint8_t));
 	buf.write((char*)&keyStep, sizeof(uint8_t));
+
+	uint32_t chunkCount = listChunkSize.size();
+	buf.write((char*)&chunkCount, sizeof(uint32_t));
+	if (chunkCount > 0)
+		buf.write((char*)listChunkSize.data(), chunkCount * sizeof(uint32_t));
 }
-void ArchiveFileEntry::_ReadEntryRecord(std::stringstream& buf) {
+void ArchiveFileEntry::_ReadEntryRecord(std::stringstream& buf, uint32_t version) {
 	uint32_t pathSize = 0U;
 	buf.read((char*)&pathSize, sizeof(uint32_t));
 	path.resize(pathSize);
@@ -36,6 +41,42 @@ void ArchiveFileEntry::_ReadEntryRecord(std::stringstream& buf) {
 
 	buf.read((char*)&keyBase, sizeof(uint8_t));
 	buf.read((char*)&keyStep, sizeof(uint8_t));
+
+	listChunkSize.clear();
+	listChunkOffset.clear();
+
+	//Older archives store CT_ZLIB entries as a single stream
+	if (version == DATA_VERSION_ARCHIVE_UNCHUNKED) {
+		if (!buf) throw wexception("Truncated archive entry record");
+		return;
+	}
+
+	uint32_t chunkCount = 0U;
+	buf.read((char*)&chunkCount, sizeof(uint32_t));
+	if (!buf) throw wexception("Truncated archive entry record");
+
+	//Every chunk but the last is full, and only compressed entries have chunks
+	size_t chunkCountExpected = compressionType == CT_ZLIB ?
+		((size_t)sizeFull + CHUNK_SIZE - 1) / CHUNK_SIZE : 0;
+	if (chunkCount != chunkCountExpected)
+		throw wexception("Invalid archive entry chunk count");
+
+	listChunkSize.resize(chunkCount);
+	listChunkOffset.resize(chunkCount);
+	if (chunkCount > 0) {
+		buf.read((char*)listChunkSize.data(), chunkCount * sizeof(uint32_t));
+		if (!buf) throw wexception("Truncated archive entry record");
+	}
+
+	uint64_t offset = 0U;
+	for (size_t iChunk = 0; iChunk < chunkCount; ++iChunk) {
+		listChunkOffset[iChunk] = (uint32_t)offset;
+		offset += listChunkSize[iChunk];
+		if (offset > sizeStored)
+			throw wexception("Archive entry chunk out of bounds");
+	}
+	if (chunkCount > 0 && offset != sizeStored)
+		throw wexception("Archive entry chunk table doesn't match its stored size");
 }
 
 //*******************************************************************
@@ -49,274 +90,332 @@ FileArchiver::~FileArchiver() {
 bool FileArchiver::CreateArchiveFile(const std::wstring& baseDir, const std::wstring& pathArchive,
 	CbSetStatus cbStatus, CbSetProgress cbProgress)
 {
-	bool res = true;
-
 	if (cbStatus)
 		cbStatus(L"");
 	if (cbProgress)
 		cbProgress(0.0f);
 
-	if (cbStatus)
-		cbStatus(L"Writing header");
-
 	uint8_t headerKeyBase = 0;
 	uint8_t headerKeyStep = 0;
 	ArchiveEncryption::GetKeyHashHeader(ArchiveEncryption::ARCHIVE_ENCRYPTION_KEY, headerKeyBase, headerKeyStep);
 
-	std::wstring pathTmp = StringUtility::Format(L"%s_tmp", pathArchive.c_str());
-	std::fstream fileArchiveTmp;
-	fileArchiveTmp.open(pathTmp, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+	if (cbStatus)
+		cbStatus(L"Scanning files");
+
+	struct ChunkJob {
+		ArchiveFileEntry* entry;
+		const std::wstring* path;
+		size_t offset;
+		size_t size;
+	};
+	std::vector<std::wstring> listFilePath;
+	std::vector<ChunkJob> listJob;
+
+	listFilePath.reserve(listEntry_.size());
+	for (auto& entry : listEntry_) {
+		std::wstring filePath = baseDir + entry->path;
+
+		std::ifstream file;
+		file.open(filePath, std::ios::binary);
+		if (!file.is_open())
+			throw gstd::wexception(StringUtility::Format(L"Cannot open file for reading. [%s]", entry->path.c_str()));
+
+		file.seekg(0, std::ios::end);
+		entry->sizeFull = file.tellg();
+		entry->sizeStored = 0;
+		entry->listChunkSize.clear();
+		file.close();
+
+		{
+			std::wstring strHash = StringUtility::Format(L"%s%u",
+				filePath.c_str(), entry->sizeFull ^ 0xe54f077a);
+			ArchiveEncryption::GetKeyHashFile(StringUtility::ConvertWideToMulti(strHash).c_str(),
+				headerKeyBase, headerKeyStep, entry->keyBase, entry->keyStep);
+		}
+
+		//Small files actually get bigger upon compression.
+		if (entry->sizeFull < 0x100) entry->compressionType = ArchiveFileEntry::CT_NONE;
+
+		listFilePath.push_back(filePath);
+		for (size_t offset = 0; offset < entry->sizeFull; offset += ArchiveFileEntry::CHUNK_SIZE) {
+			listJob.push_back(ChunkJob{ entry.get(), &listFilePath.back(), offset,
+				std::min<size_t>(ArchiveFileEntry::CHUNK_SIZE, entry->sizeFull - offset) });
+		}
+	}
 
-	if (!fileArchiveTmp.is_open()) {
+	std::ofstream fileArchive;
+	fileArchive.open(pathArchive, std::ios::binary | std::ios::trunc);
+	if (!fileArchive.is_open()) {
 		throw gstd::wexception(StringUtility::Format(L"Cannot create an archive at [%s].",
 			pathArchive.c_str()).c_str());
 	}
 
+	//Workers read and compress chunks ahead of the writer, bounded by a window
+	size_t countWorker = std::max(std::thread::hardware_concurrency(), 1U);
+	const size_t sizeWindow = countWorker * 4;
+
+	std::vector<unique_ptr<ByteBuffer>> listResult(listJob.size());
+	std::mutex mtxJob;
+	std::condition_variable cvJobDone;
+	std::condition_variable cvWindow;
+	size_t iNextJob = 0;
+	size_t iWritten = 0;
+	bool bAbort = false;
+	std::wstring errorJob;
+
+	auto _Work = [&]() {
+		std::vector<char> bufRead(ArchiveFileEntry::CHUNK_SIZE);
+		while (true) {
+			size_t iJob = 0;
+			{
+				std::unique_lock<std::mutex> lock(mtxJob);
+				cvWindow.wait(lock, [&]() {
+					return bAbort || iNextJob >= listJob.size() || iNextJob < iWritten + sizeWindow;
+				});
+				if (bAbort || iNextJob >= listJob.size()) return;
+				iJob = iNextJob++;
+			}
+
+			const ChunkJob& job = listJob[iJob];
+			auto res = make_unique<ByteBuffer>();
+			std::wstring error;
+
+			std::ifstream file;
+			file.open(*job.path, std::ios::binary);
+			file.seekg(job.offset, std::ios::beg);
+			file.read(bufRead.data(), job.size);
+			if (!file.is_open() || (size_t)file.gcount() != job.size) {
+				error = StringUtility::Format(L"Cannot read file. [%s]", job.entry->path.c_str());
+			}
+			else if (job.entry->compressionType == ArchiveFileEntry::CT_ZLIB) {
+				auto oRes = CompressorStream::Deflate(bufRead.data(), job.size, *res);
+				if (!oRes || *oRes == 0)
+					error = StringUtility::Format(L"CompressorStream::Deflate failed. [%s]", job.entry->path.c_str());
+			}
+			else {
+				res->Write(bufRead.data(), job.size);
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(mtxJob);
+				if (error.size() > 0) {
+					bAbort = true;
+					errorJob = error;
+				}
+				else {
+					listResult[iJob] = MOVE(res);
+				}
+			}
+			cvJobDone.notify_all();
+			if (error.size() > 0)
+				cvWindow.notify_all();
+		}
+	};
+
+	std::vector<std::thread> listWorker;
+	for (size_t i = 0; i < countWorker; ++i)
+		listWorker.push_back(std::thread(_Work));
+	auto _StopWorkers = [&]() {
+		{
+			std::lock_guard<std::mutex> lock(mtxJob);
+			bAbort = true;
+		}
+		cvWindow.notify_all();
+		for (auto& worker : listWorker) {
+			if (worker.joinable())
+				worker.join();
+		}
+	};
+
 	try {
 		ArchiveFileHeader header{};
 
 		memcpy(header.magic, ArchiveEncryption::HEADER_ARCHIVEFILE, ArchiveFileHeader::MAGIC_LENGTH);
 		header.version = DATA_VERSION_ARCHIVE;
 		header.entryCount = listEntry_.size();
-		//header.headerCompressed = true;
-		header.headerOffset = 0U;
-		header.headerSize = 0U;
 
-		fileArchiveTmp.write((char*)&header, sizeof(ArchiveFileHeader));
+		//Placeholder, rewritten once the info offset is known
+		fileArchive.write((char*)&header, sizeof(ArchiveFileHeader));
 
 		if (cbProgress)
-			cbProgress(0.1f);
-		float progressStep = (0.75f - 0.10f) / (float)listEntry_.size();
+			cbProgress(0.05f);
+		float progressStep = (0.9f - 0.05f) / (float)std::max<size_t>(listJob.size(), 1);
 
-		std::streampos sDataBegin = fileArchiveTmp.tellp();
-
-		size_t iEntry = 0;
-		//Write the files and record their information.
+		size_t iJob = 0;
 		for (auto& entry : listEntry_) {
-			if (cbStatus) {
-				std::wstring name = entry->path;
-				cbStatus(StringUtility::Format(L"Processing [%s]", name.c_str()));
-			}
+			if (cbStatus)
+				cbStatus(StringUtility::Format(L"Processing [%s]", entry->path.c_str()));
 
-			std::wstring filePath = baseDir + entry->path;
+			entry->offsetPos = fileArchive.tellp();
 
-			std::ifstream file;
-			file.open(filePath, std::ios::binary);
-			if (!file.is_open())
-				throw gstd::wexception(StringUtility::Format(L"Cannot open file for reading. [%s]", entry->path.c_str()));
-
-			file.seekg(0, std::ios::end);
-			entry->sizeFull = file.tellg();
-			entry->sizeStored = entry->sizeFull;
-			entry->offsetPos = fileArchiveTmp.tellp();
-			file.seekg(0, std::ios::beg);
-
-			byte localKeyBase = 0;
-			byte localKeyStep = 0;
-			{
-				std::wstring strHash = StringUtility::Format(L"%s%u",
-					filePath.c_str(), entry->sizeFull ^ 0xe54f077a);
-				ArchiveEncryption::GetKeyHashFile(StringUtility::ConvertWideToMulti(strHash).c_str(),
-					headerKeyBase, headerKeyStep, localKeyBase, localKeyStep);
-			}
+			for (; iJob < listJob.size() && listJob[iJob].entry == entry.get(); ++iJob) {
+				unique_ptr<ByteBuffer> data;
+				{
+					std::unique_lock<std::mutex> lock(mtxJob);
+					cvJobDone.wait(lock, [&]() { return bAbort || listResult[iJob] != nullptr; });
+					if (listResult[iJob] == nullptr)
+						throw gstd::wexception(errorJob);
+					data = MOVE(listResult[iJob]);
+				}
 
-			entry->keyBase = localKeyBase;
-			entry->keyStep = localKeyStep;
+				//The key stream runs over the entry's stored bytes, chunk boundaries included
+				size_t sizeData = data->GetSize();
+				ArchiveEncryption::ShiftBlockCopy((byte*)data->GetPointer(), (byte*)data->GetPointer(),
+					sizeData, entry->sizeStored, entry->keyBase, entry->keyStep);
+				fileArchive.write(data->GetPointer(), sizeData);
 
-			if (entry->sizeFull > 0) {
-				//Small files actually get bigger upon compression.
-				if (entry->sizeFull < 0x100) entry->compressionType = ArchiveFileEntry::CT_NONE;
+				entry->sizeStored += sizeData;
+				if (entry->compressionType == ArchiveFileEntry::CT_ZLIB)
+					entry->listChunkSize.push_back(sizeData);
 
-				switch (entry->compressionType) {
-				case ArchiveFileEntry::CT_NONE:
 				{
-					fileArchiveTmp << file.rdbuf();
-					break;
+					std::lock_guard<std::mutex> lock(mtxJob);
+					++iWritten;
 				}
-				case ArchiveFileEntry::CT_ZLIB:
-				{
-					size_t countByte = 0U;
-					if (auto oRes = CompressorStream::Deflate(file, fileArchiveTmp, entry->sizeFull)) {
-						countByte = *oRes;
-					}
-					else {
-						throw gstd::wexception("CompressorStream::Deflate failed");
-					}
+				cvWindow.notify_all();
 
-					entry->sizeStored = countByte;
-					break;
-				}
-				}
+				if (cbProgress)
+					cbProgress(0.05f + progressStep * iJob);
 			}
-
-			file.close();
-
-			if (cbProgress)
-				cbProgress(0.1f + progressStep * iEntry);
-
-			++iEntry;
 		}
 
-		std::streampos sOffsetInfoBegin = fileArchiveTmp.tellp();
-		fileArchiveTmp.flush();
+		_StopWorkers();
 
 		if (cbStatus)
 			cbStatus(L"Writing entries info");
-		progressStep = (0.95f - 0.75f) / (float)listEntry_.size();
+		if (cbProgress)
+			cbProgress(0.9f);
 
 		//Write the info header at the end, always compressed.
 		{
-			fileArchiveTmp.seekp(sOffsetInfoBegin, std::ios::beg);
-
 			std::stringstream buf;
-			size_t totalSize = 0U;
-
-			iEntry = 0;
 			for (auto& entry : listEntry_) {
 				uint32_t sz = entry->GetRecordSize();
 				buf.write((char*)&sz, sizeof(uint32_t));	//Write the size of the entry
 				entry->_WriteEntryRecord(buf);
-
-				totalSize += sz + sizeof(uint32_t);
-
-				if (cbProgress)
-					cbProgress(0.75f + progressStep * iEntry);
-
-				++iEntry;
 			}
+			std::string strInfo = buf.str();
 
-			size_t countByte = totalSize;
-			buf.seekg(0, std::ios::beg);
-
-			if (!CompressorStream::Deflate(buf, fileArchiveTmp, totalSize))
+			ByteBuffer bufInfo;
+			if (!CompressorStream::Deflate(strInfo.data(), strInfo.size(), bufInfo))
 				throw gstd::wexception("Failed to compress archive header.");
-			//fileArchiveTmp << buf.rdbuf();
-
-			header.headerSize = countByte;
-			//header.headerSize = totalSize;
-			header.headerOffset = sOffsetInfoBegin;
-		}
-
-		if (cbStatus)
-			cbStatus(L"Encrypting archive");
-		if (cbProgress)
-			cbProgress(0.95f);
-
-		fileArchiveTmp.seekp(offsetof(ArchiveFileHeader, headerOffset));
-		fileArchiveTmp.write((char*)&header.headerOffset, sizeof(uint32_t));
-		fileArchiveTmp.write((char*)&header.headerSize, sizeof(uint32_t));
 
-		/*
-		if (true) {
-			std::ofstream fileTestOutput(StringUtility::Format(L"%s_head.txt", pathArchive.c_str()), std::ios::trunc);
+			//Continues the header's key stream
+			ArchiveEncryption::ShiftBlockCopy((byte*)bufInfo.GetPointer(), (byte*)bufInfo.GetPointer(),
+				bufInfo.GetSize(), sizeof(ArchiveFileHeader), headerKeyBase, headerKeyStep);
 
-			fileTestOutput << StringUtility::Format("File count:     %d\n", header.entryCount);
-			fileTestOutput << StringUtility::Format("Header offset:  %d\n", header.headerOffset);
-			fileTestOutput << StringUtility::Format("Header size:    %d\n\n", header.headerSize);
+			header.headerOffset = fileArchive.tellp();
+			header.headerSize = bufInfo.GetSize();
+			fileArchive.write(bufInfo.GetPointer(), bufInfo.GetSize());
+		}
 
-			size_t i = 0;
-			for (auto itr = listEntry_.begin(); itr != listEntry_.end(); ++itr, ++i) {
-				shared_ptr<ArchiveFileEntry> entry = *itr;
-				fileTestOutput << StringUtility::Format("%d: %s\n", i,
-					StringUtility::ConvertWideToMulti(entry->path).c_str());
-				fileTestOutput << StringUtility::Format("\tCompression:  %d\n", entry->compressionType);
-				fileTestOutput << StringUtility::Format("\tFull size:    %d\n", entry->sizeFull);
-				fileTestOutput << StringUtility::Format("\tStored size:  %d\n", entry->sizeStored);
-				fileTestOutput << StringUtility::Format("\tOffset:       %d\n", entry->offsetPos);
-			}
+		{
+			byte keyBase = headerKeyBase;
+			ArchiveEncryption::ShiftBlock((byte*)&header, sizeof(ArchiveFileHeader), keyBase, headerKeyStep);
 
-			fileTestOutput.close();
+			fileArchive.seekp(0, std::ios::beg);
+			fileArchive.write((char*)&header, sizeof(ArchiveFileHeader));
 		}
-		*/
 
-		res = EncryptArchive(fileArchiveTmp, pathArchive, &header, headerKeyBase, headerKeyStep);
-		fileArchiveTmp.close();
+		if (!fileArchive.good())
+			throw gstd::wexception(StringUtility::Format(L"Failed to write the archive at [%s].", pathArchive.c_str()));
+		fileArchive.close();
 	}
-	catch (std::exception& e) {
-		::DeleteFileW(pathTmp.c_str());
-		throw e;
+	catch (...) {
+		_StopWorkers();
+		fileArchive.close();
+		::DeleteFileW(pathArchive.c_str());
+		throw;
 	}
 
-	//::DeleteFileW(pathTmp.c_str());
-
 	if (cbStatus)
 		cbStatus(L"Done");
 	if (cbProgress)
 		cbProgress(1.0f);
 
-	return res;
+	return true;
 }
 
-bool FileArchiver::EncryptArchive(std::fstream& inSrc, const std::wstring& pathOut, 
-	ArchiveFileHeader* header,
-	byte keyBase, byte keyStep) 
-{
-	if (!inSrc.is_open()) return false;
-	inSrc.clear();
-	inSrc.seekg(0);
-
-	std::ofstream dest;
-	dest.open(pathOut, std::ios::binary | std::ios::trunc);
-
-	constexpr size_t CHUNK = 16384U;
-	auto buf = make_unique<char[]>(CHUNK);
-	auto pBuf = buf.get();
+//*******************************************************************
+//ArchiveFileMapping
+//*******************************************************************
+ArchiveFileMapping::ArchiveFileMapping() {
+	hFile_ = INVALID_HANDLE_VALUE;
+	hMapping_ = nullptr;
+	size_ = 0;
+}
+ArchiveFileMapping::~ArchiveFileMapping() {
+	_Release();
+}
+bool ArchiveFileMapping::Map(const std::wstring& path) {
+	_Release();
 
-	size_t read = 0U;
-	byte headerBase = keyBase;
+	hFile_ = ::CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+	if (hFile_ == INVALID_HANDLE_VALUE) return false;
 
-	{
-		inSrc.read(pBuf, sizeof(ArchiveFileHeader));
-		ArchiveEncryption::ShiftBlock((byte*)pBuf, sizeof(ArchiveFileHeader), headerBase, keyStep);
-		dest.write(pBuf, sizeof(ArchiveFileHeader));
+	LARGE_INTEGER sizeFile;
+	if (!::GetFileSizeEx(hFile_, &sizeFile) || sizeFile.QuadPart == 0) {
+		_Release();
+		return false;
 	}
 
-	{
-		for (auto& entry : listEntry_) {
-			size_t count = entry->sizeStored;
-
-			byte localBase = entry->keyBase;
-
-			inSrc.clear();
-			inSrc.seekg(entry->offsetPos, std::ios::beg);
-			dest.seekp(entry->offsetPos, std::ios::beg);
-
-			do {
-				inSrc.read(pBuf, CHUNK);
-				read = inSrc.gcount();
-				if (read > count) read = count;
-
-				ArchiveEncryption::ShiftBlock((byte*)pBuf, read, localBase, entry->keyStep);
-
-				dest.write(pBuf, read);
-				count -= read;
-			} while (count > 0U && read > 0U);
-		}
+	//Creating the mapping object doesn't take any address space, only the views do
+	hMapping_ = ::CreateFileMappingW(hFile_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (hMapping_ == nullptr) {
+		_Release();
+		return false;
 	}
 
-	inSrc.clear();
-
-	{
-		size_t infoSize = header->headerSize;
-
-		inSrc.seekg(header->headerOffset, std::ios::beg);
-		dest.seekp(header->headerOffset, std::ios::beg);
-
-		do {
-			inSrc.read(pBuf, CHUNK);
-			read = inSrc.gcount();
-			if (read > infoSize) read = infoSize;
-
-			ArchiveEncryption::ShiftBlock((byte*)pBuf, read, headerBase, keyStep);
-
-			dest.write(pBuf, read);
-			infoSize -= read;
-		} while (infoSize > 0U && read > 0U);
+	size_ = (uint64_t)sizeFile.QuadPart;
+	return true;
+}
+shared_ptr<ArchiveFileView> ArchiveFileMapping::MapView(uint64_t offset, size_t size) {
+	if (hMapping_ == nullptr || size == 0) return nullptr;
+	if (offset > size_ || size_ - offset < size) return nullptr;
+
+	static const uint64_t granularity = [] {
+		SYSTEM_INFO info;
+		::GetSystemInfo(&info);
+		return (uint64_t)info.dwAllocationGranularity;
+	}();
+
+	uint64_t offsetView = offset - offset % granularity;
+	size_t sizeHead = (size_t)(offset - offsetView);
+	if (size > std::numeric_limits<size_t>::max() - sizeHead) return nullptr;
+
+	const byte* pBase = (const byte*)::MapViewOfFile(hMapping_, FILE_MAP_READ,
+		(DWORD)(offsetView >> 32), (DWORD)(offsetView & 0xffffffff), sizeHead + size);
+	if (pBase == nullptr) return nullptr;
+
+	shared_ptr<ArchiveFileView> res(new ArchiveFileView());
+	res->mapping_ = shared_from_this();
+	res->pBase_ = pBase;
+	res->pData_ = pBase + sizeHead;
+	return res;
+}
+void ArchiveFileMapping::_Release() {
+	if (hMapping_) {
+		::CloseHandle(hMapping_);
+		hMapping_ = nullptr;
 	}
+	if (hFile_ != INVALID_HANDLE_VALUE) {
+		::CloseHandle(hFile_);
+		hFile_ = INVALID_HANDLE_VALUE;
+	}
+	size_ = 0;
+}
 
-	dest.close();
-
-	return true;
+//*******************************************************************
+//ArchiveFileView
+//*******************************************************************
+ArchiveFileView::ArchiveFileView() {
+	pBase_ = nullptr;
+	pData_ = nullptr;
+}
+ArchiveFileView::~ArchiveFileView() {
+	if (pBase_)
+		::UnmapViewOfFile(pBase_);
 }
 
 //*******************************************************************
@@ -331,11 +430,32 @@ ArchiveFile::ArchiveFile(const std::wstring& path, size_t readOffset) {
 	baseDir_ = PathProperty::AppendSlash(baseDir_);
 
 	globalReadOffset_ = readOffset;
+
+	bMapFailed_ = false;
 }
 ArchiveFile::~ArchiveFile() {
 	Close();
 }
 
+bool ArchiveFile::_MapFile() {
+	if (mapping_) return true;
+	if (bMapFailed_) return false;
+
+	//Readers fall back to buffers if the archive can't be mapped at all
+	shared_ptr<ArchiveFileMapping> mapping(new ArchiveFileMapping());
+	if (!mapping->Map(basePath_)) {
+		bMapFailed_ = true;
+		return false;
+	}
+
+	mapping_ = mapping;
+	return true;
+}
+void ArchiveFile::_UnmapFile() {
+	//Unmapped once open readers are done with it
+	mapping_ = nullptr;
+}
+
 bool ArchiveFile::OpenFile() {
 	if (!file_->IsOpen()) {
 		bool res = file_->Open(File::AccessType::READ);
@@ -371,22 +491,33 @@ bool ArchiveFile::Open() {
 			Logger::WriteError("File is not a ph3sx data archive");
 			throw wexception();
 		}
-		if (header.version != DATA_VERSION_ARCHIVE) {
+		if (header.version != DATA_VERSION_ARCHIVE && header.version != DATA_VERSION_ARCHIVE_UNCHUNKED) {
 			Logger::WriteError("Archive version not compatible with engine version");
 			throw wexception();
 		}
 
+		uint64_t sizeArchive = file_->GetSize();
+
+		if (globalReadOffset_ + (uint64_t)header.headerOffset > sizeArchive) {
+			Logger::WriteError("Archive header out of bounds, the archive might be truncated");
+			throw wexception();
+		}
+
+		//Older archives record the uncompressed info size, which may run past the end of the file
+		size_t sizeInfo = (size_t)std::min<uint64_t>(header.headerSize,
+			sizeArchive - globalReadOffset_ - header.headerOffset);
+
 		uint32_t headerSizeTrue = 0U;
 
 		std::stringstream bufInfo;
 		stream.seekg(globalReadOffset_ + header.headerOffset, std::ios::beg);
 		{
-			ByteBuffer tmpBufInfo(header.headerSize);
-			stream.read(tmpBufInfo.GetPointer(), header.headerSize);
+			ByteBuffer tmpBufInfo(sizeInfo);
+			stream.read(tmpBufInfo.GetPointer(), sizeInfo);
 
-			ArchiveEncryption::ShiftBlock((byte*)tmpBufInfo.GetPointer(), header.headerSize, keyBase_, keyStep_);
+			ArchiveEncryption::ShiftBlock((byte*)tmpBufInfo.GetPointer(), sizeInfo, keyBase_, keyStep_);
 
-			if (auto oSize = CompressorStream::Inflate(tmpBufInfo, bufInfo, header.headerSize)) {
+			if (auto oSize = CompressorStream::Inflate(tmpBufInfo, bufInfo, sizeInfo)) {
 				headerSizeTrue = *oSize;
 			}
 			else {
@@ -414,7 +545,19 @@ bool ArchiveFile::Open() {
 			uint32_t sizeEntry = 0U; 
 			bufInfo.read((char*)&sizeEntry, sizeof(uint32_t));
 
-			entry._ReadEntryRecord(bufInfo);
+			try {
+				entry._ReadEntryRecord(bufInfo, header.version);
+			}
+			catch (wexception& e) {
+				Logger::WriteError(StringUtility::Format(L"%s [entry %u]", e.what(), iEntry));
+				throw wexception();
+			}
+
+			if (globalReadOffset_ + (uint64_t)entry.offsetPos + entry.sizeStored > sizeArchive) {
+				Logger::WriteError(StringUtility::Format(
+					L"Archive entry out of bounds, the archive might be truncated [%s]", entry.path.c_str()));
+				throw wexception();
+			}
 
 			/*
 			{
@@ -443,6 +586,9 @@ bool ArchiveFile::Open() {
 void ArchiveFile::Close() {
 	file_->Close();
 	mapEntry_.clear();
+
+	_UnmapFile();
+	bMapFailed_ = false;
 }
 
 std::set<std::wstring> ArchiveFile::GetFileList() {
@@ -458,9 +604,43 @@ optional<ArchiveFileEntry*> ArchiveFile::GetEntryByPath(const std::wstring& name
 	return {};
 }
 
+const byte* ArchiveFile::GetEntryView(ArchiveFileEntry* entry, shared_ptr<ArchiveFileView>& view) {
+	view = nullptr;
+	if (!_MapFile()) return nullptr;
+
+	//A failed view only affects this entry, it gets read through the file instead
+	view = mapping_->MapView((uint64_t)globalReadOffset_ + entry->offsetPos, entry->sizeStored);
+	return view ? view->GetData() : nullptr;
+}
+bool ArchiveFile::DecodeEntryChunk(ArchiveFileEntry* entry, const byte* pStored, size_t iChunk, ByteBuffer* dest) {
+	if (iChunk >= entry->GetChunkCount()) return false;
+
+	uint32_t offset = entry->listChunkOffset[iChunk];
+	uint32_t size = entry->listChunkSize[iChunk];
+	if ((uint64_t)offset + size > entry->sizeStored) return false;	//Checked on load, but the table is public
+
+	std::vector<char> raw(size);
+	ArchiveEncryption::ShiftBlockCopy(pStored + offset, (byte*)raw.data(), size, offset,
+		entry->keyBase, entry->keyStep);
+
+	auto oSize = CompressorStream::Inflate(raw.data(), size, *dest);
+	return oSize && *oSize == entry->GetChunkFullSize(iChunk);
+}
+
 unique_ptr<ByteBuffer> ArchiveFile::CreateEntryBuffer(ArchiveFileEntry* entry) {
 	unique_ptr<ByteBuffer> res;
 
+	shared_ptr<ArchiveFileView> view;
+	const byte* pView = GetEntryView(entry, view);
+	if (pView && entry->compressionType == ArchiveFileEntry::CT_NONE) {
+		res.reset(new ByteBuffer(entry->sizeFull));
+		if (entry->sizeFull > 0) {
+			ArchiveEncryption::ShiftBlockCopy(pView, (byte*)res->GetPointer(), entry->sizeFull, 0,
+				entry->keyBase, entry->keyStep);
+		}
+		return res;
+	}
+
 	// Archive file somehow closed, try to reopen
 	if (!file_->IsOpen())
 		OpenFile();
@@ -488,17 +668,34 @@ unique_ptr<ByteBuffer> ArchiveFile::CreateEntryBuffer(ArchiveFileEntry* entry) {
 
 			res.reset(new ByteBuffer());
 
-			ByteBuffer rawBuf(entry->sizeStored);
-			stream.read(rawBuf.GetPointer(), entry->sizeStored);
-
-			byte keyBase = entry->keyBase;
-			ArchiveEncryption::ShiftBlock((byte*)rawBuf.GetPointer(), entry->sizeStored,
-				keyBase, entry->keyStep);
+			ByteBuffer rawBuf;
+			if (pView == nullptr) {
+				rawBuf.SetSize(entry->sizeStored);
+				stream.read(rawBuf.GetPointer(), entry->sizeStored);
+			}
 
 			{
 				size_t sizeVerif = 0U;
 
-				if (entry->sizeStored > 0) {
+				if (entry->GetChunkCount() > 0) {
+					const byte* pStored = pView ? pView : (const byte*)rawBuf.GetPointer();
+
+					res->Reserve(entry->sizeFull);
+					for (size_t iChunk = 0; iChunk < entry->GetChunkCount(); ++iChunk) {
+						if (!DecodeEntryChunk(entry, pStored, iChunk, res.get())) break;
+					}
+					sizeVerif = res->GetSize();
+				}
+				else if (entry->sizeStored > 0) {
+					if (pView) {
+						rawBuf.SetSize(entry->sizeStored);
+						memcpy(rawBuf.GetPointer(), pView, entry->sizeStored);
+					}
+
+					byte keyBase = entry->keyBase;
+					ArchiveEncryption::ShiftBlock((byte*)rawBuf.GetPointer(), entry->sizeStored,
+						keyBase, entry->keyStep);
+
 					if (auto oSize = CompressorStream::Inflate(rawBuf, *res, entry->sizeStored)) {
 						sizeVerif = *oSize;
 					}
@@ -32,6 +32,9 @@ namespace gstd {
 			CT_NONE,
 			CT_ZLIB,
 		};
+		enum : uint32_t {
+			CHUNK_SIZE = 0x40000,	//CT_ZLIB entries are compressed in independent chunks of this size
+		};
 
 		std::wstring path;
 		TypeCompression compressionType;
@@ -40,6 +43,9 @@ namespace gstd {
 		uint32_t offsetPos;
 		byte keyBase;
 		byte keyStep;
+		std::vector<uint32_t> listChunkSize;	//Stored size of each chunk
+
+		std::vector<uint32_t> listChunkOffset;	//Stored offset of each chunk, not written
 
 		ArchiveFileEntry() :
 			compressionType(CT_NONE), 
@@ -55,11 +61,17 @@ namespace gstd {
 
 		const size_t GetRecordSize() {
 			return (path.size() * sizeof(wchar_t) + sizeof(uint32_t)	//string + length
-				+ sizeof(TypeCompression) + sizeof(uint32_t) * 3 + sizeof(byte) * 2);
+				+ sizeof(TypeCompression) + sizeof(uint32_t) * 3 + sizeof(byte) * 2
+				+ sizeof(uint32_t) + listChunkSize.size() * sizeof(uint32_t));	//chunk table + length
+		}
+		size_t GetChunkCount() { return listChunkSize.size(); }
+		size_t GetChunkFullSize(size_t iChunk) {
+			return std::min<size_t>(CHUNK_SIZE, sizeFull - iChunk * CHUNK_SIZE);
 		}
 
 		void _WriteEntryRecord(std::stringstream& buf);
-		void _ReadEntryRecord(std::stringstream& buf);
+		//Throws on a truncated record or a chunk table that doesn't match the entry
+		void _ReadEntryRecord(std::stringstream& buf, uint32_t version);
 	};
 #pragma pack(pop)
 
@@ -77,11 +89,49 @@ namespace gstd {
 		virtual ~FileArchiver();
 
 		void AddEntry(unique_ptr<ArchiveFileEntry>&& entry) { listEntry_.push_back(MOVE(entry)); }
+		//Entries are read and compressed in chunks by worker threads, the calling thread
+		//	encrypts and writes them in entry order so the output is deterministic
 		bool CreateArchiveFile(const std::wstring& baseDir, const std::wstring& pathArchive, 
 			CbSetStatus cbStatus, CbSetProgress cbProgress);
+	};
+
+	//*******************************************************************
+	//ArchiveFileMapping
+	//	Read-only mapping object of a whole archive, views of it are mapped per entry
+	//*******************************************************************
+	class ArchiveFileView;
+	class ArchiveFileMapping : public std::enable_shared_from_this<ArchiveFileMapping> {
+		HANDLE hFile_;
+		HANDLE hMapping_;
+		uint64_t size_;
+
+		void _Release();
+	public:
+		ArchiveFileMapping();
+		~ArchiveFileMapping();
+
+		bool Map(const std::wstring& path);
+		//Maps only [offset, offset + size), nullptr if the address space can't fit it
+		shared_ptr<ArchiveFileView> MapView(uint64_t offset, size_t size);
 
-		bool EncryptArchive(std::fstream& inSrc, const std::wstring& pathOut, 
-			ArchiveFileHeader* header, byte keyBase, byte keyStep);
+		uint64_t GetSize() { return size_; }
+	};
+
+	//*******************************************************************
+	//ArchiveFileView
+	//	View of a range of an ArchiveFileMapping, unmapped when the last holder releases it
+	//*******************************************************************
+	class ArchiveFileView {
+		friend ArchiveFileMapping;
+
+		shared_ptr<ArchiveFileMapping> mapping_;
+		const byte* pBase_;	//Start of the view, aligned down to the allocation granularity
+		const byte* pData_;
+	public:
+		ArchiveFileView();
+		~ArchiveFileView();
+
+		const byte* GetData() { return pData_; }
 	};
 
 	//*******************************************************************
@@ -97,6 +147,13 @@ namespace gstd {
 		uint8_t keyStep_;
 
 		std::map<std::wstring, ArchiveFileEntry> mapEntry_;
+
+		//Entries are read from views of the mapping, readers hold their view so closing the archive doesn't unmap under them
+		shared_ptr<ArchiveFileMapping> mapping_;
+		bool bMapFailed_;
+
+		bool _MapFile();
+		void _UnmapFile();
 	public:
 		ArchiveFile(const std::wstring& path, size_t readOffset);
 		virtual ~ArchiveFile();
@@ -116,5 +173,11 @@ namespace gstd {
 		optional<ArchiveFileEntry*> GetEntryByPath(const std::wstring& name);
 		
 		unique_ptr<ByteBuffer> CreateEntryBuffer(ArchiveFileEntry* entry);
+		//Still encrypted stored bytes of an entry, nullptr if the entry can't be mapped.
+		//	Only the entry is mapped, and it stays mapped for as long as the caller holds on to view.
+		const byte* GetEntryView(ArchiveFileEntry* entry, shared_ptr<ArchiveFileView>& view);
+
+		//Decompresses one chunk of a CT_ZLIB entry from its stored bytes, appending to dest
+		static bool DecodeEntryChunk(ArchiveFileEntry* entry, const byte* pStored, size_t iChunk, ByteBuffer* dest);
 	};
 }
\ No newline at end of file
@@ -52,6 +52,23 @@ optional<size_t> CompressorStream::Deflate(ByteBuffer& bufIn, out_stream_t& bufO
 
 	return InternalDeflate(reader, writer, advance, ended);
 }
+optional<size_t> CompressorStream::Deflate(const char* bufIn, size_t count, ByteBuffer& bufOut) {
+	auto reader = [&](char* _bIn, size_t reading, int* _flushType) -> size_t {
+		size_t read = std::min(reading, count);
+		if (read == count)
+			*_flushType = Z_FINISH;
+		memcpy(_bIn, bufIn, read);
+		bufIn += read;
+		return read;
+	};
+	auto writer = [&](char* _bOut, size_t writing) {
+		bufOut.Write(_bOut, writing);
+	};
+	auto advance = [&](size_t advancing) { count -= advancing; };
+	auto ended = [&]() { return count > 0U; };
+
+	return InternalDeflate(reader, writer, advance, ended);
+}
 
 optional<size_t> CompressorStream::Inflate(in_stream_t& bufIn, out_stream_t& bufOut, size_t count) {
 	auto reader = [&](char* _bIn, size_t reading) -> size_t {
@@ -117,3 +134,18 @@ optional<size_t> CompressorStream::Inflate(ByteBuffer& bufIn, ByteBuffer& bufOut
 
 	return InternalInflate(reader, writer, advance, ended);
 }
+optional<size_t> CompressorStream::Inflate(const char* bufIn, size_t count, ByteBuffer& bufOut) {
+	auto reader = [&](char* _bIn, size_t reading) -> size_t {
+		size_t read = std::min(reading, count);
+		memcpy(_bIn, bufIn, read);
+		bufIn += read;
+		return read;
+	};
+	auto writer = [&](char* _bOut, size_t writing) {
+		bufOut.Write(_bOut, writing);
+	};
+	auto advance = [&](size_t advancing) { count -= advancing; };
+	auto ended = [&]() { return count > 0U; };
+
+	return InternalInflate(reader, writer, advance, ended);
+}
@@ -46,11 +46,13 @@ namespace gstd {
 	public:
 		static optional<size_t> Deflate(in_stream_t& bufIn, out_stream_t& bufOut, size_t count);
 		static optional<size_t> Deflate(ByteBuffer& bufIn, out_stream_t& bufOut, size_t count);
+		static optional<size_t> Deflate(const char* bufIn, size_t count, ByteBuffer& bufOut);
 		
 		static optional<size_t> Inflate(in_stream_t& bufIn, out_stream_t& bufOut, size_t count);
 		static optional<size_t> Inflate(ByteBuffer& bufIn, out_stream_t& bufOut, size_t count);
 		static optional<size_t> Inflate(in_stream_t& bufIn, ByteBuffer& bufOut, size_t count);
 		static optional<size_t> Inflate(ByteBuffer& bufIn, ByteBuffer& bufOut, size_t count);
+		static optional<size_t> Inflate(const char* bufIn, size_t count, ByteBuffer& bufOut);
 	};
 
 #pragma region impl
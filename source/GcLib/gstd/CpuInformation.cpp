@@ -91,4 +91,29 @@ CpuInformation::CpuInformation() {
 
 		this->brand = brand;
 	}
+
+	// Count cores, falling back to the standard library if the system refuses to tell
+	{
+		countPhysicalCore = 0;
+		countLogicalCore = 0;
+
+		DWORD size = 0;
+		::GetLogicalProcessorInformation(nullptr, &size);
+		if (size > 0) {
+			std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> listInfo(
+				size / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+			if (::GetLogicalProcessorInformation(listInfo.data(), &size)) {
+				for (auto& info : listInfo) {
+					if (info.Relationship != RelationProcessorCore) continue;
+					++countPhysicalCore;
+					countLogicalCore += std::bitset<sizeof(ULONG_PTR) * 8>(info.ProcessorMask).count();
+				}
+			}
+		}
+
+		if (countLogicalCore == 0)
+			countLogicalCore = std::max(std::thread::hardware_concurrency(), 1U);
+		if (countPhysicalCore == 0)
+			countPhysicalCore = countLogicalCore;
+	}
 }
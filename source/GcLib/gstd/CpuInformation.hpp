@@ -10,6 +10,7 @@ namespace gstd {
 		bool bIntel, bAMD;
 
 		int family, model, type, stepping;
+		size_t countPhysicalCore, countLogicalCore;
 
 		std::bitset<32> f1_ecx, f1_edx;
 		std::bitset<32> f7_ebx, f7_ecx;
@@ -29,6 +30,9 @@ namespace gstd {
 		int Type() const { return type; }
 		int Stepping() const { return stepping; }
 
+		size_t PhysicalCoreCount() const { return countPhysicalCore; }
+		size_t LogicalCoreCount() const { return countLogicalCore; }
+
 #define _D_FLAG(_fn, _cond) bool Flag##_fn() const { return _cond; }
 		_D_FLAG(SSE3,		f1_ecx[0]);
 		_D_FLAG(PCLMULQDQ,	f1_ecx[1]);
@@ -635,6 +635,20 @@ ByteBuffer* FileManager::_GetByteBuffer(ArchiveFileEntry* entry) {
 
 	return res;
 }
+const byte* FileManager::_GetEntryView(ArchiveFileEntry* entry, shared_ptr<ArchiveFileView>& view) {
+	const byte* res = nullptr;
+
+	try {
+		Lock lock(lock_);
+
+		auto itr = mapArchiveEntries_.find(entry->fullPath);
+		if (itr != mapArchiveEntries_.end())
+			res = itr->second.archive->GetEntryView(entry, view);
+	}
+	catch (...) {}
+
+	return res;
+}
 void FileManager::_ReleaseByteBuffer(ArchiveFileEntry* entry) {
 	{
 		Lock lock(lock_);
@@ -774,6 +788,10 @@ ManagedFileReader::ManagedFileReader(shared_ptr<File> file, ArchiveFileEntry* en
 
 	entry_ = entry;
 
+	buffer_ = nullptr;
+	view_ = nullptr;
+	chunkIndex_ = SIZE_MAX;
+
 	if (entry_ == nullptr) {
 		type_ = TYPE_NORMAL;
 	}
@@ -795,7 +813,17 @@ bool ManagedFileReader::Open() {
 	case TYPE_NORMAL:
 		return file_->Open();
 	case TYPE_ARCHIVED:
+		view_ = FileManager::GetBase()->_GetEntryView(entry_, mapping_);
+		if (view_) return true;
+		//Entry can't be mapped, fall back to a decrypted copy read from the file
+		buffer_ = FileManager::GetBase()->_GetByteBuffer(entry_);
+		return buffer_ != nullptr;
 	case TYPE_ARCHIVED_COMPRESSED:
+		//Chunked entries are decompressed a chunk at a time as they are read
+		if (entry_->GetChunkCount() > 0) {
+			view_ = FileManager::GetBase()->_GetEntryView(entry_, mapping_);
+			if (view_) return true;
+		}
 		buffer_ = FileManager::GetBase()->_GetByteBuffer(entry_);
 		return buffer_ != nullptr;
 	}
@@ -807,6 +835,11 @@ void ManagedFileReader::Close() {
 		buffer_ = nullptr;
 		//FileManager::GetBase()->_ReleaseByteBuffer(entry_);
 	}
+	view_ = nullptr;
+	mapping_ = nullptr;
+
+	chunk_.Clear();
+	chunkIndex_ = SIZE_MAX;
 }
 size_t ManagedFileReader::GetFileSize() {
 	switch (type_) {
@@ -814,7 +847,7 @@ size_t ManagedFileReader::GetFileSize() {
 		return file_->GetSize();
 	case TYPE_ARCHIVED:
 	case TYPE_ARCHIVED_COMPRESSED:
-		return buffer_ ? entry_->sizeFull : 0;
+		return (buffer_ || view_) ? entry_->sizeFull : 0;
 	}
 	return 0;
 }
@@ -823,12 +856,47 @@ DWORD ManagedFileReader::Read(LPVOID buf, DWORD size) {
 	if (type_ == TYPE_NORMAL) {
 		res = file_->Read(buf, size);
 	}
-	else if (type_ == TYPE_ARCHIVED || type_ == TYPE_ARCHIVED_COMPRESSED) {
-		size_t read = size;
-		if (buffer_->GetSize() < offset_ + size) {
-			read = buffer_->GetSize() - offset_;
+	else if (view_ && type_ == TYPE_ARCHIVED_COMPRESSED) {
+		byte* pDest = (byte*)buf;
+		size_t pos = offset_;
+		size_t remain = offset_ < entry_->sizeFull ? std::min<size_t>(size, entry_->sizeFull - offset_) : 0;
+		while (remain > 0) {
+			size_t iChunk = pos / ArchiveFileEntry::CHUNK_SIZE;
+			if (iChunk != chunkIndex_) {
+				chunk_.Clear();
+				chunkIndex_ = SIZE_MAX;
+				if (!ArchiveFile::DecodeEntryChunk(entry_, view_, iChunk, &chunk_)) break;
+				chunkIndex_ = iChunk;
+			}
+
+			size_t offsetChunk = pos - iChunk * ArchiveFileEntry::CHUNK_SIZE;
+			if (offsetChunk >= chunk_.GetSize()) break;
+
+			size_t copy = std::min(remain, chunk_.GetSize() - offsetChunk);
+			memcpy(pDest, chunk_.GetPointer(offsetChunk), copy);
+
+			pDest += copy;
+			pos += copy;
+			remain -= copy;
+		}
+		res = pos - offset_;
+	}
+	else if (view_) {
+		size_t read = 0;
+		if (offset_ < entry_->sizeFull)
+			read = std::min<size_t>(size, entry_->sizeFull - offset_);
+		if (read > 0) {
+			ArchiveEncryption::ShiftBlockCopy(view_ + offset_, (byte*)buf, read, offset_,
+				entry_->keyBase, entry_->keyStep);
 		}
-		memcpy(buf, &buffer_->GetPointer()[offset_], read);
+		res = read;
+	}
+	else if (type_ == TYPE_ARCHIVED || type_ == TYPE_ARCHIVED_COMPRESSED) {
+		size_t read = 0;
+		if (offset_ < buffer_->GetSize())
+			read = std::min<size_t>(size, buffer_->GetSize() - offset_);
+		if (read > 0)
+			memcpy(buf, &buffer_->GetPointer()[offset_], read);
 		res = read;
 	}
 	offset_ += res;
@@ -841,7 +909,7 @@ bool ManagedFileReader::SetFilePointerBegin(File::AccessType type) {
 		res = file_->SetFilePointerBegin(type);
 	}
 	else if (type_ == TYPE_ARCHIVED || type_ == TYPE_ARCHIVED_COMPRESSED) {
-		if (buffer_) {
+		if (buffer_ || view_) {
 			offset_ = 0;
 			res = true;
 		}
@@ -854,7 +922,11 @@ bool ManagedFileReader::SetFilePointerEnd(File::AccessType type) {
 		res = file_->SetFilePointerEnd(type);
 	}
 	else if (type_ == TYPE_ARCHIVED || type_ == TYPE_ARCHIVED_COMPRESSED) {
-		if (buffer_) {
+		if (view_) {
+			offset_ = entry_->sizeFull;
+			res = true;
+		}
+		else if (buffer_) {
 			offset_ = buffer_->GetSize();
 			res = true;
 		}
@@ -867,7 +939,7 @@ bool ManagedFileReader::Seek(size_t offset, File::AccessType type) {
 		res = file_->Seek(offset, std::ios::beg, type);
 	}
 	else if (type_ == TYPE_ARCHIVED || type_ == TYPE_ARCHIVED_COMPRESSED) {
-		res = buffer_ != nullptr;
+		res = buffer_ != nullptr || view_ != nullptr;
 	}
 	if (res) offset_ = offset;
 	return res;
@@ -878,7 +950,7 @@ size_t ManagedFileReader::GetFilePointer(File::AccessType type) {
 		res = file_->GetFilePointer(type);
 	}
 	else if (type_ == TYPE_ARCHIVED || type_ == TYPE_ARCHIVED_COMPRESSED) {
-		if (buffer_) {
+		if (buffer_ || view_) {
 			res = offset_;
 		}
 	}
@@ -890,6 +962,11 @@ bool ManagedFileReader::IsArchived() {
 bool ManagedFileReader::IsCompressed() {
 	return type_ == TYPE_ARCHIVED_COMPRESSED;
 }
+ByteBuffer* ManagedFileReader::GetBuffer() {
+	if (buffer_ == nullptr && view_)
+		buffer_ = FileManager::GetBase()->_GetByteBuffer(entry_);
+	return buffer_;
+}
 #endif
 
 //*******************************************************************
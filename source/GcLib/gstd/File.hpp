@@ -185,6 +185,7 @@ namespace gstd {
 	};
 
 	class ArchiveFileEntry;
+	class ArchiveFileView;
 	class ArchiveFile;
 #if defined(DNH_PROJ_CONFIG)
 	class ArchiveFileEntry {
@@ -225,6 +226,7 @@ namespace gstd {
 		std::map<std::wstring, ArchiveEntryStore> mapArchiveEntries_;
 
 		ByteBuffer* _GetByteBuffer(ArchiveFileEntry* entry);
+		const byte* _GetEntryView(ArchiveFileEntry* entry, shared_ptr<ArchiveFileView>& view);
 		void _ReleaseByteBuffer(ArchiveFileEntry* entry);
 #endif
 	public:
@@ -344,7 +346,12 @@ namespace gstd {
 		ArchiveFileEntry* entry_;
 
 		ByteBuffer* buffer_;
+		const byte* view_;	//Mapped stored bytes of the entry, decrypted on read
+		shared_ptr<ArchiveFileView> mapping_;	//Keeps view_ mapped
 		size_t offset_;
+
+		ByteBuffer chunk_;	//Last decompressed chunk of a chunked CT_ZLIB entry
+		size_t chunkIndex_;
 	public:
 		ManagedFileReader(shared_ptr<File> file, ArchiveFileEntry* entry);
 		~ManagedFileReader();
@@ -362,7 +369,8 @@ namespace gstd {
 		virtual bool IsArchived();
 		virtual bool IsCompressed();
 
-		virtual ByteBuffer* GetBuffer() { return buffer_; }
+		//Materializes the whole entry for mapped readers
+		virtual ByteBuffer* GetBuffer();
 	};
 #endif
 
@@ -21,7 +21,8 @@ constexpr uint64_t GAME_VERSION_NUM = ((_GAME_VERSION_RESERVED & 0xfff) << 52)
 
 constexpr uint32_t _GAME_VERSION_RESERVED_HIBYTE = ((uint32_t)_GAME_VERSION_RESERVED & 0xFFFF) << 16;
 
-constexpr uint32_t DATA_VERSION_ARCHIVE = _GAME_VERSION_RESERVED_HIBYTE | 5;
+constexpr uint32_t DATA_VERSION_ARCHIVE = _GAME_VERSION_RESERVED_HIBYTE | 6;
+constexpr uint32_t DATA_VERSION_ARCHIVE_UNCHUNKED = _GAME_VERSION_RESERVED_HIBYTE | 5;	//Pre-chunking, still readable
 constexpr uint32_t DATA_VERSION_CONFIG  = _GAME_VERSION_RESERVED_HIBYTE | 5;
 constexpr uint32_t DATA_VERSION_CAREA   = _GAME_VERSION_RESERVED_HIBYTE | 5;
 constexpr uint32_t DATA_VERSION_REPLAY  = _GAME_VERSION_RESERVED_HIBYTE | 5;
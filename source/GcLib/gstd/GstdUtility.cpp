@@ -121,6 +121,198 @@ std::wstring SystemUtility::GetSystemFontFilePath(const std::wstring& faceName)
 	return std::wstring(wsFontFile.begin(), wsFontFile.end());
 }
 
+//*******************************************************************
+//JobSystem
+//*******************************************************************
+thread_local size_t JobSystem::indexCurrentWorker_ = SIZE_MAX;
+
+JobSystem::JobSystem(size_t countWorker) {
+	bStop_ = false;
+	countQueued_ = 0;
+	indexSubmit_ = 0;
+
+	statDispatch_ = 0;
+	statJob_ = 0;
+	statTimeWall_ = 0;
+	statTimeJob_ = 0;
+	statTimeJobMax_ = 0;
+
+	size_t countCore = SystemUtility::GetCpuInfo().LogicalCoreCount();
+	bool bPin = countCore <= sizeof(DWORD_PTR) * 8;
+
+	for (size_t i = 0; i < countWorker; ++i)
+		listWorker_.push_back(std::make_unique<Worker>());
+	for (size_t i = 0; i < countWorker; ++i) {
+		Worker* worker = listWorker_[i].get();
+		worker->thread = std::thread(&JobSystem::_RunWorker, this, i);
+
+		//Core 0 is left to the main thread
+		if (bPin) {
+			DWORD_PTR mask = (DWORD_PTR)1 << ((i + 1) % countCore);
+			::SetThreadAffinityMask((HANDLE)worker->thread.native_handle(), mask);
+		}
+	}
+
+	Logger::WriteTop(StringUtility::Format("JobSystem: Started %u worker(s) [%u logical core(s)]",
+		(uint32_t)countWorker, (uint32_t)countCore));
+}
+JobSystem::~JobSystem() {
+	{
+		std::lock_guard<std::mutex> lock(lockSleep_);
+		bStop_ = true;
+	}
+	cvSleep_.notify_all();
+	for (auto& worker : listWorker_) {
+		if (worker->thread.joinable())
+			worker->thread.join();
+	}
+	listWorker_.clear();
+}
+
+JobSystem* JobSystem::GetBase() {
+	static JobSystem system(SystemUtility::GetCpuInfo().LogicalCoreCount() - 1);
+	return &system;
+}
+
+void JobSystem::_RunWorker(size_t index) {
+	indexCurrentWorker_ = index;
+
+	Job job;
+	while (true) {
+		if (_PopJob(index, job)) {
+			_ExecuteJob(job);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(lockSleep_);
+		cvSleep_.wait(lock, [&]() { return bStop_ || countQueued_ > 0; });
+		if (bStop_) break;
+	}
+}
+bool JobSystem::_PopJob(size_t indexSelf, Job& job) {
+	if (countQueued_ == 0) return false;
+
+	size_t countWorker = listWorker_.size();
+
+	//Own deque first, newest job
+	if (indexSelf < countWorker) {
+		Worker* worker = listWorker_[indexSelf].get();
+		std::lock_guard<std::mutex> lock(worker->lock);
+		if (worker->queue.size() > 0) {
+			job = worker->queue.back();
+			worker->queue.pop_back();
+			--countQueued_;
+			return true;
+		}
+	}
+
+	//Steal the oldest job of another worker
+	size_t start = indexSelf < countWorker ? indexSelf + 1 : 0;
+	for (size_t i = 0; i < countWorker; ++i) {
+		Worker* victim = listWorker_[(start + i) % countWorker].get();
+		std::lock_guard<std::mutex> lock(victim->lock);
+		if (victim->queue.size() > 0) {
+			job = victim->queue.front();
+			victim->queue.pop_front();
+			--countQueued_;
+			return true;
+		}
+	}
+	return false;
+}
+void JobSystem::_ExecuteJob(const Job& job) {
+	JobGroup* group = job.group;
+
+	auto timeStart = stdch::steady_clock::now();
+	try {
+		group->func(group->context, job.index);
+	}
+	catch (...) {
+		if (!group->bError.exchange(true))
+			group->error = std::current_exception();
+	}
+	uint64_t timeJob = stdch::duration_cast<stdch::nanoseconds>(
+		stdch::steady_clock::now() - timeStart).count();
+
+	statTimeJob_ += timeJob;
+	uint64_t timeMax = statTimeJobMax_;
+	while (timeJob > timeMax && !statTimeJobMax_.compare_exchange_weak(timeMax, timeJob));
+	++statJob_;
+
+	//Must be last, the group lives on the dispatcher's stack
+	--group->countRemain;
+}
+
+void JobSystem::Dispatch(size_t countJob, JobFunction func, void* context) {
+	if (countJob == 0) return;
+
+	JobGroup group;
+	group.func = func;
+	group.context = context;
+	group.countRemain = countJob;
+	group.bError = false;
+
+	auto timeStart = stdch::steady_clock::now();
+
+	size_t countWorker = listWorker_.size();
+	size_t indexSelf = indexCurrentWorker_;
+	if (countWorker == 0) {
+		for (size_t i = 0; i < countJob; ++i)
+			_ExecuteJob(Job{ &group, i });
+	}
+	else {
+		//countQueued_ is only raised once the jobs are in a queue, under that queue's lock,
+		//	so a woken worker never sees a count with nothing to pop
+		if (indexSelf < countWorker) {
+			//Nested dispatch, keep the jobs local and let idle workers steal them
+			Worker* worker = listWorker_[indexSelf].get();
+			std::lock_guard<std::mutex> lock(worker->lock);
+			for (size_t i = 0; i < countJob; ++i)
+				worker->queue.push_back(Job{ &group, i });
+			countQueued_ += countJob;
+		}
+		else {
+			size_t iTarget = indexSubmit_.fetch_add(1);
+			for (size_t i = 0; i < countJob; ++i, ++iTarget) {
+				Worker* worker = listWorker_[iTarget % countWorker].get();
+				std::lock_guard<std::mutex> lock(worker->lock);
+				worker->queue.push_back(Job{ &group, i });
+				++countQueued_;
+			}
+		}
+		{
+			std::lock_guard<std::mutex> lock(lockSleep_);
+		}
+		cvSleep_.notify_all();
+
+		//Help out until every job of this group is done
+		Job job;
+		while (group.countRemain > 0) {
+			if (_PopJob(indexSelf, job))
+				_ExecuteJob(job);
+			else
+				std::this_thread::yield();
+		}
+	}
+
+	statTimeWall_ += stdch::duration_cast<stdch::nanoseconds>(
+		stdch::steady_clock::now() - timeStart).count();
+	++statDispatch_;
+
+	if (group.bError)
+		std::rethrow_exception(group.error);
+}
+
+JobSystem::Statistics JobSystem::CollectStatistics() {
+	Statistics res;
+	res.countDispatch = statDispatch_.exchange(0);
+	res.countJob = statJob_.exchange(0);
+	res.timeWall = statTimeWall_.exchange(0) / 1000000.0;
+	res.timeJob = statTimeJob_.exchange(0) / 1000000.0;
+	res.timeJobMax = statTimeJobMax_.exchange(0) / 1000000.0;
+	return res;
+}
+
 //*******************************************************************
 //AnyMap
 //*******************************************************************
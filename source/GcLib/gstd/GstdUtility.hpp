@@ -52,27 +52,94 @@ namespace gstd {
 	};
 
 	//================================================================
-	//ThreadUtility
-	template<class F>
-	static void ParallelFor(size_t countLoop, F&& func) {
-		size_t countCore = std::max(std::thread::hardware_concurrency(), 1U);
+	//JobSystem
+	//	Persistent worker threads, one pinned per logical core besides the first.
+	//	Each worker owns a deque; owners pop from the back, idle workers steal from the front.
+	//	Threads waiting on a dispatch execute queued jobs themselves, so nested dispatches cannot starve.
+	class JobSystem {
+	public:
+		typedef void (*JobFunction)(void* context, size_t iJob);
+
+		struct Statistics {
+			uint32_t countDispatch;
+			uint32_t countJob;
+			double timeWall;	//Milliseconds spent waiting on dispatches by their callers
+			double timeJob;		//Milliseconds spent inside jobs, summed across all threads
+			double timeJobMax;	//Longest single job
+		};
+	private:
+		struct JobGroup {
+			JobFunction func;
+			void* context;
+			std::atomic<size_t> countRemain;
+			std::atomic<bool> bError;
+			std::exception_ptr error;
+		};
+		struct Job {
+			JobGroup* group;
+			size_t index;
+		};
+		struct Worker {
+			std::mutex lock;
+			std::deque<Job> queue;
+			std::thread thread;
+		};
+
+		static thread_local size_t indexCurrentWorker_;
+
+		std::vector<std::unique_ptr<Worker>> listWorker_;
+		std::atomic<bool> bStop_;
+		std::atomic<size_t> countQueued_;
+		std::atomic<size_t> indexSubmit_;
+		std::mutex lockSleep_;
+		std::condition_variable cvSleep_;
+
+		std::atomic<uint32_t> statDispatch_;
+		std::atomic<uint32_t> statJob_;
+		std::atomic<uint64_t> statTimeWall_;
+		std::atomic<uint64_t> statTimeJob_;
+		std::atomic<uint64_t> statTimeJobMax_;
 
-		if (countCore > 1 && countLoop >= countCore * 64) {
-			std::vector<std::future<void>> workers;
-			workers.reserve(countCore);
+		void _RunWorker(size_t index);
+		bool _PopJob(size_t indexSelf, Job& job);
+		void _ExecuteJob(const Job& job);
+	public:
+		JobSystem(size_t countWorker);
+		~JobSystem();
+
+		static JobSystem* GetBase();
 
-			auto coreTask = [&](size_t id) {
-				const size_t begin = countLoop / countCore * id + std::min(countLoop % countCore, id);
-				const size_t end = countLoop / countCore * (id + 1U) + std::min(countLoop % countCore, id + 1U);
+		size_t GetWorkerCount() const { return listWorker_.size(); }
+		//Workers plus the dispatching thread
+		size_t GetThreadCount() const { return listWorker_.size() + 1; }
 
+		//Runs func(context, i) for i in [0, countJob) and returns once all have completed.
+		//	The first exception thrown by a job is rethrown here.
+		void Dispatch(size_t countJob, JobFunction func, void* context);
+
+		//Returns the statistics accumulated since the last call and resets them
+		Statistics CollectStatistics();
+	};
+
+	//================================================================
+	//ThreadUtility
+
+	//Calls func(i) for i in [0, countLoop), in jobs of grainSize iterations each
+	template<class F>
+	static void ParallelFor(size_t countLoop, size_t grainSize, F&& func) {
+		grainSize = std::max<size_t>(grainSize, 1U);
+		const size_t countJob = (countLoop + grainSize - 1) / grainSize;
+
+		if (countJob > 1 && JobSystem::GetBase()->GetWorkerCount() > 0) {
+			auto grainTask = [&](size_t id) {
+				const size_t begin = id * grainSize;
+				const size_t end = std::min(begin + grainSize, countLoop);
 				for (size_t i = begin; i < end; ++i)
 					func(i);
 			};
-
-			for (size_t iCore = 0; iCore < countCore; ++iCore)
-				workers.emplace_back(std::async(std::launch::async | std::launch::deferred, coreTask, iCore));
-			for (const auto& worker : workers)
-				worker.wait();
+			JobSystem::GetBase()->Dispatch(countJob, [](void* context, size_t id) {
+				(*(decltype(grainTask)*)context)(id);
+			}, &grainTask);
 		}
 		else {
 			for (size_t i = 0; i < countLoop; ++i) {
@@ -80,6 +147,34 @@ namespace gstd {
 			}
 		}
 	}
+	template<class F>
+	static void ParallelFor(size_t countLoop, F&& func) {
+		//A few jobs per thread so stealing can even out uneven iterations
+		const size_t countJobTarget = JobSystem::GetBase()->GetThreadCount() * 4;
+		ParallelFor(countLoop, std::max<size_t>(countLoop / countJobTarget, 64U), std::forward<F>(func));
+	}
+
+	//Splits [0, countLoop) into countRange contiguous ranges and calls func(iRange, begin, end) for each of them.
+	//	Range boundaries are deterministic, allowing callers to keep per-range buffers and merge them in order.
+	template<class F>
+	static void ParallelForRange(size_t countLoop, size_t countRange, F&& func) {
+		countRange = std::max<size_t>(std::min(countRange, countLoop), 1U);
+
+		auto rangeTask = [&](size_t id) {
+			const size_t begin = countLoop / countRange * id + std::min(countLoop % countRange, id);
+			const size_t end = countLoop / countRange * (id + 1U) + std::min(countLoop % countRange, id + 1U);
+			func(id, begin, end);
+		};
+
+		if (countRange > 1) {
+			JobSystem::GetBase()->Dispatch(countRange, [](void* context, size_t id) {
+				(*(decltype(rangeTask)*)context)(id);
+			}, &rangeTask);
+		}
+		else {
+			rangeTask(0);
+		}
+	}
 
 	//================================================================
 	//VersionUtility
@@ -648,6 +743,108 @@ namespace gstd {
 		}
 	};
 
+	//================================================================
+	//ObjectPool
+	//	Slab allocator for a single class; freed slots go to an intrusive free list and are reused
+	//	before another slab is allocated. Not thread-safe, same as the ref_unsync_ptr owning the objects.
+	class ObjectPoolBase {
+	protected:
+		const char* group_;
+		size_t countUsed_ = 0;
+		size_t countCapacity_ = 0;
+
+		static std::vector<ObjectPoolBase*>& _GetPoolList() {
+			static std::vector<ObjectPoolBase*> list;
+			return list;
+		}
+	public:
+		ObjectPoolBase(const char* group) : group_(group) {
+			_GetPoolList().push_back(this);
+		}
+		virtual ~ObjectPoolBase() {}
+
+		const char* GetGroup() const { return group_; }
+		size_t GetUsedCount() const { return countUsed_; }
+		size_t GetCapacity() const { return countCapacity_; }
+
+		//Sums the usage of every pool in the group
+		static void GetGroupUsage(const char* group, size_t* pUsed, size_t* pCapacity) {
+			*pUsed = 0;
+			*pCapacity = 0;
+			for (ObjectPoolBase* pool : _GetPoolList()) {
+				if (strcmp(pool->group_, group) != 0) continue;
+				*pUsed += pool->countUsed_;
+				*pCapacity += pool->countCapacity_;
+			}
+		}
+	};
+	template<class T, size_t SLAB_SIZE = 256>
+	class ObjectPool : public ObjectPoolBase {
+		union Slot {
+			Slot* next;
+			alignas(T) byte storage[sizeof(T)];
+		};
+
+		std::vector<Slot*> listSlab_;
+		Slot* pFree_ = nullptr;
+
+		ObjectPool(const char* group) : ObjectPoolBase(group) {}
+	public:
+		~ObjectPool() {
+			//Objects still alive at exit would be freed into released slabs otherwise
+			if (countUsed_ > 0) return;
+			for (Slot* slab : listSlab_)
+				::operator delete(slab);
+		}
+
+		static ObjectPool* GetBase(const char* group) {
+			static ObjectPool pool(group);
+			return &pool;
+		}
+
+		void* Allocate() {
+			if (pFree_ == nullptr) {
+				Slot* slab = (Slot*)::operator new(sizeof(Slot) * SLAB_SIZE);
+				for (size_t i = 0; i < SLAB_SIZE - 1; ++i)
+					slab[i].next = &slab[i + 1];
+				slab[SLAB_SIZE - 1].next = nullptr;
+
+				listSlab_.push_back(slab);
+				countCapacity_ += SLAB_SIZE;
+				pFree_ = slab;
+			}
+
+			Slot* slot = pFree_;
+			pFree_ = slot->next;
+			++countUsed_;
+			return slot->storage;
+		}
+		void Free(void* p) {
+			Slot* slot = (Slot*)p;
+			slot->next = pFree_;
+			pFree_ = slot;
+			--countUsed_;
+		}
+	};
+
+	//Routes new/delete of the class through its ObjectPool, derived classes of a different size use the global heap.
+	//	Debug builds replace new with the CRT's tracked ::new, which would skip these, so pooling is disabled there.
+#ifndef _DEBUG
+#define DECLARE_POOL_ALLOCATOR(_class, _group) \
+	public: \
+		static void* operator new(size_t size) { \
+			if (size != sizeof(_class)) return ::operator new(size); \
+			return gstd::ObjectPool<_class>::GetBase(_group)->Allocate(); \
+		} \
+		static void operator delete(void* p, size_t size) { \
+			if (p == nullptr) return; \
+			if (size != sizeof(_class)) ::operator delete(p); \
+			else gstd::ObjectPool<_class>::GetBase(_group)->Free(p); \
+		}
+#else
+#define DECLARE_POOL_ALLOCATOR(_class, _group)
+#endif
+
 #if defined(DNH_PROJ_EXECUTOR) || defined(DNH_PROJ_CONFIG)
 	//================================================================
 	//Scanner
@@ -69,6 +69,7 @@ namespace gstd {
 		void Initialize(uint32_t s);
 
 		uint32_t GetSeed() { return seed_; }
+		const uint64_t* GetState() const { return states_; }
 		int GetInt();
 		int GetInt(int min, int max);
 		int64_t GetInt64();
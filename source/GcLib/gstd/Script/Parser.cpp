@@ -10,7 +10,7 @@ using namespace gstd;
 
 
 script_block::script_block(uint32_t level, block_kind kind) :
-	level(level), kind(kind), arguments(0), func(nullptr) {}
+	level(level), kind(kind), arguments(0), func(nullptr), var_count(0), stack_size(0) {}
 
 
 #pragma push_macro("new")
@@ -177,8 +177,17 @@ static const std::vector<function> base_operations = {
 
 	{ "assert", BaseFunction::assert_, 2 },
 	{ "__DEBUG_BREAK", BaseFunction::script_debugBreak, 0 },
+	{ "__IS_PACKED", BaseFunction::script_isPacked, 1 },
 };
 
+static std::set<dnh_func_callback_t>& _get_pure_functions() {
+	static std::set<dnh_func_callback_t> setFunc = {
+		BaseFunction::round, BaseFunction::truncate, BaseFunction::ceil, BaseFunction::floor,
+		BaseFunction::absolute,
+	};
+	return setFunc;
+}
+
 parser::symbol* parser::scope_t::singular_insert(const std::string& name, const symbol& s, int argc) {
 	bool exists = this->find(name) != this->end();
 	auto& [itrStart, itrEnd] = this->equal_range(name);
@@ -220,6 +229,9 @@ parser::parser(script_engine* e, script_scanner* s) {
 
 	count_base_constants = 0;
 
+	code_count_parsed = 0;
+	code_count_optimized = 0;
+
 	frame.push_back(scope_t(block_kind::bk_normal));		//Scope for default symbols
 
 	//Base script operations
@@ -233,6 +245,16 @@ parser::parser(script_engine* e, script_scanner* s) {
 		engine->main_block->codes.push_back(code(command_kind::pc_call, (uint32_t)block_const_reg, 0));
 	}
 }
+const std::vector<function>& parser::get_base_operations() {
+	return base_operations;
+}
+void parser::register_pure_function(dnh_func_callback_t func) {
+	_get_pure_functions().insert(func);
+}
+bool parser::is_pure_function(dnh_func_callback_t func) {
+	auto& setFunc = _get_pure_functions();
+	return setFunc.find(func) != setFunc.end();
+}
 void parser::load_functions(std::vector<function>* list_func) {
 	//Client script function extensions
 	for (auto itr = list_func->begin(); itr != list_func->end(); ++itr)
@@ -294,6 +316,18 @@ void parser::begin_parse() {
 		engine->main_block->codes[0].arg0 = count_base_constants + stateParser.var_count_main + stateParser.var_count_sub;
 
 		_parser_assert_end(&stateParser);
+
+		if (script_engine::optimize_enabled) {
+			for (script_block& iBlock : engine->blocks)
+				code_count_parsed += iBlock.codes.size();
+			for (script_block& iBlock : engine->blocks)
+				optimize_block(&iBlock);
+			for (script_block& iBlock : engine->blocks)
+				code_count_optimized += iBlock.codes.size();
+		}
+
+		for (script_block& iBlock : engine->blocks)
+			fuse_superinstructions(&iBlock);
 	}
 	catch (parser_error& e) {
 		error = true;
@@ -870,6 +904,10 @@ continue_as_variadic:
 				"Tasks and subs cannot return values.\r\n");
 			state->AddCode(block, code(command_kind::pc_call_and_push_result, (uint32_t)s->sub, argc));
 		}
+		else if (s->valueConst.has_data()) {
+			//Const variable with a known value
+			state->AddCode(block, code(command_kind::pc_push_value, s->valueConst));
+		}
 		else {
 			//Variable
 			state->AddCode(block, code(command_kind::pc_push_variable, s->level, s->var, name));
@@ -1354,6 +1392,21 @@ void parser::parse_single_statement(script_block* block, parser_state_t* state,
 				isArrayElement = true;
 				state->AddCode(block, code(command_kind::pc_push_variable2, s->level, s->var, name));
 				arrayIndexCount = _parse_array_suffix_lvalue(block, state);
+
+				//The last index is left on the stack for pc_index_assign, which doesn't need a
+				//	reference to the element and so doesn't expand packed arrays
+				switch (state->next()) {
+				case token_kind::tk_assign:
+				case token_kind::tk_add_assign:
+				case token_kind::tk_subtract_assign:
+				case token_kind::tk_multiply_assign:
+				case token_kind::tk_divide_assign:
+				case token_kind::tk_fdivide_assign:
+				case token_kind::tk_remainder_assign:
+				case token_kind::tk_power_assign:
+					state->PopCode(block);
+					break;
+				}
 			}
 		}
 
@@ -1375,7 +1428,7 @@ void parser::parse_single_statement(script_block* block, parser_state_t* state,
 			}
 
 			if (isArrayElement)
-				state->AddCode(block, code(command_kind::pc_ref_assign));
+				state->AddCode(block, code(command_kind::pc_index_assign, (uint32_t)command_kind::pc_ref_assign, name));
 			else 
 				state->AddCode(block, code(command_kind::pc_copy_assign, s->level, s->var, name));
 			break;
@@ -1404,7 +1457,9 @@ void parser::parse_single_statement(script_block* block, parser_state_t* state,
 #undef DEF_CASE
 			state->advance();
 			parse_expression(block, state);
-			if (isArrayElement)
+			if (isArrayElement && f != command_kind::pc_inline_cat_asi)
+				state->AddCode(block, code(command_kind::pc_index_assign, (uint32_t)f, name));
+			else if (isArrayElement)
 				state->AddCode(block, code(f, false, name));
 			else
 				state->AddCode(block, code(f, true, MAKE_ARG1_LEVEL_VAR(s->level, s->var), name));
@@ -1470,7 +1525,26 @@ void parser::parse_single_statement(script_block* block, parser_state_t* state,
 
 				state->advance();
 
+				size_t countCodePrev = block->codes.size();
 				parse_expression(block, state);
+
+				//Reads of a const initialized with a constant use the value directly
+				if (s->bConst && script_engine::optimize_enabled && block->codes.size() == countCodePrev + 1) {
+					const code* pInit = &block->codes.back();
+					if (pInit->GetOp() == command_kind::pc_push_value) {
+						const value* pVal = &pInit->data;
+						switch (pVal->get_type()->get_kind()) {
+						case type_data::tk_int:
+						case type_data::tk_float:
+						case type_data::tk_char:
+						case type_data::tk_boolean:
+							if (s->type == nullptr || s->type == pVal->get_type())
+								s->valueConst = *pVal;
+							break;
+						}
+					}
+				}
+
 				if (s->type != nullptr) {
 					state->AddCode(block, code(command_kind::pc_inline_cast_var, (uint32_t)s->type, true));
 				}
@@ -1706,19 +1780,29 @@ void parser::parse_single_statement(script_block* block, parser_state_t* state,
 				"\"in\" or a colon is required.\r\n");
 			state->advance();
 
-			bool bMakeArrayUnique = true;
+			bool bRefArray = false;
 			if (state->next() == token_kind::tk_decl_mod_ref) {
-				bMakeArrayUnique = false;
+				bRefArray = true;
 				state->advance();
 			}
 
 			size_t ip_var_format = state->ip;
 			state->AddCode(block, code(command_kind::pc_var_format, 0U, 0));
 
-			//The array
+			//The array, held by the loop it is a snapshot as writes to the variable copy it first.
+			//	"ref" iterates through a pointer to the variable instead, so it only takes a variable.
+			size_t countCodePrev = block->codes.size();
 			parse_expression(block, state);
-			if (bMakeArrayUnique)
-				state->AddCode(block, code(command_kind::pc_make_unique, 0));
+			if (bRefArray) {
+				code* pArray = block->codes.size() == countCodePrev + 1 ? &block->codes.back() : nullptr;
+				parser_assert(state, pArray && (pArray->GetOp() == command_kind::pc_push_variable
+					|| pArray->GetOp() == command_kind::pc_push_value),
+					"A \"ref\" for-each loop requires a variable.\r\n");
+
+				//Constants can't change, they are iterated as they are
+				if (pArray->GetOp() == command_kind::pc_push_variable)
+					pArray->SetOp(command_kind::pc_push_variable2);
+			}
 
 			parser_assert(state, state->next() == token_kind::tk_close_par, "\")\" is required.\r\n");
 			state->advance();
@@ -2589,7 +2673,6 @@ void parser::optimize_expression(script_block* block, parser_state_t* state) {
 					for (size_t i = 0; i < sizeArray; ++i) {
 						{
 							value appending = ptrPushValueCode->data;
-							appending.make_unique();
 
 							BaseFunction::_append_check(nullptr, arrayType, appending.get_type());
 							BaseFunction::_value_cast(&appending, type_elem);
@@ -2607,7 +2690,6 @@ void parser::optimize_expression(script_block* block, parser_state_t* state) {
 
 				for (size_t i = 0; i < sizeArray; ++i)
 					newCodes.pop_back();
-				arrayVal.make_unique();
 				newCodes.push_back(code(iSrcCode->GetLine(), command_kind::pc_push_value, arrayVal));
 				state->ip -= sizeArray;
 			}
@@ -2641,6 +2723,489 @@ lab_opt_construct_array_cancel:
 
 	block->codes = newCodes;
 }
+static bool _is_jump(command_kind op) {
+	switch (op) {
+	case command_kind::pc_jump:
+	case command_kind::pc_jump_if:
+	case command_kind::pc_jump_if_not:
+	case command_kind::pc_jump_if_nopop:
+	case command_kind::pc_jump_if_not_nopop:
+		return true;
+	}
+	return false;
+}
+//Flags every code that a jump lands on, [size] is for jumps to the end of the block
+static std::vector<bool> _get_jump_targets(const std::vector<code>& codes) {
+	std::vector<bool> res(codes.size() + 1, false);
+	for (const code& c : codes) {
+		if (_is_jump(c.GetOp()) && c.arg0 < res.size())
+			res[c.arg0] = true;
+	}
+	return res;
+}
+//Moves jump addresses over to a rebuilt code list, [mapIp] maps each old address to its new one
+static void _relink_jumps(std::vector<code>& codes, const std::vector<size_t>& mapIp) {
+	for (code& c : codes) {
+		if (_is_jump(c.GetOp()) && c.arg0 < mapIp.size())
+			c.arg0 = mapIp[c.arg0];
+	}
+}
+//Drops the flagged codes, jumps to a dropped code will land on the next code that's kept
+static void _compact_codes(script_block* block, const std::vector<bool>& listRemove) {
+	std::vector<code>& codes = block->codes;
+
+	std::vector<code> newCodes;
+	newCodes.reserve(codes.size());
+	std::vector<size_t> mapIp(codes.size() + 1);
+	for (size_t i = 0; i < codes.size(); ++i) {
+		mapIp[i] = newCodes.size();
+		if (!listRemove[i])
+			newCodes.push_back(codes[i]);
+	}
+	mapIp[codes.size()] = newCodes.size();
+
+	_relink_jumps(newCodes, mapIp);
+	codes = MOVE(newCodes);
+}
+
+static bool _is_constant_scalar(const code& c) {
+	if (c.GetOp() != command_kind::pc_push_value || !c.data.has_data())
+		return false;
+	switch (c.data.get_type()->get_kind()) {
+	case type_data::tk_int:
+	case type_data::tk_float:
+	case type_data::tk_char:
+	case type_data::tk_boolean:
+		return true;
+	}
+	return false;
+}
+static value _fold_operation(command_kind op, int argc, const value* argv) {
+	switch (op) {
+#define DEF_CASE(cmd, fn) case cmd: return BaseFunction::fn(nullptr, argc, argv);
+		DEF_CASE(command_kind::pc_inline_neg, negative);
+		DEF_CASE(command_kind::pc_inline_not, not_);
+		DEF_CASE(command_kind::pc_inline_abs, absolute);
+		DEF_CASE(command_kind::pc_inline_add, add);
+		DEF_CASE(command_kind::pc_inline_sub, subtract);
+		DEF_CASE(command_kind::pc_inline_mul, multiply);
+		DEF_CASE(command_kind::pc_inline_div, divide);
+		DEF_CASE(command_kind::pc_inline_fdiv, fdivide);
+		DEF_CASE(command_kind::pc_inline_mod, remainder_);
+		DEF_CASE(command_kind::pc_inline_pow, power);
+#undef DEF_CASE
+	case command_kind::pc_inline_cmp_e:
+	case command_kind::pc_inline_cmp_g:
+	case command_kind::pc_inline_cmp_ge:
+	case command_kind::pc_inline_cmp_l:
+	case command_kind::pc_inline_cmp_le:
+	case command_kind::pc_inline_cmp_ne:
+	{
+		int cmp_r = BaseFunction::compare(nullptr, argc, argv).as_int();
+
+		bool cmp_rb = false;
+#define DEF_CASE(cmd, expr) case cmd: cmp_rb = (expr); break;
+		switch (op) {
+			DEF_CASE(command_kind::pc_inline_cmp_e, cmp_r == 0);
+			DEF_CASE(command_kind::pc_inline_cmp_g, cmp_r > 0);
+			DEF_CASE(command_kind::pc_inline_cmp_ge, cmp_r >= 0);
+			DEF_CASE(command_kind::pc_inline_cmp_l, cmp_r < 0);
+			DEF_CASE(command_kind::pc_inline_cmp_le, cmp_r <= 0);
+			DEF_CASE(command_kind::pc_inline_cmp_ne, cmp_r != 0);
+		}
+#undef DEF_CASE
+
+		return value(script_type_manager::get_boolean_type(), cmp_rb);
+	}
+	}
+	return value();
+}
+
+//Expression codes that work the same when moved into the calling block
+static bool _is_inlinable_code(const code& c) {
+	command_kind op = c.GetOp();
+	switch (op) {
+	case command_kind::pc_push_value:
+	case command_kind::pc_push_variable:
+	case command_kind::pc_push_variable2:
+	case command_kind::pc_dup_n:
+	case command_kind::pc_swap:
+	case command_kind::pc_load_ptr:
+	case command_kind::pc_unload_ptr:
+	case command_kind::pc_make_unique:
+	case command_kind::pc_construct_array:
+		return true;
+	case command_kind::pc_call_and_push_result:
+		return c.block->func != nullptr && c.block->func != BaseFunction::invoke;
+	}
+	//Operators that don't assign to variables
+	return op >= command_kind::pc_inline_neg && op <= command_kind::pc_inline_length_array;
+}
+//Recognizes a function whose body is a single return statement, and gets the range of its expression:
+//	pc_var_alloc, pc_copy_assign (per argument), (expression), pc_copy_assign [result], pc_sub_return
+static bool _get_inline_body(script_block* sub, size_t* pBegin, size_t* pEnd) {
+	static constexpr size_t MAX_INLINE_CODES = 16;
+
+	if (sub->func != nullptr || sub->kind != block_kind::bk_function)
+		return false;
+
+	const std::vector<code>& codes = sub->codes;
+	size_t begin = 1 + sub->arguments;
+	if (codes.size() < begin + 3 || codes[0].GetOp() != command_kind::pc_var_alloc)
+		return false;
+	for (size_t i = 1; i < begin; ++i) {
+		if (codes[i].GetOp() != command_kind::pc_copy_assign || codes[i].arg0 != sub->level)
+			return false;
+	}
+
+	size_t end = codes.size() - 2;
+	const code& cRes = codes[end];
+	if (codes.back().GetOp() != command_kind::pc_sub_return || cRes.GetOp() != command_kind::pc_copy_assign
+		|| cRes.arg0 != sub->level || cRes.arg1 != 0)
+		return false;
+	if (end - begin > MAX_INLINE_CODES)
+		return false;
+	for (size_t i = begin; i < end; ++i) {
+		if (!_is_inlinable_code(codes[i]))
+			return false;
+	}
+
+	*pBegin = begin;
+	*pEnd = end;
+	return true;
+}
+
+//Optimization pass over a finished block, jump addresses are kept valid through every step
+void parser::optimize_block(script_block* block) {
+	if (block->func) return;
+
+	inline_functions(block);
+	while (true) {
+		bool bChanged = fold_constants(block);
+		bChanged |= remove_dead_code(block);
+		if (!bChanged) break;
+	}
+}
+//Replaces calls to single-expression functions with the function's codes.
+//	The callee's own variables are moved to scratch variables past the caller's, everything else
+//	is found through the same environment chain as before, as the callee's environment
+//	is only ever searched for variables of its own level.
+void parser::inline_functions(script_block* block) {
+	std::vector<code>& codes = block->codes;
+	if (codes.size() == 0 || codes[0].GetOp() != command_kind::pc_var_alloc)
+		return;
+
+	//Inlined bodies never contain calls of their own, so all of them can share the same scratch range
+	uint32_t base = codes[0].arg0;
+	uint32_t countScratch = 0;
+
+	std::vector<code> newCodes;
+	newCodes.reserve(codes.size());
+	std::vector<size_t> mapIp(codes.size() + 1);
+
+	for (size_t i = 0; i < codes.size(); ++i) {
+		mapIp[i] = newCodes.size();
+
+		const code& c = codes[i];
+		command_kind op = c.GetOp();
+
+		size_t begin = 0, end = 0;
+		bool bCall = op == command_kind::pc_call || op == command_kind::pc_call_and_push_result;
+		if (!bCall || c.block == block || !_get_inline_body(c.block, &begin, &end)) {
+			newCodes.push_back(c);
+			continue;
+		}
+
+		script_block* sub = c.block;
+		auto _AddRemapped = [&](const code& src) {
+			newCodes.push_back(src);
+			code& dst = newCodes.back();
+			switch (dst.GetOp()) {
+			case command_kind::pc_push_variable:
+			case command_kind::pc_push_variable2:
+			case command_kind::pc_copy_assign:
+				if (dst.arg0 == sub->level) {
+					dst.arg0 = block->level;
+					dst.arg1 += base;
+				}
+				break;
+			}
+		};
+
+		//Clear the scratch variables first, assignments keep the type a variable already has
+		newCodes.push_back(code(c.GetLine(), command_kind::pc_var_format, base));
+		newCodes.back().arg1 = sub->codes[0].arg0;
+
+		//Arguments are on the stack in call order, the last one on top
+		for (size_t iArg = begin - 1; iArg > 0; --iArg)
+			_AddRemapped(sub->codes[iArg]);
+		for (size_t iCode = begin; iCode <= end; ++iCode)
+			_AddRemapped(sub->codes[iCode]);
+
+		if (op == command_kind::pc_call_and_push_result) {
+			newCodes.push_back(code(command_kind::pc_push_variable, block->level, base, "!res"));
+			newCodes.back().SetLine(c.GetLine());
+		}
+
+		countScratch = std::max<uint32_t>(countScratch, sub->codes[0].arg0);
+	}
+	if (countScratch == 0) return;
+
+	mapIp[codes.size()] = newCodes.size();
+	_relink_jumps(newCodes, mapIp);
+
+	newCodes[0].arg0 = base + countScratch;
+	codes = MOVE(newCodes);
+}
+//Evaluates operators, pure builtins and conditional jumps whose operands are all constants.
+//	A sequence is only folded if nothing jumps into it past its first code.
+bool parser::fold_constants(script_block* block) {
+	std::vector<code>& codes = block->codes;
+	std::vector<bool> listTarget = _get_jump_targets(codes);
+	std::vector<bool> listRemove(codes.size(), false);
+	bool bFolded = false;
+
+	//Finds the [count] constant pushes that the code at [ip] consumes
+	std::vector<size_t> listArg;
+	auto _GetConstantArgs = [&](size_t ip, size_t count) -> bool {
+		listArg.resize(count);
+
+		size_t iPrev = ip;
+		for (size_t iArg = count; iArg > 0; --iArg) {
+			do {
+				if (iPrev == 0) return false;
+				--iPrev;
+			} while (listRemove[iPrev]);
+
+			if (!_is_constant_scalar(codes[iPrev])) return false;
+			listArg[iArg - 1] = iPrev;
+		}
+		for (size_t i = iPrev + 1; i <= ip; ++i) {
+			if (listTarget[i]) return false;
+		}
+		return true;
+	};
+
+	std::vector<value> listValue;
+	for (size_t i = 0; i < codes.size(); ++i) {
+		code* c = &codes[i];
+		command_kind op = c->GetOp();
+
+		size_t argc = 0;
+		switch (op) {
+		case command_kind::pc_inline_neg:
+		case command_kind::pc_inline_not:
+		case command_kind::pc_inline_abs:
+			argc = 1;
+			break;
+		case command_kind::pc_inline_add:
+		case command_kind::pc_inline_sub:
+		case command_kind::pc_inline_mul:
+		case command_kind::pc_inline_div:
+		case command_kind::pc_inline_fdiv:
+		case command_kind::pc_inline_mod:
+		case command_kind::pc_inline_pow:
+		case command_kind::pc_inline_cmp_e:
+		case command_kind::pc_inline_cmp_g:
+		case command_kind::pc_inline_cmp_ge:
+		case command_kind::pc_inline_cmp_l:
+		case command_kind::pc_inline_cmp_le:
+		case command_kind::pc_inline_cmp_ne:
+			argc = 2;
+			break;
+		case command_kind::pc_call_and_push_result:
+			if (c->block->func && is_pure_function(c->block->func))
+				argc = c->arg1;
+			break;
+		case command_kind::pc_jump_if:
+		case command_kind::pc_jump_if_not:
+		{
+			if (!_GetConstantArgs(i, 1)) break;
+
+			bool bJump = codes[listArg[0]].data.as_boolean() == (op == command_kind::pc_jump_if);
+			listRemove[listArg[0]] = true;
+			if (bJump)
+				c->SetOp(command_kind::pc_jump);
+			else
+				listRemove[i] = true;
+			bFolded = true;
+			break;
+		}
+		}
+		if (argc == 0 || !_GetConstantArgs(i, argc)) continue;
+
+		listValue.resize(argc);
+		for (size_t iArg = 0; iArg < argc; ++iArg)
+			listValue[iArg] = codes[listArg[iArg]].data;
+
+		value res;
+		try {
+			if (op == command_kind::pc_call_and_push_result)
+				res = c->block->func(nullptr, argc, listValue.data());
+			else
+				res = _fold_operation(op, argc, listValue.data());
+		}
+		catch (std::string&) {}		//Leave errors such as division by zero for runtime
+		catch (std::wstring&) {}
+		if (!res.has_data()) continue;
+
+		codes[listArg[0]] = code(c->GetLine(), command_kind::pc_push_value, res);
+		for (size_t iArg = 1; iArg < argc; ++iArg)
+			listRemove[listArg[iArg]] = true;
+		listRemove[i] = true;
+		bFolded = true;
+	}
+
+	if (bFolded)
+		_compact_codes(block, listRemove);
+	return bFolded;
+}
+//Removes codes that can't be reached from the start of the block, and jumps to the code right after them
+bool parser::remove_dead_code(script_block* block) {
+	std::vector<code>& codes = block->codes;
+	const size_t count = codes.size();
+
+	std::vector<bool> listRemove(count, true);
+	std::vector<size_t> listPending = { 0 };
+	while (listPending.size() > 0) {
+		size_t i = listPending.back();
+		listPending.pop_back();
+
+		for (; i < count && listRemove[i]; ++i) {
+			listRemove[i] = false;
+
+			command_kind op = codes[i].GetOp();
+			if (_is_jump(op))
+				listPending.push_back(codes[i].arg0);
+			if (op == command_kind::pc_jump || op == command_kind::pc_sub_return)
+				break;
+		}
+	}
+
+	//Everything between a jump and the next kept code is removed, so a jump into that range lands on it
+	for (size_t i = count, iNext = count; i-- > 0;) {
+		if (listRemove[i]) continue;
+
+		const code& c = codes[i];
+		if (c.GetOp() == command_kind::pc_jump && c.arg0 > i && c.arg0 <= iNext)
+			listRemove[i] = true;
+		else
+			iNext = i;
+	}
+
+	if (std::find(listRemove.begin(), listRemove.end(), true) == listRemove.end())
+		return false;
+	_compact_codes(block, listRemove);
+	return true;
+}
+//Rewrites common code sequences into superinstructions.
+//	Only the opcode of the first code in a sequence is changed, so jump addresses stay valid,
+//	and jumping into the middle of a fused sequence still runs the original codes.
+void parser::fuse_superinstructions(script_block* block) {
+	std::vector<code>& codes = block->codes;
+	const size_t count = codes.size();
+
+	auto _IsLocal = [&](size_t i, command_kind op) {
+		return i < count && codes[i].GetOp() == op && codes[i].arg0 == block->level;
+	};
+	auto _IsArithmetic = [](command_kind op) {
+		switch (op) {
+		case command_kind::pc_inline_add:
+		case command_kind::pc_inline_sub:
+		case command_kind::pc_inline_mul:
+		case command_kind::pc_inline_div:
+		case command_kind::pc_inline_fdiv:
+		case command_kind::pc_inline_mod:
+		case command_kind::pc_inline_pow:
+			return true;
+		}
+		return false;
+	};
+	auto _IsComparison = [](command_kind op) {
+		switch (op) {
+		case command_kind::pc_inline_cmp_e:
+		case command_kind::pc_inline_cmp_g:
+		case command_kind::pc_inline_cmp_ge:
+		case command_kind::pc_inline_cmp_l:
+		case command_kind::pc_inline_cmp_le:
+		case command_kind::pc_inline_cmp_ne:
+			return true;
+		}
+		return false;
+	};
+	auto _IsJumpIf = [&](size_t i) {
+		if (i >= count) return false;
+		command_kind op = codes[i].GetOp();
+		return op == command_kind::pc_jump_if || op == command_kind::pc_jump_if_not;
+	};
+
+	for (size_t i = 0; i < count;) {
+		code* c = &codes[i];
+		size_t fused = 1;
+
+		switch (c->GetOp()) {
+		case command_kind::pc_push_variable:
+		{
+			if (c->arg0 != block->level) break;
+
+			bool bValue = i + 1 < count && codes[i + 1].GetOp() == command_kind::pc_push_value;
+			if ((bValue || _IsLocal(i + 1, command_kind::pc_push_variable)) && i + 2 < count) {
+				command_kind op = codes[i + 2].GetOp();
+				if (_IsComparison(op) && _IsJumpIf(i + 3)) {
+					c->SetOp(bValue ? command_kind::pc_sup_lv_cmp_jump : command_kind::pc_sup_ll_cmp_jump);
+					fused = 4;
+					break;
+				}
+				else if (bValue && _IsArithmetic(op) && _IsLocal(i + 3, command_kind::pc_copy_assign)) {
+					c->SetOp(command_kind::pc_sup_lv_op_assign);
+					fused = 4;
+					break;
+				}
+				else if (_IsArithmetic(op) || _IsComparison(op)) {
+					c->SetOp(bValue ? command_kind::pc_sup_lv_op : command_kind::pc_sup_ll_op);
+					fused = 3;
+					break;
+				}
+			}
+
+			c->SetOp(command_kind::pc_push_local);
+			break;
+		}
+		case command_kind::pc_push_variable2:
+			if (c->arg0 == block->level)
+				c->SetOp(command_kind::pc_push_local2);
+			break;
+		case command_kind::pc_copy_assign:
+			if (c->arg0 == block->level)
+				c->SetOp(command_kind::pc_copy_assign_local);
+			break;
+		case command_kind::pc_inline_inc:
+		case command_kind::pc_inline_dec:
+			//[arg1] is packed as (level << 20 | variable)
+			if (c->arg0 && ((c->arg1 >> 20) & 0xfff) == block->level) {
+				c->SetOp(c->GetOp() == command_kind::pc_inline_inc ?
+					command_kind::pc_inline_inc_local : command_kind::pc_inline_dec_local);
+				c->arg1 &= 0xfffff;
+			}
+			break;
+		case command_kind::pc_inline_cmp_e:
+		case command_kind::pc_inline_cmp_g:
+		case command_kind::pc_inline_cmp_ge:
+		case command_kind::pc_inline_cmp_l:
+		case command_kind::pc_inline_cmp_le:
+		case command_kind::pc_inline_cmp_ne:
+			if (_IsJumpIf(i + 1)) {
+				c->arg0 = (uint32_t)c->GetOp();
+				c->SetOp(command_kind::pc_sup_cmp_jump);
+				fused = 2;
+			}
+			break;
+		}
+
+		i += fused;
+	}
+}
+
 //Links jump commands with their matching jump targets
 void parser::link_jump(script_block* block, parser_state_t* state, size_t ip_off) {
 	std::vector<code> newCodes;
@@ -26,6 +26,7 @@ namespace gstd {
 
 		pc_copy_assign,			//Copy variable=[arg0, arg1] to {esp-0}
 		pc_ref_assign,			//Set *{esp-1} to {esp-0}
+		pc_index_assign,		//Set (*{esp-2})[{esp-1}] to {esp-0}, or to ((element) op=[arg0] {esp-0}) unless [arg0] is pc_ref_assign
 
 		pc_sub_return,			//Return from a function/task/sub
 
@@ -104,6 +105,23 @@ namespace gstd {
 		pc_inline_index_array2,		//Push ({esp-1}[{esp-0}]) to stack
 		pc_inline_length_array,		//Push length({esp-0}) to stack
 
+		//------------------------------------------------------------------------
+		//Superinstructions, only created by parser::fuse_superinstructions
+		//	Operands are read from the original codes that follow, which stay in place and are skipped over
+		//------------------------------------------------------------------------
+		pc_push_local,			//pc_push_variable, variable=[arg1] is in the current environment
+		pc_push_local2,			//pc_push_variable2, variable=[arg1] is in the current environment
+		pc_copy_assign_local,	//pc_copy_assign, variable=[arg1] is in the current environment
+		pc_inline_inc_local,	//pc_inline_inc, variable=[arg1] is in the current environment
+		pc_inline_dec_local,	//pc_inline_dec, variable=[arg1] is in the current environment
+
+		pc_sup_ll_op,			//pc_push_local, pc_push_local, (binary op)
+		pc_sup_lv_op,			//pc_push_local, pc_push_value, (binary op)
+		pc_sup_lv_op_assign,	//pc_push_local, pc_push_value, (arithmetic op), pc_copy_assign_local
+		pc_sup_cmp_jump,		//(comparison=[arg0]), pc_jump_if or pc_jump_if_not
+		pc_sup_ll_cmp_jump,		//pc_push_local, pc_push_local, (comparison), pc_jump_if or pc_jump_if_not
+		pc_sup_lv_cmp_jump,		//pc_push_local, pc_push_value, (comparison), pc_jump_if or pc_jump_if_not
+
 		pc_nop = (uint8_t)-1,	//No operation
 	};
 	enum class block_kind : uint8_t {
@@ -119,6 +137,10 @@ namespace gstd {
 		std::vector<code> codes;
 		block_kind kind;
 
+		//Environment frame sizes, set by script_engine::compute_frame_sizes
+		uint32_t var_count;
+		uint32_t stack_size;
+
 		script_block(uint32_t level, block_kind kind);
 	};
 
@@ -250,6 +272,7 @@ namespace gstd {
 				uint32_t var;
 				bool bConst;		//Applies to the scripter, not the engine
 				bool bAssigned;
+				value valueConst;	//Initializer of a const variable, if it was a constant
 			};
 
 			symbol();
@@ -278,6 +301,9 @@ namespace gstd {
 		script_block* block_const_reg;
 		size_t count_base_constants;
 
+		size_t code_count_parsed;
+		size_t code_count_optimized;
+
 		parser(script_engine* e, script_scanner* s);
 		virtual ~parser() {}
 
@@ -285,6 +311,13 @@ namespace gstd {
 		void load_constants(std::vector<constant>* list_const);
 		void begin_parse();
 
+		static const std::vector<function>& get_base_operations();
+
+		//Marks a builtin as free of side effects, calls to it with constant numeric arguments
+		//	are evaluated by the optimization pass. The function must not use its script_machine.
+		static void register_pure_function(dnh_func_callback_t func);
+		static bool is_pure_function(dnh_func_callback_t func);
+
 		void parse_parentheses(script_block* block, parser_state_t* state);
 		void parse_clause(script_block* block, parser_state_t* state);
 		void parse_prefix(script_block* block, parser_state_t* state);
@@ -326,6 +359,11 @@ namespace gstd {
 		void write_operation(script_block* block, parser_state_t* state, const symbol* s, int clauses);
 
 		void optimize_expression(script_block* block, parser_state_t* state);
+		void optimize_block(script_block* block);
+		void inline_functions(script_block* block);
+		bool fold_constants(script_block* block);
+		bool remove_dead_code(script_block* block);
+		void fuse_superinstructions(script_block* block);
 		void link_jump(script_block* block, parser_state_t* state, size_t ip_off);
 		void link_break_continue(script_block* block, parser_state_t* state, 
 			size_t ip_begin, size_t ip_end, size_t ip_break, size_t ip_continue);
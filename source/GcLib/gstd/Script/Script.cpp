@@ -1,6 +1,7 @@
 #include "source/GcLib/pch.h"
 
 #include "../GstdUtility.hpp"
+#include "../File.hpp"
 #include "Script.hpp"
 #include "ScriptLexer.hpp"
 
@@ -37,12 +38,16 @@ script_type_manager::script_type_manager() {
 }
 
 type_data* script_type_manager::get_type(type_data* type) {
-	auto itr = types.find(*type);
-	if (itr == types.end()) {
-		//No type found, insert and return the new type
-		itr = types.insert(*type).first;
+	{
+		std::shared_lock<std::shared_mutex> lock(mtx_types);
+		auto itr = types.find(*type);
+		if (itr != types.end())
+			return deref_itr(itr);
 	}
-	return deref_itr(itr);
+
+	//No type found, insert and return the new type
+	std::unique_lock<std::shared_mutex> lock(mtx_types);
+	return deref_itr(types.insert(*type).first);
 }
 type_data* script_type_manager::get_type(type_data::type_kind kind) {
 	type_data target = type_data(kind);
@@ -56,6 +61,8 @@ type_data* script_type_manager::get_array_type(type_data* element) {
 //****************************************************************************
 //script_engine
 //****************************************************************************
+bool script_engine::optimize_enabled = true;
+
 script_engine::script_engine(const std::wstring& source, std::vector<function>* list_func, std::vector<constant>* list_const) {
 	init(source.data(), source.data() + source.size(), list_func, list_const);
 }
@@ -67,6 +74,29 @@ script_engine::script_engine(const std::vector<char>& source, std::vector<functi
 script_engine::script_engine(const wchar_t* source, const wchar_t* end, std::vector<function>* list_func, std::vector<constant>* list_const) {
 	init(source, end, list_func, list_const);
 }
+script_engine::script_engine(ByteBuffer* compiled, std::vector<function>* list_func) {
+	data = nullptr;
+	main_block = nullptr;
+
+	error = false;
+	error_line = -1;
+
+	code_count_parsed = 0;
+	code_count_optimized = 0;
+
+	try {
+		read_compiled(compiled, list_func);
+		intern_string_literals();
+		compute_frame_sizes();
+	}
+	catch (wexception& e) {
+		error = true;
+		error_message = e.GetErrorMessage();
+		blocks.clear();
+		events.clear();
+		main_block = nullptr;
+	}
+}
 script_engine::~script_engine() {
 	blocks.clear();
 }
@@ -85,9 +115,162 @@ void script_engine::init(const wchar_t* source, const wchar_t* end, std::vector<
 
 	events = p.events;
 
+	code_count_parsed = p.code_count_parsed;
+	code_count_optimized = p.code_count_optimized;
+
 	error = p.error;
 	error_message = p.error_message;
 	error_line = p.error_line;
+
+	if (!error) {
+		intern_string_literals();
+		compute_frame_sizes();
+	}
+}
+
+//Gives string literals their atom IDs up front, so key lookups made with them never hash at runtime
+void script_engine::intern_string_literals() {
+	script_atom_table* table = script_atom_table::get_instance();
+	for (script_block& iBlock : blocks) {
+		for (code& iCode : iBlock.codes) {
+			if (iCode.GetOp() == command_kind::pc_push_value)
+				table->intern_literal(iCode.data);
+		}
+	}
+}
+
+//Net stack effect of a code, where a code pushes more than it leaves, the larger count is used
+static int _get_stack_delta(const code& c) {
+	switch (c.GetOp()) {
+	case command_kind::pc_push_value:
+	case command_kind::pc_push_variable:
+	case command_kind::pc_push_variable2:
+	case command_kind::pc_dup_n:
+	case command_kind::pc_load_ptr:
+	case command_kind::pc_loop_ascent:
+	case command_kind::pc_loop_descent:
+	case command_kind::pc_loop_count:
+	case command_kind::pc_push_local:
+	case command_kind::pc_push_local2:
+	//Superinstructions count as the push they replaced, the fused codes after them are walked as usual
+	case command_kind::pc_sup_ll_op:
+	case command_kind::pc_sup_lv_op:
+	case command_kind::pc_sup_lv_op_assign:
+	case command_kind::pc_sup_ll_cmp_jump:
+	case command_kind::pc_sup_lv_cmp_jump:
+		return 1;
+	case command_kind::pc_loop_foreach:
+		return 2;
+	case command_kind::pc_wait:
+	case command_kind::pc_copy_assign:
+	case command_kind::pc_copy_assign_local:
+	case command_kind::pc_jump_if:
+	case command_kind::pc_jump_if_not:
+	case command_kind::pc_sup_cmp_jump:
+	case command_kind::pc_inline_add:
+	case command_kind::pc_inline_sub:
+	case command_kind::pc_inline_mul:
+	case command_kind::pc_inline_div:
+	case command_kind::pc_inline_fdiv:
+	case command_kind::pc_inline_mod:
+	case command_kind::pc_inline_pow:
+	case command_kind::pc_inline_app:
+	case command_kind::pc_inline_cat:
+	case command_kind::pc_inline_cmp_e:
+	case command_kind::pc_inline_cmp_g:
+	case command_kind::pc_inline_cmp_ge:
+	case command_kind::pc_inline_cmp_l:
+	case command_kind::pc_inline_cmp_le:
+	case command_kind::pc_inline_cmp_ne:
+	case command_kind::pc_inline_logic_and:
+	case command_kind::pc_inline_logic_or:
+	case command_kind::pc_inline_index_array:
+	case command_kind::pc_inline_index_array2:
+		return -1;
+	case command_kind::pc_ref_assign:
+		return -2;
+	case command_kind::pc_index_assign:
+		return -3;
+	case command_kind::pc_pop:
+		return -(int)c.arg0;
+	case command_kind::pc_call:
+		return -(int)c.arg1;
+	case command_kind::pc_call_and_push_result:
+		return 1 - (int)c.arg1;
+	case command_kind::pc_construct_array:
+		return 1 - (int)c.arg0;
+	case command_kind::pc_inline_inc:
+	case command_kind::pc_inline_dec:
+		return (c.arg0 == 0 && c.arg1) ? -1 : 0;
+	case command_kind::pc_inline_add_asi:
+	case command_kind::pc_inline_sub_asi:
+	case command_kind::pc_inline_mul_asi:
+	case command_kind::pc_inline_div_asi:
+	case command_kind::pc_inline_fdiv_asi:
+	case command_kind::pc_inline_mod_asi:
+	case command_kind::pc_inline_pow_asi:
+	case command_kind::pc_inline_cat_asi:
+		return c.arg0 ? -1 : -2;
+	}
+	return 0;
+}
+
+//The operation of an arithmetic op-assign code
+static value _perform_assign_op(script_machine* machine, command_kind cmd, const value* argv) {
+#define DEF_CASE(_c, _fn) case _c: return BaseFunction::_fn(machine, 2, argv);
+	switch (cmd) {
+		DEF_CASE(command_kind::pc_inline_add_asi, add);
+		DEF_CASE(command_kind::pc_inline_sub_asi, subtract);
+		DEF_CASE(command_kind::pc_inline_mul_asi, multiply);
+		DEF_CASE(command_kind::pc_inline_div_asi, divide);
+		DEF_CASE(command_kind::pc_inline_fdiv_asi, fdivide);
+		DEF_CASE(command_kind::pc_inline_mod_asi, remainder_);
+		DEF_CASE(command_kind::pc_inline_pow_asi, power);
+		//DEF_CASE(command_kind::pc_inline_cat_asi, concatenate);
+	}
+#undef DEF_CASE
+	return value();
+}
+
+//Sizes the environment frames of each block: the variable count from pc_var_alloc, and the
+//	deepest the stack gets, walking the codes in order and carrying depths forward through jumps.
+//	The stack estimate only needs to be close, frame_stack grows if it's ever exceeded.
+void script_engine::compute_frame_sizes() {
+	std::vector<int> listJumpDepth;
+	for (script_block& iBlock : blocks) {
+		iBlock.var_count = 0;
+		iBlock.stack_size = 0;
+		if (iBlock.func) continue;
+
+		size_t countCode = iBlock.codes.size();
+		listJumpDepth.assign(countCode + 1, 0);
+
+		int depth = iBlock.arguments;
+		int depthMax = depth;
+		for (size_t i = 0; i < countCode; ++i) {
+			const code& c = iBlock.codes[i];
+			depth = std::max(depth, listJumpDepth[i]);
+
+			int delta = _get_stack_delta(c);
+			switch (c.GetOp()) {
+			case command_kind::pc_var_alloc:
+				iBlock.var_count = std::max<uint32_t>(iBlock.var_count, c.arg0);
+				break;
+			case command_kind::pc_jump:
+			case command_kind::pc_jump_if:
+			case command_kind::pc_jump_if_not:
+			case command_kind::pc_jump_if_nopop:
+			case command_kind::pc_jump_if_not_nopop:
+				if (c.arg0 > i && c.arg0 <= countCode)
+					listJumpDepth[c.arg0] = std::max(listJumpDepth[c.arg0], depth + delta);
+				break;
+			}
+
+			depth = std::max(depth + delta, 0);
+			depthMax = std::max(depthMax, depth);
+		}
+		iBlock.stack_size = depthMax;
+	}
 }
 
 script_block* script_engine::new_block(int level, block_kind kind) {
@@ -95,8 +278,460 @@ script_block* script_engine::new_block(int level, block_kind kind) {
 	return &*blocks.insert(blocks.end(), x);
 }
 
+//----------------------------------------------------------------------
+//Compiled block serialization
+//----------------------------------------------------------------------
+static constexpr uint8_t COMPILED_TYPE_NONE = 0xff;
+static constexpr uint64_t COMPILED_FUNCPTR_TAG = 0x6a53;	//See parser::parse_clause
+
+static uint32_t _read_compiled_count(ByteBuffer* buffer, size_t sizeElem) {
+	uint32_t count = buffer->ReadValue<uint32_t>();
+	if ((uint64_t)count * sizeElem > buffer->GetSize() - buffer->GetOffset())
+		throw wexception("Compiled script data is truncated.");
+	return count;
+}
+static void _write_compiled_string(ByteBuffer* buffer, const std::string& str) {
+	buffer->WriteValue<uint32_t>(str.size());
+	buffer->WriteString(str);
+}
+static std::string _read_compiled_string(ByteBuffer* buffer) {
+	uint32_t size = _read_compiled_count(buffer, sizeof(char));
+	return size > 0 ? buffer->ReadString(size) : "";
+}
+
+static void _write_compiled_type(ByteBuffer* buffer, type_data* type) {
+	if (type == nullptr) {
+		buffer->WriteValue<uint8_t>(COMPILED_TYPE_NONE);
+		return;
+	}
+	buffer->WriteValue<uint8_t>(type->get_kind());
+	if (type->get_kind() == type_data::tk_array)
+		_write_compiled_type(buffer, type->get_element());
+}
+static type_data* _read_compiled_type(ByteBuffer* buffer) {
+	uint8_t kind = buffer->ReadValue<uint8_t>();
+	if (kind == COMPILED_TYPE_NONE) return nullptr;
+
+	script_type_manager* typeManager = script_type_manager::get_instance();
+	switch (kind) {
+	case type_data::tk_null:
+	case type_data::tk_int:
+	case type_data::tk_float:
+	case type_data::tk_char:
+	case type_data::tk_boolean:
+		return typeManager->get_type((type_data::type_kind)kind);
+	case type_data::tk_array:
+		return typeManager->get_array_type(_read_compiled_type(buffer));
+	}
+	throw wexception("Compiled script data contains an invalid type.");
+}
+
+static bool _write_compiled_value(ByteBuffer* buffer, const value& val) {
+	type_data* type = val.has_data() ? val.get_type() : nullptr;
+	_write_compiled_type(buffer, type);
+	if (type == nullptr) return true;
+
+	switch (type->get_kind()) {
+	case type_data::tk_null:
+		break;
+	case type_data::tk_int:
+		buffer->WriteInteger64(val.as_int());
+		break;
+	case type_data::tk_float:
+		buffer->WriteDouble(val.as_float());
+		break;
+	case type_data::tk_char:
+		buffer->WriteValue<wchar_t>(val.as_char());
+		break;
+	case type_data::tk_boolean:
+		buffer->WriteBoolean(val.as_boolean());
+		break;
+	case type_data::tk_array:
+	{
+		if (val.is_packed_string()) {
+			std::wstring_view str = val.as_string_view();
+			buffer->WriteBoolean(true);
+			buffer->WriteValue<uint32_t>(str.size());
+			buffer->Write((LPVOID)str.data(), str.size() * sizeof(wchar_t));
+		}
+		else {
+			size_t count = val.length_as_array();
+			buffer->WriteBoolean(false);
+			buffer->WriteValue<uint32_t>(count);
+			for (size_t i = 0; i < count; ++i) {
+				if (!_write_compiled_value(buffer, val.index_as_array_copy(i)))
+					return false;
+			}
+		}
+		break;
+	}
+	default:
+		return false;	//Pointers only exist at runtime
+	}
+	return true;
+}
+static value _read_compiled_value(ByteBuffer* buffer) {
+	value res;
+
+	type_data* type = _read_compiled_type(buffer);
+	if (type == nullptr) return res;
+
+	switch (type->get_kind()) {
+	case type_data::tk_int:
+		res.reset(type, buffer->ReadInteger64());
+		break;
+	case type_data::tk_float:
+		res.reset(type, buffer->ReadDouble());
+		break;
+	case type_data::tk_char:
+		res.reset(type, buffer->ReadValue<wchar_t>());
+		break;
+	case type_data::tk_boolean:
+		res.reset(type, buffer->ReadBoolean());
+		break;
+	case type_data::tk_array:
+	{
+		if (buffer->ReadBoolean()) {
+			uint32_t size = _read_compiled_count(buffer, sizeof(wchar_t));
+			std::wstring str(size, L'\0');
+			if (size > 0)
+				buffer->Read(&str[0], size * sizeof(wchar_t));
+			res.reset(type, str);
+		}
+		else {
+			uint32_t count = _read_compiled_count(buffer, sizeof(uint8_t));
+			std::vector<value> arr(count);
+			for (uint32_t i = 0; i < count; ++i)
+				arr[i] = _read_compiled_value(buffer);
+			res.reset(type, arr);
+		}
+		break;
+	}
+	default:
+		res.set(type);
+		break;
+	}
+	return res;
+}
+
+bool script_engine::write_compiled(ByteBuffer* buffer) {
+	if (error) return false;
+
+	std::unordered_map<const script_block*, uint32_t> mapBlockIndex;
+	for (script_block& iBlock : blocks)
+		mapBlockIndex.insert(std::make_pair(&iBlock, (uint32_t)mapBlockIndex.size()));
+
+	buffer->WriteValue<uint32_t>(blocks.size());
+	for (script_block& iBlock : blocks) {
+		buffer->WriteValue<uint32_t>(iBlock.level);
+		buffer->WriteValue<uint32_t>(iBlock.arguments);
+		buffer->WriteValue<uint8_t>((uint8_t)iBlock.kind);
+		buffer->WriteBoolean(iBlock.func != nullptr);
+		_write_compiled_string(buffer, iBlock.name);
+	}
+
+	buffer->WriteValue<uint32_t>(mapBlockIndex[main_block]);
+	buffer->WriteValue<uint32_t>(events.size());
+	for (auto& [name, pBlock] : events) {
+		_write_compiled_string(buffer, name);
+		buffer->WriteValue<uint32_t>(mapBlockIndex[pBlock]);
+	}
+
+	for (script_block& iBlock : blocks) {
+		buffer->WriteValue<uint32_t>(iBlock.codes.size());
+		for (code& c : iBlock.codes) {
+			command_kind op = c.GetOp();
+			buffer->WriteValue<uint8_t>((uint8_t)op);
+			buffer->WriteValue<uint32_t>(c.GetLine());
+#ifdef _DEBUG
+			_write_compiled_string(buffer, c.var_name);
+#endif
+
+			switch (op) {
+			case command_kind::pc_push_value:
+			{
+				//Function pointer literals carry the address of their block
+				const value& val = c.data;
+				if (val.has_data() && val.get_type()->get_kind() == type_data::tk_int) {
+					uint64_t bits = (uint64_t)val.as_int();
+					if ((bits >> 48) == COMPILED_FUNCPTR_TAG) {
+						auto itrBlock = mapBlockIndex.find((const script_block*)(uintptr_t)(bits & 0xffffffff));
+						if (itrBlock != mapBlockIndex.end()) {
+							buffer->WriteBoolean(true);
+							buffer->WriteValue<uint32_t>(itrBlock->second);
+							break;
+						}
+					}
+				}
+				buffer->WriteBoolean(false);
+				if (!_write_compiled_value(buffer, val))
+					return false;
+				break;
+			}
+			case command_kind::pc_call:
+			case command_kind::pc_call_and_push_result:
+			{
+				auto itrBlock = mapBlockIndex.find(c.block);
+				if (itrBlock == mapBlockIndex.end())
+					return false;
+				buffer->WriteValue<uint32_t>(itrBlock->second);
+				buffer->WriteValue<uint32_t>(c.arg1);
+				break;
+			}
+			case command_kind::pc_inline_cast_var:
+				_write_compiled_type(buffer, (type_data*)c.arg0);
+				buffer->WriteValue<uint32_t>(c.arg1);
+				break;
+			default:
+				buffer->WriteValue<uint64_t>(c.arg0);
+				buffer->WriteValue<uint32_t>(c.arg1);
+				break;
+			}
+		}
+	}
+
+	return true;
+}
+void script_engine::read_compiled(ByteBuffer* buffer, std::vector<function>* list_func) {
+	//Native blocks are matched to the current function tables by name and argument count
+	std::unordered_map<std::string, std::vector<const function*>> mapFunc;
+	for (const function& iFunc : parser::get_base_operations())
+		mapFunc[iFunc.name].push_back(&iFunc);
+	if (list_func) {
+		for (const function& iFunc : *list_func)
+			mapFunc[iFunc.name].push_back(&iFunc);
+	}
+
+	std::vector<script_block*> listBlock;
+	{
+		uint32_t countBlock = _read_compiled_count(buffer, sizeof(uint32_t));
+		listBlock.resize(countBlock);
+		for (uint32_t iBlock = 0; iBlock < countBlock; ++iBlock) {
+			uint32_t level = buffer->ReadValue<uint32_t>();
+			uint32_t arguments = buffer->ReadValue<uint32_t>();
+			block_kind kind = (block_kind)buffer->ReadValue<uint8_t>();
+			bool bNative = buffer->ReadBoolean();
+
+			script_block* pBlock = new_block(level, kind);
+			pBlock->arguments = arguments;
+			pBlock->name = _read_compiled_string(buffer);
+
+			if (bNative) {
+				auto itrFunc = mapFunc.find(pBlock->name);
+				if (itrFunc != mapFunc.end()) {
+					for (const function* pFunc : itrFunc->second) {
+						if (pFunc->argc == arguments) {
+							pBlock->func = pFunc->func;
+							break;
+						}
+					}
+				}
+				if (pBlock->func == nullptr) {
+					throw wexception(StringUtility::FormatToWide("Compiled script references "
+						"an unknown function. (%s, argc=%u)", pBlock->name.c_str(), arguments));
+				}
+			}
+
+			listBlock[iBlock] = pBlock;
+		}
+	}
+	auto _GetBlock = [&](uint32_t index) -> script_block* {
+		if (index >= listBlock.size())
+			throw wexception("Compiled script data contains an invalid block index.");
+		return listBlock[index];
+	};
+
+	main_block = _GetBlock(buffer->ReadValue<uint32_t>());
+	{
+		uint32_t countEvent = _read_compiled_count(buffer, sizeof(uint32_t));
+		for (uint32_t iEvent = 0; iEvent < countEvent; ++iEvent) {
+			std::string name = _read_compiled_string(buffer);
+			events[name] = _GetBlock(buffer->ReadValue<uint32_t>());
+		}
+	}
+
+	for (script_block* pBlock : listBlock) {
+		uint32_t countCode = _read_compiled_count(buffer, sizeof(uint8_t) + sizeof(uint32_t));
+		pBlock->codes.reserve(countCode);
+		for (uint32_t iCode = 0; iCode < countCode; ++iCode) {
+			command_kind op = (command_kind)buffer->ReadValue<uint8_t>();
+			uint32_t line = buffer->ReadValue<uint32_t>();
+#ifdef _DEBUG
+			std::string varName = _read_compiled_string(buffer);
+#endif
+
+			switch (op) {
+			case command_kind::pc_push_value:
+			{
+				if (buffer->ReadBoolean()) {
+					script_block* pFunc = _GetBlock(buffer->ReadValue<uint32_t>());
+
+					uint64_t bits = 0;
+					bits |= (uint64_t)pFunc & 0xffffffff;
+					bits |= (uint64_t)(pFunc->arguments & 0xffff) << 32;
+					bits |= COMPILED_FUNCPTR_TAG << 48;
+					pBlock->codes.push_back(code(op, value(script_type_manager::get_int_type(), (int64_t&)bits)));
+				}
+				else {
+					pBlock->codes.push_back(code(op, _read_compiled_value(buffer)));
+				}
+				break;
+			}
+			case command_kind::pc_call:
+			case command_kind::pc_call_and_push_result:
+			{
+				script_block* pTarget = _GetBlock(buffer->ReadValue<uint32_t>());
+				uint32_t arg1 = buffer->ReadValue<uint32_t>();
+				pBlock->codes.push_back(code(op, (uint32_t)pTarget, arg1));
+				break;
+			}
+			case command_kind::pc_inline_cast_var:
+			{
+				type_data* type = _read_compiled_type(buffer);
+				uint32_t arg1 = buffer->ReadValue<uint32_t>();
+				pBlock->codes.push_back(code(op, (uint32_t)type, arg1));
+				break;
+			}
+			default:
+			{
+				uint64_t arg0 = buffer->ReadValue<uint64_t>();
+				uint32_t arg1 = buffer->ReadValue<uint32_t>();
+				pBlock->codes.push_back(code(op, (uint32_t)arg0, arg1));
+				break;
+			}
+			}
+
+			code& c = pBlock->codes.back();
+			c.SetLine(line);
+#ifdef _DEBUG
+			c.var_name = varName;
+#endif
+		}
+	}
+}
+
 //****************************************************************************
-//script_machine::environment
+//script_machine::frame_arena
+//****************************************************************************
+script_machine::frame_arena::frame_arena() {
+	chunk_next = nullptr;
+	chunk_end = nullptr;
+}
+
+size_t script_machine::frame_arena::_get_size_class(size_t n) {
+	size_t res = 0;
+	while ((MIN_FRAME << res) < n)
+		++res;
+	return res;
+}
+
+//Reserves a free list slot for the frame up front, so that handing it back can't throw
+value* script_machine::frame_arena::_carve(size_t sizeClass) {
+	if (sizeClass >= free_frames.size()) {
+		free_frames.resize(sizeClass + 1);
+		count_frames.resize(sizeClass + 1, 0);
+	}
+
+	std::vector<value*>& listFree = free_frames[sizeClass];
+	size_t count = ++count_frames[sizeClass];
+	if (listFree.capacity() < count)
+		listFree.reserve(std::max(count, listFree.capacity() * 2));
+
+	value* res = chunk_next;
+	chunk_next += MIN_FRAME << sizeClass;
+	return res;
+}
+value* script_machine::frame_arena::allocate(size_t n, size_t* capacity) {
+	size_t sizeClass = _get_size_class(n);
+	size_t sizeFrame = MIN_FRAME << sizeClass;
+	*capacity = sizeFrame;
+
+	if (sizeClass < free_frames.size() && free_frames[sizeClass].size() > 0) {
+		value* res = free_frames[sizeClass].back();
+		free_frames[sizeClass].pop_back();
+		return res;
+	}
+
+	if ((size_t)(chunk_end - chunk_next) < sizeFrame) {
+		//Hand what's left of the current chunk to the free lists, largest frames first
+		while ((size_t)(chunk_end - chunk_next) >= MIN_FRAME) {
+			size_t sizeClassRest = _get_size_class(chunk_end - chunk_next);
+			if ((MIN_FRAME << sizeClassRest) > (size_t)(chunk_end - chunk_next))
+				--sizeClassRest;
+			value* rest = _carve(sizeClassRest);
+			deallocate(rest, MIN_FRAME << sizeClassRest);
+		}
+
+		size_t sizeChunk = std::max(CHUNK_SIZE, sizeFrame);
+		chunks.emplace_back(new value[sizeChunk]);
+		chunk_next = chunks.back().get();
+		chunk_end = chunk_next + sizeChunk;
+	}
+
+	return _carve(sizeClass);
+}
+void script_machine::frame_arena::deallocate(value* p, size_t capacity) noexcept {
+	//Frames only come from _carve, which already made room for them
+	free_frames[_get_size_class(capacity)].push_back(p);
+}
+
+//****************************************************************************
+//script_machine::frame_stack
+//****************************************************************************
+void script_machine::frame_stack::acquire(size_t n) {
+	release();
+	if (n > 0)
+		_data = _arena->allocate(n, &_capacity);
+}
+void script_machine::frame_stack::release() {
+	if (_data == nullptr) return;
+	clear();
+	_arena->deallocate(_data, _capacity);
+	_data = nullptr;
+	_capacity = 0;
+}
+
+void script_machine::frame_stack::_grow(size_t n) {
+	size_t capacityNew = 0;
+	value* dataNew = _arena->allocate(std::max(n, _capacity * 2), &capacityNew);
+	for (size_t i = 0; i < _size; ++i) {
+		dataNew[i] = _data[i];
+		_data[i] = value();
+	}
+	if (_data)
+		_arena->deallocate(_data, _capacity);
+	_data = dataNew;
+	_capacity = capacityNew;
+}
+
+void script_machine::frame_stack::resize(size_t n) {
+	if (n > _capacity)
+		_grow(n);
+	for (size_t i = n; i < _size; ++i)
+		_data[i] = value();
+	_size = n;
+}
+void script_machine::frame_stack::clear() {
+	for (size_t i = 0; i < _size; ++i)
+		_data[i] = value();
+	_size = 0;
+}
+
+void script_machine::frame_stack::take_reversed(frame_stack& src, size_t n) {
+	if (_size + n > _capacity)
+		_grow(_size + n);
+
+	value* pSrc = src._data + src._size;
+	for (size_t i = 0; i < n; ++i) {
+		--pSrc;
+		_data[_size++] = *pSrc;
+		*pSrc = value();
+	}
+	src._size -= n;
+}
+
+//****************************************************************************
+//script_machine::env_allocator
 //****************************************************************************
 script_machine::env_allocator::env_allocator(script_machine* machine) : machine(machine) {
 	_alloc_more(1024);
@@ -115,14 +750,14 @@ void script_machine::env_allocator::_alloc_more(size_t n) {
 		throw std::bad_array_new_length();
 
 	for (size_t i = 0; i < n; ++i) {
-		size_t index = before_size + i;
-
-		environment env(machine);
-		env._index = index;
-
-		environments.push_back(std::move(env));
-		free_environments.push_back(index);
+		environments.emplace_back(machine);
+		environments.back()._index = before_size + i;
 	}
+
+	//Reversed, so the lowest indices are taken first
+	free_environments.reserve(free_environments.size() + n);
+	for (size_t i = n; i > 0; --i)
+		free_environments.push_back(before_size + i - 1);
 }
 
 script_machine::env_allocator::value_type* 
@@ -131,8 +766,8 @@ script_machine::env_allocator::allocate(size_t n) {
 		_alloc_more(1024);
 	}
 
-	size_t free_index = free_environments.front();
-	free_environments.pop_front();
+	size_t free_index = free_environments.back();
+	free_environments.pop_back();
 
 	return &environments[free_index];
 }
@@ -140,10 +775,13 @@ void script_machine::env_allocator::deallocate(value_type* p, size_t n) noexcept
 	for (size_t i = 0; i < n; ++i) {
 		value_type& env = p[i];
 
-		env.variables.clear();
-		env.stack.clear();
+		env.variables.release();
+		env.stack.release();
 
 		free_environments.push_back(env._index);
+
+		//May release the parent chain in turn
+		env.parent = nullptr;
 	}
 }
 
@@ -152,16 +790,20 @@ void script_machine::env_allocator::deallocate(value_type* p, size_t n) noexcept
 //****************************************************************************
 script_machine::environment::environment(script_machine* machine) : 
 	machine(machine), _index(-1),
-	parent(parent),
-	sub(sub), ip(0),
+	parent(nullptr),
+	sub(nullptr), ip(0),
+	variables(&machine->arena), stack(&machine->arena),
 	hasResult(false), waitCount(0) {}
 
-script_machine::environment::environment(const environment& base_from, sptr<environment> parent, script_block* sub) :
-	environment(base_from.machine)
-{
-	_index = base_from._index;
+void script_machine::environment::init(sptr<environment> parent, script_block* sub) {
 	this->parent = parent;
 	this->sub = sub;
+	ip = 0;
+	hasResult = false;
+	waitCount = 0;
+
+	variables.acquire(sub->var_count);
+	stack.acquire(sub->stack_size);
 }
 
 //****************************************************************************
@@ -208,6 +850,10 @@ void script_machine::reset() {
 	list_parent_environment.clear();
 	threads.clear();
 	current_thread_index = {};
+
+	sweep_tick = 0;
+	parked_threads.clear();
+	wake_buckets.clear();
 }
 void script_machine::run() {
 	if (bTerminate) return;
@@ -216,9 +862,9 @@ void script_machine::run() {
 		error_line = -1;
 
 		env_ptr mainEnv = get_new_environment();
-		*mainEnv = environment(*mainEnv, nullptr, engine->main_block);
+		mainEnv->init(nullptr, engine->main_block);
 
-		threads.push_back(mainEnv);
+		threads.push_back(thread_slot{ mainEnv, 0 });
 
 		current_thread_index = threads.begin();
 
@@ -258,12 +904,12 @@ void script_machine::interrupt(script_block* sub) {
 
 	// Replace current thread with the interrupt
 	{
-		env_ptr env_first = *current_thread_index;
+		env_ptr env_first = current_thread_index->env;
 
 		env_ptr new_env = get_new_environment();
-		*new_env = environment(*new_env, env_first, sub);
+		new_env->init(env_first, sub);
 
-		*current_thread_index = new_env;
+		current_thread_index->env = new_env;
 
 		finished = false;
 
@@ -279,18 +925,105 @@ void script_machine::interrupt(script_block* sub) {
 }
 script_machine::env_ptr script_machine::add_thread(script_block* sub) {
 	env_ptr e = get_new_environment();
-	*e = environment(*e, *current_thread_index, sub);
+	e->init(current_thread_index->env, sub);
 
-	threads.insert(++current_thread_index, e);
-	--current_thread_index;
+	uint64_t order = get_order_after(current_thread_index);
+	threads.insert(std::next(current_thread_index), thread_slot{ e, order });
 
 	return MOVE(e);
 }
 script_machine::env_ptr script_machine::add_child_block(script_block* sub) {
 	env_ptr e = get_new_environment();
-	*e = environment(*e, *current_thread_index, sub);
+	e->init(current_thread_index->env, sub);
+
+	return current_thread_index->env = MOVE(e);
+}
+
+//Order for a new thread placed right after itr, it must also come before any parked thread in between
+uint64_t script_machine::get_order_after(std::list<thread_slot>::iterator itr) {
+	uint64_t orderPrev = 0;
+	uint64_t orderNext = 0;
+	auto _GetBounds = [&]() {
+		orderPrev = itr->order;
+		orderNext = orderPrev <= UINT64_MAX - THREAD_ORDER_SPACING * 2 ?
+			orderPrev + THREAD_ORDER_SPACING * 2 : UINT64_MAX;
+
+		auto itrNext = std::next(itr);
+		if (itrNext != threads.end())
+			orderNext = std::min(orderNext, itrNext->order);
+
+		auto itrParked = parked_threads.upper_bound(orderPrev);
+		if (itrParked != parked_threads.end())
+			orderNext = std::min(orderNext, itrParked->first);
+	};
+
+	_GetBounds();
+	if (orderNext - orderPrev < 2) {
+		renumber_threads();
+		_GetBounds();
+	}
+	return orderPrev + (orderNext - orderPrev) / 2;
+}
+//Spreads the orders of all threads, runnable and parked, evenly again
+void script_machine::renumber_threads() {
+	std::map<uint64_t, parked_thread> parkedNew;
+	wake_buckets.clear();
+
+	uint64_t order = 0;
+	auto itrParked = parked_threads.begin();
+	auto _AddParked = [&]() {
+		wake_buckets[itrParked->second.wake_tick].push_back(order);
+		parkedNew.emplace_hint(parkedNew.end(), order, MOVE(itrParked->second));
+		order += THREAD_ORDER_SPACING;
+		++itrParked;
+	};
+
+	for (thread_slot& iThread : threads) {
+		while (itrParked != parked_threads.end() && itrParked->first < iThread.order)
+			_AddParked();
+		iThread.order = order;
+		order += THREAD_ORDER_SPACING;
+	}
+	while (itrParked != parked_threads.end())
+		_AddParked();
+
+	parked_threads = MOVE(parkedNew);
+}
+
+//Takes the current thread out of the rotation, it's visited again in the sweep it would've stopped waiting in
+void script_machine::park_thread(int waitCount) {
+	uint64_t tickWake = sweep_tick + waitCount + 1;
+	uint64_t order = current_thread_index->order;
+
+	parked_threads.emplace(order, parked_thread{ current_thread_index->env, tickWake });
+	wake_buckets[tickWake].push_back(order);
 
-	return *current_thread_index = MOVE(e);
+	current_thread_index = threads.erase(current_thread_index);
+	yield();
+}
+//Puts the threads due this sweep back in their places in the rotation
+void script_machine::wake_threads() {
+	while (wake_buckets.size() > 0 && wake_buckets.begin()->first <= sweep_tick) {
+		std::vector<uint64_t>& listOrder = wake_buckets.begin()->second;
+		std::sort(listOrder.begin(), listOrder.end());
+
+		auto itrThread = threads.begin();
+		for (uint64_t order : listOrder) {
+			auto itrParked = parked_threads.find(order);
+			if (itrParked == parked_threads.end()) continue;
+
+			while (itrThread != threads.end() && itrThread->order < order)
+				++itrThread;
+
+			env_ptr env = itrParked->second.env;
+			env->waitCount = 0;
+			threads.insert(itrThread, thread_slot{ env, order });
+
+			parked_threads.erase(itrParked);
+		}
+
+		wake_buckets.erase(wake_buckets.begin());
+	}
 }
 
 void script_machine::run_code() {
@@ -300,7 +1033,7 @@ void script_machine::run_code() {
 	}
 	try {
 		while (!finished && !bTerminate) {
-			env_ptr current = *current_thread_index;
+			env_ptr current = current_thread_index->env;
 
 			if (current->waitCount > 0) {
 				--(current->waitCount);
@@ -330,7 +1063,7 @@ void script_machine::run_code() {
 					else {
 						if (current->hasResult && parent != nullptr)
 							parent->stack.push_back(current->variables[0]);
-						*current_thread_index = parent;
+						current_thread_index->env = parent;
 					}
 				}
 			}
@@ -352,6 +1085,12 @@ void script_machine::run_code() {
 					stack.pop_back();
 					if (current->waitCount < 0) break;
 
+					//The first thread hosts the events and can't leave the rotation, it still counts down below
+					if (current->waitCount > 0 && current_thread_index != threads.begin()) {
+						park_thread(current->waitCount);
+						break;
+					}
+
 					__fallthrough;
 				}
 				case command_kind::pc_yield:
@@ -364,7 +1103,7 @@ void script_machine::run_code() {
 				case command_kind::pc_var_format:
 				{
 					for (size_t i = c->arg0; i < c->arg0 + c->arg1; ++i) {
-						if (i >= variables.capacity()) break;
+						if (i >= variables.size()) break;
 						variables[i] = value();
 					}
 					break;
@@ -380,7 +1119,7 @@ void script_machine::run_code() {
 				case command_kind::pc_push_variable:
 				case command_kind::pc_push_variable2:
 				{
-					value* var = find_variable_symbol<false>(current, c, c->arg0, c->arg1);
+					value* var = find_variable_symbol<false>(current.get(), c, c->arg0, c->arg1);
 					if (var == nullptr) break;
 
 					if (opc == command_kind::pc_push_variable)
@@ -456,21 +1195,8 @@ void script_machine::run_code() {
 				case command_kind::pc_ref_assign:
 				{
 					if (opc == command_kind::pc_copy_assign) {
-						value* dest = find_variable_symbol<true>(current, c, c->arg0, c->arg1);
-						value* src = &stack.back();
-
-						if (dest != nullptr && src != nullptr) {
-							// pc_copy_assign
-							if (BaseFunction::_type_assign_check(this, src, dest)) {
-								type_data* prev_type = dest->get_type();
-
-								*dest = *src;
-								dest->make_unique();
-
-								if (prev_type && prev_type != src->get_type())
-									BaseFunction::_value_cast(dest, prev_type);
-							}
-						}
+						value* dest = find_variable_symbol<true>(current.get(), c, c->arg0, c->arg1);
+						copy_assign(dest, &stack.back());
 						stack.pop_back();
 					}
 					else {		// pc_ref_assign
@@ -524,11 +1250,8 @@ void script_machine::run_code() {
 						if (bPushResult)
 							stack.push_back(ret);
 					};
-					auto _PassArgsFromStack = [](size_t argc, std::vector<value>& srcStk, std::vector<value>& dstStk) {
-						for (int i = 0; i < argc; ++i) {
-							dstStk.push_back(srcStk.back());
-							srcStk.pop_back();
-						}
+					auto _PassArgsFromStack = [](size_t argc, frame_stack& srcStk, frame_stack& dstStk) {
+						dstStk.take_reversed(srcStk, argc);
 					};
 
 					script_block* sub = c->block; //(script_block*)c->arg0
@@ -663,6 +1386,10 @@ void script_machine::run_code() {
 					value* i = &stack.back();
 					value* src_array = i - 1;
 
+					//"ref" loops over a variable hold a pointer to it, and see every change made to it
+					if (src_array->get_type()->get_kind() == type_data::tk_pointer)
+						src_array = src_array->as_ptr();
+
 					size_t index = i->as_int();
 					size_t arrSize = src_array->length_as_array();
 
@@ -671,7 +1398,7 @@ void script_machine::run_code() {
 						bStopLoop = true;
 					}
 					else {
-						stack.push_back(src_array->index_as_array(index));
+						stack.push_back(src_array->index_as_array_copy(index));
 						//stack.back().make_unique();
 						i->set(i->get_type(), i->as_int() + 1i64);
 					}
@@ -701,7 +1428,6 @@ void script_machine::run_code() {
 						{
 							value appending = *val_ptr;
 							if (appending.get_type()->get_kind() != type_elem->get_kind()) {
-								appending.make_unique();
 								BaseFunction::_value_cast(&appending, type_elem);
 							}
 							res_arr[iVal] = appending;
@@ -723,7 +1449,7 @@ void script_machine::run_code() {
 				case command_kind::pc_inline_dec:
 				{
 					if (c->arg0) {
-						value* var = find_variable_symbol<false>(current, c,
+						value* var = find_variable_symbol<false>(current.get(), c,
 							ARG1_GET_LEVEL(c->arg1), ARG1_GET_VAR(c->arg1));
 						if (var == nullptr) break;
 						value res = (opc == command_kind::pc_inline_inc) ?
@@ -751,23 +1477,12 @@ void script_machine::run_code() {
 				//case command_kind::pc_inline_cat_asi:
 				{
 					auto PerformFunction = [&](value* dest, command_kind cmd, value* argv) {
-#define DEF_CASE(_c, _fn) case _c: *dest = BaseFunction::_fn(this, 2, argv); break;
-						switch (cmd) {
-							DEF_CASE(command_kind::pc_inline_add_asi, add);
-							DEF_CASE(command_kind::pc_inline_sub_asi, subtract);
-							DEF_CASE(command_kind::pc_inline_mul_asi, multiply);
-							DEF_CASE(command_kind::pc_inline_div_asi, divide);
-							DEF_CASE(command_kind::pc_inline_fdiv_asi, fdivide);
-							DEF_CASE(command_kind::pc_inline_mod_asi, remainder_);
-							DEF_CASE(command_kind::pc_inline_pow_asi, power);
-							//DEF_CASE(command_kind::pc_inline_cat_asi, concatenate);
-						}
-#undef DEF_CASE
+						*dest = _perform_assign_op(this, cmd, argv);
 					};
 
 					value res;
 					if (c->arg0) {
-						value* dest = find_variable_symbol<false>(current, c,
+						value* dest = find_variable_symbol<false>(current.get(), c,
 							ARG1_GET_LEVEL(c->arg1), ARG1_GET_VAR(c->arg1));
 						if (dest == nullptr) break;
 
@@ -796,21 +1511,26 @@ void script_machine::run_code() {
 				}
 				case command_kind::pc_inline_cat_asi:
 				{
+					//Appends onto the destination itself so that an unshared array is not copied. The type is kept.
+					auto _concat_assign = [&](value* dest, const value* x) {
+						type_data* prevType = dest->get_type();
+						if (BaseFunction::concatenate_direct(this, dest, x))
+							dest->set(prevType);
+					};
+
 					if (c->arg0) {
-						value* dest = find_variable_symbol<false>(current, c,
+						value* dest = find_variable_symbol<false>(current.get(), c,
 							ARG1_GET_LEVEL(c->arg1), ARG1_GET_VAR(c->arg1));
 						if (dest == nullptr) break;
 
-						value arg[2] = { *dest, stack.back() };
-						BaseFunction::concatenate_direct(this, 2, arg);
+						_concat_assign(dest, &stack.back());
 
 						stack.pop_back();
 					}
 					else {
 						value* pArg = &stack.back() - 1;
 
-						value arg[2] = { *(pArg->as_ptr()), pArg[1] };
-						BaseFunction::concatenate_direct(this, 2, arg);
+						_concat_assign(pArg->as_ptr(), &pArg[1]);
 
 						stack.pop_back();
 						stack.pop_back();
@@ -832,7 +1552,6 @@ void script_machine::run_code() {
 					}
 #undef DEF_CASE
 
-					arg->make_unique();
 					*arg = res;
 					break;
 				}
@@ -845,30 +1564,6 @@ void script_machine::run_code() {
 				case command_kind::pc_inline_pow:
 				case command_kind::pc_inline_app:
 				case command_kind::pc_inline_cat:
-				{
-					value res;
-					value* args = &stack.back() - 1;
-
-#define DEF_CASE(cmd, fn) case cmd: res = BaseFunction::fn(this, 2, args); break;
-					switch (opc) {
-						DEF_CASE(command_kind::pc_inline_add, add);
-						DEF_CASE(command_kind::pc_inline_sub, subtract);
-						DEF_CASE(command_kind::pc_inline_mul, multiply);
-						DEF_CASE(command_kind::pc_inline_div, divide);
-						DEF_CASE(command_kind::pc_inline_fdiv, fdivide);
-						DEF_CASE(command_kind::pc_inline_mod, remainder_);
-						DEF_CASE(command_kind::pc_inline_pow, power);
-						DEF_CASE(command_kind::pc_inline_app, append);
-						DEF_CASE(command_kind::pc_inline_cat, concatenate);
-					}
-#undef DEF_CASE
-
-					//stack.pop_back(2U);
-					//stack.push_back(res);
-					stack.pop_back();
-					stack.back() = res;
-					break;
-				}
 				case command_kind::pc_inline_cmp_e:
 				case command_kind::pc_inline_cmp_g:
 				case command_kind::pc_inline_cmp_ge:
@@ -877,28 +1572,12 @@ void script_machine::run_code() {
 				case command_kind::pc_inline_cmp_ne:
 				{
 					value* args = &stack.back() - 1;
-
-					value cmp_res = BaseFunction::compare(this, 2, args);
-					int cmp_r = cmp_res.as_int();
-
-					bool cmp_rb = false;
-
-#define DEF_CASE(cmd, expr) case cmd: cmp_rb = (expr); break;
-					switch (opc) {
-						DEF_CASE(command_kind::pc_inline_cmp_e, cmp_r == 0);
-						DEF_CASE(command_kind::pc_inline_cmp_g, cmp_r > 0);
-						DEF_CASE(command_kind::pc_inline_cmp_ge, cmp_r >= 0);
-						DEF_CASE(command_kind::pc_inline_cmp_l, cmp_r < 0);
-						DEF_CASE(command_kind::pc_inline_cmp_le, cmp_r <= 0);
-						DEF_CASE(command_kind::pc_inline_cmp_ne, cmp_r != 0);
-					}
-#undef DEF_CASE
+					value res = perform_binary_op(opc, args);
 
 					//stack.pop_back(2U);
 					//stack.push_back(res);
 					stack.pop_back();
-					stack.back().reset(script_type_manager::get_boolean_type(), cmp_rb);
-
+					stack.back() = res;
 					break;
 				}
 				case command_kind::pc_inline_logic_and:
@@ -942,21 +1621,62 @@ void script_machine::run_code() {
 					value* arr = &stack.back() - 1;
 					value* idx = arr + 1;
 
-					value* pRes = (value*)BaseFunction::index(this, 2, arr->as_ptr(), idx);
+					//Writes go through this pointer, so the indexed array is unshared first.
+					//	Only the arrays along the indexing path end up copied.
+					value* container = arr->as_ptr();
+					if (container != nullptr)
+						container->make_unique();
+
+					value* pRes = (value*)BaseFunction::index(this, 2, container, idx);
 					if (pRes == nullptr) break;
 
 					*arr = value(script_type_manager::get_ptr_type(), pRes);
 					stack.pop_back();	//pop idx
 					break;
 				}
+				case command_kind::pc_index_assign:
+				{
+					// Stack: .... [array pointer] [index] [value]
+					value* src = &stack.back();
+					value* idx = src - 1;
+					value* container = src[-2].as_ptr();
+
+					//Works on a copy of the element so that a packed array takes the result back in place
+					value elem = BaseFunction::index_copy(this, 2, container, idx);
+					if (error) break;
+
+					type_data* prevType = elem.get_type();
+					command_kind cmd = (command_kind)c->arg0;
+					bool bAssign = true;
+					if (cmd == command_kind::pc_ref_assign) {
+						bAssign = BaseFunction::_type_assign_check(this, src, &elem);
+						if (bAssign)
+							elem = *src;
+					}
+					else {
+						value arg[2] = { elem, *src };
+						elem = _perform_assign_op(this, cmd, arg);
+					}
+
+					if (bAssign) {
+						if (prevType && prevType != elem.get_type())
+							BaseFunction::_value_cast(&elem, prevType);
+						BaseFunction::index_assign(this, container, idx, &elem);
+					}
+
+					stack.pop_back();
+					stack.pop_back();
+					stack.pop_back();
+					break;
+				}
 				case command_kind::pc_inline_index_array2:
 				{
 					value* arr = &stack.back() - 1;
 					value* idx = arr + 1;
 
-					value* pRes = (value*)BaseFunction::index(this, 2, arr, idx);
-					if (pRes == nullptr) break;
-					value res = *pRes;
+					//Read-only, packed strings are left packed
+					value res = BaseFunction::index_copy(this, 2, arr, idx);
+					if (error) break;
 
 					//stack.pop_back(2U);
 					//stack.push_back(res);
@@ -971,6 +1691,102 @@ void script_machine::run_code() {
 					var->reset(script_type_manager::get_int_type(), (int64_t)len);
 					break;
 				}
+
+				// ----------------------------------Superinstructions----------------------------------
+				case command_kind::pc_push_local:
+				case command_kind::pc_push_local2:
+				{
+					value* var = find_local_variable<false>(current.get(), c, c->arg1);
+					if (var == nullptr) break;
+
+					if (opc == command_kind::pc_push_local)
+						stack.push_back(*var);
+					else
+						stack.push_back(value(script_type_manager::get_ptr_type(), var));
+					break;
+				}
+				case command_kind::pc_copy_assign_local:
+				{
+					value* dest = find_local_variable<true>(current.get(), c, c->arg1);
+					copy_assign(dest, &stack.back());
+					stack.pop_back();
+					break;
+				}
+				case command_kind::pc_inline_inc_local:
+				case command_kind::pc_inline_dec_local:
+				{
+					value* var = find_local_variable<false>(current.get(), c, c->arg1);
+					if (var == nullptr) break;
+					value res = (opc == command_kind::pc_inline_inc_local) ?
+						BaseFunction::successor(this, 1, var) : BaseFunction::predecessor(this, 1, var);
+					*var = res;
+					break;
+				}
+				case command_kind::pc_sup_ll_op:
+				case command_kind::pc_sup_lv_op:
+				case command_kind::pc_sup_lv_op_assign:
+				case command_kind::pc_sup_ll_cmp_jump:
+				case command_kind::pc_sup_lv_cmp_jump:
+				{
+					// c[0]: pc_push_variable, c[1]: pc_push_variable or pc_push_value, c[2]: operation
+					value args[2];
+					{
+						value* var = find_local_variable<false>(current.get(), c, c->arg1);
+						if (var == nullptr) break;
+						args[0] = *var;
+					}
+					if (opc == command_kind::pc_sup_ll_op || opc == command_kind::pc_sup_ll_cmp_jump) {
+						value* var = find_local_variable<false>(current.get(), c + 1, c[1].arg1);
+						if (var == nullptr) break;
+						args[1] = *var;
+					}
+					else {
+						args[1] = c[1].data;
+					}
+
+					value res = perform_binary_op(c[2].GetOp(), args);
+
+					switch (opc) {
+					case command_kind::pc_sup_ll_op:
+					case command_kind::pc_sup_lv_op:
+						stack.push_back(res);
+						current->ip += 2;
+						break;
+					case command_kind::pc_sup_lv_op_assign:
+					{
+						if (error) break;
+						value* dest = find_local_variable<true>(current.get(), c + 3, c[3].arg1);
+						copy_assign(dest, &res);
+						current->ip += 3;
+						break;
+					}
+					default:	// c[3]: pc_jump_if or pc_jump_if_not
+					{
+						bool bJE = c[3].GetOp() == command_kind::pc_jump_if;
+						if (res.as_boolean() == bJE)
+							current->ip = c[3].arg0;
+						else
+							current->ip += 3;
+						break;
+					}
+					}
+					break;
+				}
+				case command_kind::pc_sup_cmp_jump:
+				{
+					// c[0]: comparison in [arg0], c[1]: pc_jump_if or pc_jump_if_not
+					value* args = &stack.back() - 1;
+					bool b = perform_binary_op((command_kind)c->arg0, args).as_boolean();
+					stack.pop_back();
+					stack.pop_back();
+
+					bool bJE = c[1].GetOp() == command_kind::pc_jump_if;
+					if (b == bJE)
+						current->ip = c[1].arg0;
+					else
+						current->ip += 1;
+					break;
+				}
 				}
 			}
 
@@ -985,11 +1801,73 @@ void script_machine::run_code() {
 	}
 }
 
+value script_machine::perform_binary_op(command_kind op, const value* args) {
+	switch (op) {
+#define DEF_CASE(cmd, fn) case cmd: return BaseFunction::fn(this, 2, args);
+		DEF_CASE(command_kind::pc_inline_add, add);
+		DEF_CASE(command_kind::pc_inline_sub, subtract);
+		DEF_CASE(command_kind::pc_inline_mul, multiply);
+		DEF_CASE(command_kind::pc_inline_div, divide);
+		DEF_CASE(command_kind::pc_inline_fdiv, fdivide);
+		DEF_CASE(command_kind::pc_inline_mod, remainder_);
+		DEF_CASE(command_kind::pc_inline_pow, power);
+		DEF_CASE(command_kind::pc_inline_app, append);
+		DEF_CASE(command_kind::pc_inline_cat, concatenate);
+#undef DEF_CASE
+	case command_kind::pc_inline_cmp_e:
+	case command_kind::pc_inline_cmp_g:
+	case command_kind::pc_inline_cmp_ge:
+	case command_kind::pc_inline_cmp_l:
+	case command_kind::pc_inline_cmp_le:
+	case command_kind::pc_inline_cmp_ne:
+	{
+		int cmp_r = BaseFunction::compare(this, 2, args).as_int();
+
+		bool cmp_rb = false;
+#define DEF_CASE(cmd, expr) case cmd: cmp_rb = (expr); break;
+		switch (op) {
+			DEF_CASE(command_kind::pc_inline_cmp_e, cmp_r == 0);
+			DEF_CASE(command_kind::pc_inline_cmp_g, cmp_r > 0);
+			DEF_CASE(command_kind::pc_inline_cmp_ge, cmp_r >= 0);
+			DEF_CASE(command_kind::pc_inline_cmp_l, cmp_r < 0);
+			DEF_CASE(command_kind::pc_inline_cmp_le, cmp_r <= 0);
+			DEF_CASE(command_kind::pc_inline_cmp_ne, cmp_r != 0);
+		}
+#undef DEF_CASE
+
+		return value(script_type_manager::get_boolean_type(), cmp_rb);
+	}
+	}
+	return value();
+}
+void script_machine::copy_assign(value* dest, const value* src) {
+	if (dest == nullptr || src == nullptr) return;
+
+	if (BaseFunction::_type_assign_check(this, src, dest)) {
+		type_data* prev_type = dest->get_type();
+
+		//Shares the source's storage, copy-on-write takes care of later writes to either
+		*dest = *src;
+
+		if (prev_type && prev_type != src->get_type())
+			BaseFunction::_value_cast(dest, prev_type);
+	}
+}
+
+void script_machine::raise_error_uninitialized(code* c) {
+#ifdef _DEBUG
+	raise_error(StringUtility::Format("Variable hasn't been initialized: %s\r\n",
+		c->var_name.c_str()));
+#else
+	raise_error("Variable hasn't been initialized.\r\n");
+#endif
+}
+
 template<bool ALLOW_NULL>
-value* script_machine::find_variable_symbol(env_ptr current_env, code* c,
+value* script_machine::find_variable_symbol(environment* current_env, code* c,
 	uint32_t level, uint32_t variable)
 {
-	for (env_ptr i = current_env; i != nullptr; i = i->parent) {
+	for (environment* i = current_env; i != nullptr; i = i->parent.get()) {
 		if (i->sub->level == level) {
 			value* res = &(i->variables[variable]);
 
@@ -999,12 +1877,7 @@ value* script_machine::find_variable_symbol(env_ptr current_env, code* c,
 				if (res->has_data())
 					return res;
 				else {
-#ifdef _DEBUG
-					raise_error(StringUtility::Format("Variable hasn't been initialized: %s\r\n",
-						c->var_name.c_str()));
-#else
-					raise_error("Variable hasn't been initialized.\r\n");
-#endif
+					raise_error_uninitialized(c);
 					return nullptr;
 				}
 			}
@@ -1019,4 +1892,18 @@ value* script_machine::find_variable_symbol(env_ptr current_env, code* c,
 		level, variable));
 #endif
 	return nullptr;
-}
\ No newline at end of file
+}
+
+//Variables owned by the environment itself, their slot is known at parse time
+template<bool ALLOW_NULL>
+value* script_machine::find_local_variable(environment* current_env, code* c, uint32_t variable) {
+	value* res = &(current_env->variables[variable]);
+
+	if constexpr (!ALLOW_NULL) {
+		if (!res->has_data()) {
+			raise_error_uninitialized(c);
+			return nullptr;
+		}
+	}
+	return res;
+}
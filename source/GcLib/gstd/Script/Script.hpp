@@ -33,6 +33,7 @@ namespace gstd {
 		script_type_manager(const script_type_manager& src);
 
 		std::set<type_data> types;
+		std::shared_mutex mtx_types;	//Scripts may be compiled on several threads at once
 
 		//Common types for quick access without std::set traversal
 		type_data* null_type;
@@ -52,11 +53,14 @@ namespace gstd {
 		}
 	};
 
+	class ByteBuffer;
+
 	class script_engine {
 	public:
 		script_engine(const std::wstring& source, std::vector<function>* list_func, std::vector<constant>* list_const);
 		script_engine(const std::vector<char>& source, std::vector<function>* list_func, std::vector<constant>* list_const);
 		script_engine(const wchar_t* source, const wchar_t* end, std::vector<function>* list_func, std::vector<constant>* list_const);
+		script_engine(ByteBuffer* compiled, std::vector<function>* list_func);	//From write_compiled output
 		virtual ~script_engine();
 
 		void init(const wchar_t* source, const wchar_t* end, std::vector<function>* list_func, std::vector<constant>* list_const);
@@ -68,7 +72,19 @@ namespace gstd {
 		int get_error_line() { return error_line; }
 
 		script_block* new_block(int level, block_kind kind);
+
+		//Serializes the compiled blocks, block pointers are stored as indices into the block list
+		//Returns false if the engine holds something that can't be serialized
+		bool write_compiled(ByteBuffer* buffer);
+	private:
+		void read_compiled(ByteBuffer* buffer, std::vector<function>* list_func);
+
+		void intern_string_literals();
+		void compute_frame_sizes();
 	public:
+		//Enables parser::optimize_block, and const value propagation while parsing
+		static bool optimize_enabled;
+
 		void* data;		// Client script pointer
 
 		bool error;
@@ -78,10 +94,81 @@ namespace gstd {
 		std::list<script_block> blocks;
 		script_block* main_block;
 		std::map<std::string, script_block*> events;
+
+		//Total code count of all script blocks before and after the optimization pass, 0 if it didn't run
+		size_t code_count_parsed;
+		size_t code_count_optimized;
 	};
 
 	class script_machine {
 	public:
+		//Recycles power-of-two sized value frames, carved from large chunks
+		class frame_arena {
+		public:
+			static constexpr size_t MIN_FRAME = 8;
+			static constexpr size_t CHUNK_SIZE = 0x2000;
+		private:
+			std::vector<unique_ptr<value[]>> chunks;
+			value* chunk_next;
+			value* chunk_end;
+
+			std::vector<std::vector<value*>> free_frames;	//Indexed by log2(capacity / MIN_FRAME)
+			std::vector<size_t> count_frames;		//Frames carved per size class, free lists are reserved to fit all of them
+
+			static size_t _get_size_class(size_t n);
+			value* _carve(size_t sizeClass);
+		public:
+			frame_arena();
+
+			//Returns a frame of at least n values and writes its actual capacity to *capacity
+			_NODISCARD value* allocate(size_t n, size_t* capacity);
+			//All values in the frame must be empty, never allocates
+			void deallocate(value* p, size_t capacity) noexcept;
+		};
+
+		//Vector-like stack over a frame_arena frame, moves to a larger frame when it overflows
+		class frame_stack {
+		private:
+			frame_arena* _arena;
+			value* _data;
+			size_t _size;
+			size_t _capacity;
+
+			void _grow(size_t n);
+		public:
+			frame_stack(frame_arena* arena) : _arena(arena), _data(nullptr), _size(0), _capacity(0) {}
+			frame_stack(const frame_stack&) = delete;
+			frame_stack& operator=(const frame_stack&) = delete;
+			~frame_stack() { release(); }
+
+			void acquire(size_t n);
+			void release();
+
+			size_t size() const { return _size; }
+			size_t capacity() const { return _capacity; }
+			bool empty() const { return _size == 0; }
+
+			value* data() { return _data; }
+			value& operator[](size_t i) { return _data[i]; }
+			value& back() { return _data[_size - 1]; }
+
+			void push_back(const value& v) {
+				if (_size == _capacity) {
+					value copy = v;		//v may live in this frame
+					_grow(_size + 1);
+					_data[_size++] = copy;
+				}
+				else
+					_data[_size++] = v;
+			}
+			void pop_back() { _data[--_size] = value(); }
+			void resize(size_t n);
+			void clear();
+
+			//Moves the top n values of src here in reverse order, same as n of (push_back(src.back()), src.pop_back())
+			void take_reversed(frame_stack& src, size_t n);
+		};
+
 		class environment {
 			friend script_machine;
 		private:
@@ -93,27 +180,38 @@ namespace gstd {
 			script_block* sub;
 			int ip;
 
-			std::vector<value> variables;
-			std::vector<value> stack;
+			frame_stack variables;
+			frame_stack stack;
 
 			bool hasResult;
 			int waitCount;
 		public:
 			environment(script_machine* machine);
-			environment(const environment& base_from, sptr<environment> parent, script_block* sub);
 
-			//environment& operator=(const environment& other) = delete;
+			void init(sptr<environment> parent, script_block* sub);
 		};
 
 		using env_ptr = sptr<environment>;
 
+		//A runnable thread, threads are kept sorted by order
+		struct thread_slot {
+			env_ptr env;
+			uint64_t order;
+		};
+		//A thread taken out of the rotation by a wait, until the sweep wake_tick
+		struct parked_thread {
+			env_ptr env;
+			uint64_t wake_tick;
+		};
+
+		static constexpr uint64_t THREAD_ORDER_SPACING = 1ui64 << 32;
 	private:
 		class env_allocator {
 		private:
 			script_machine* machine;
 
-			std::vector<environment> environments;
-			std::list<size_t> free_environments;
+			std::deque<environment> environments;	//deque, pointers must survive _alloc_more
+			std::vector<size_t> free_environments;
 		private:
 			void _alloc_more(size_t n);
 		public:
@@ -142,9 +240,15 @@ namespace gstd {
 
 		std::list<env_ptr> list_parent_environment;
 
-		std::list<env_ptr> threads;
-		std::list<env_ptr>::iterator current_thread_index;
+		std::list<thread_slot> threads;
+		std::list<thread_slot>::iterator current_thread_index;
+
+		//Counts the times the thread rotation wrapped around, parked threads wake by it
+		uint64_t sweep_tick;
+		std::map<uint64_t, parked_thread> parked_threads;				//By order
+		std::map<uint64_t, std::vector<uint64_t>> wake_buckets;			//Wake tick -> orders
 
+		frame_arena arena;			//Must outlive allocator
 		env_allocator allocator;
 	private:
 		_NODISCARD env_ptr get_new_environment();
@@ -196,19 +300,35 @@ namespace gstd {
 		int get_current_line();
 		int get_current_thread_addr() { return (int)current_thread_index._Ptr; }
 
-		size_t get_thread_count() { return threads.size(); }
+		size_t get_thread_count() { return threads.size() + parked_threads.size(); }
 	private:
 		void yield() {
-			if (current_thread_index == threads.begin())
+			if (current_thread_index == threads.begin()) {
+				++sweep_tick;
+				if (wake_buckets.size() > 0)
+					wake_threads();
 				current_thread_index = std::prev(threads.end());
+			}
 			else
 				--current_thread_index;
 		}
 
+		uint64_t get_order_after(std::list<thread_slot>::iterator itr);
+		void renumber_threads();
+		void park_thread(int waitCount);
+		void wake_threads();
+
 		void run_code();
 
+		value perform_binary_op(command_kind op, const value* args);
+		void copy_assign(value* dest, const value* src);
+
+		void raise_error_uninitialized(code* c);
+
 		template<bool ALLOW_NULL>
-		value* find_variable_symbol(env_ptr current_env, code* c,
+		value* find_variable_symbol(environment* current_env, code* c,
 			uint32_t level, uint32_t variable);
+		template<bool ALLOW_NULL>
+		value* find_local_variable(environment* current_env, code* c, uint32_t variable);
 	};
 }
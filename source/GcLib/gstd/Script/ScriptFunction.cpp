@@ -182,17 +182,17 @@ namespace gstd {
 			size_t ct_op = std::min(v_right->length_as_array(), ct_left);
 			value v[2];
 			for (size_t i = 0; i < ct_op; ++i) {
-				v[0] = (*v_left)[i];
-				v[1] = (*v_right)[i];
+				v[0] = v_left->index_as_array_copy(i);
+				v[1] = v_right->index_as_array_copy(i);
 				resArr[i] = func(2, v);
 			}
-			for (size_t i = ct_op; i < ct_left; ++i) resArr[i] = (*v_left)[i];
+			for (size_t i = ct_op; i < ct_left; ++i) resArr[i] = v_left->index_as_array_copy(i);
 		}
 		else {
 			value v[2];
 			v[1] = *v_right;
 			for (size_t i = 0; i < ct_left; ++i) {
-				v[0] = (*v_left)[i];
+				v[0] = v_left->index_as_array_copy(i);
 				resArr[i] = func(2, v);
 			}
 		}
@@ -424,7 +424,7 @@ namespace gstd {
 		type_data* elemType = nullptr;
 
 		for (size_t i = 0; i < arrVal.size(); ++i) {
-			value nv = (*val)[i];
+			value nv = val->index_as_array_copy(i);
 
 			if (nv.get_type()->get_kind() == type_data::tk_array) {
 				type_data* nextElemType = __cast_array(machine, rootType, &nv, setType);
@@ -441,7 +441,7 @@ namespace gstd {
 		if (elemType == nullptr) elemType = setType;
 		type_data* arrayType = typeManager->get_array_type(elemType);
 
-		val->set(arrayType, arrVal);
+		val->reset(arrayType, arrVal);
 		return arrayType;
 	}
 	value BaseFunction::_cast_array(script_machine* machine, const value* argv, type_data::type_kind target) {
@@ -457,7 +457,6 @@ namespace gstd {
 			type_data* rootType = typeManager->get_type(target);
 
 			value res = *argv;
-			res.make_unique();
 
 			__cast_array(machine, rootType, &res, rootType);
 
@@ -606,7 +605,8 @@ namespace gstd {
 			std::vector<value> resArr;
 			resArr.resize(argv->length_as_array());
 			for (size_t i = 0; i < argv->length_as_array(); ++i) {
-				resArr[i] = _script_negative(1, &(*argv)[i]);
+				value elem = argv->index_as_array_copy(i);
+				resArr[i] = _script_negative(1, &elem);
 			}
 			result.reset(argv->get_type(), resArr);
 			return result;
@@ -680,11 +680,15 @@ namespace gstd {
 						r = sl < sr ? -1 : 1;
 						break;
 					}
+					else if (argv[0].is_packed_string() && argv[1].is_packed_string()) {
+						int cmp = argv[0].as_string_view().compare(argv[1].as_string_view());
+						r = (cmp == 0) ? 0 : (cmp < 0) ? -1 : 1;
+					}
 					else {
 						value v[2];
 						for (size_t i = 0; i < sr; ++i) {
-							v[0] = argv[0][i];
-							v[1] = argv[1][i];
+							v[0] = argv[0].index_as_array_copy(i);
+							v[1] = argv[1].index_as_array_copy(i);
 							r = _script_compare(2, v).as_float();
 							if (r != 0)
 								break;
@@ -740,7 +744,8 @@ namespace gstd {
 			std::vector<value> resArr;
 			resArr.resize(argv->length_as_array());
 			for (size_t i = 0; i < argv->length_as_array(); ++i) {
-				resArr[i] = predecessor(machine, 1, &(*argv)[i]);
+				value elem = argv->index_as_array_copy(i);
+				resArr[i] = predecessor(machine, 1, &elem);
 			}
 			result.reset(argv->get_type(), resArr);
 			return result;
@@ -770,7 +775,8 @@ namespace gstd {
 			std::vector<value> resArr;
 			resArr.resize(argv->length_as_array());
 			for (size_t i = 0; i < argv->length_as_array(); ++i) {
-				resArr[i] = successor(machine, 1, &(*argv)[i]);
+				value elem = argv->index_as_array_copy(i);
+				resArr[i] = successor(machine, 1, &elem);
 			}
 			result.reset(argv->get_type(), resArr);
 			return result;
@@ -808,7 +814,7 @@ namespace gstd {
 			std::vector<value> arrVal(newSize);
 
 			for (size_t i = 0; i < oldSize && i < newSize; ++i)
-				arrVal[i] = (*val)[i];
+				arrVal[i] = val->index_as_array_copy(i);
 			if (newSize > oldSize) {
 				value fill;
 				if (argc == 3) {	//Has fill value
@@ -836,7 +842,6 @@ namespace gstd {
 		else {
 			res = *val;
 		}
-		res.make_unique();
 		return res;
 	}
 
@@ -856,7 +861,7 @@ namespace gstd {
 
 		bool res = false;
 		for (size_t i = 0; i < length; ++i) {
-			value args[2] = { (*arr)[i], val };
+			value args[2] = { arr->index_as_array_copy(i), val };
 			if (compare(machine, 2, args).as_int() == 0) {
 				res = true;
 				break;
@@ -899,7 +904,6 @@ namespace gstd {
 
 		value res;
 		res.reset(valType, arrVal);
-		res.make_unique();
 		return res;
 	}
 
@@ -921,7 +925,7 @@ namespace gstd {
 
 		// Populate source array
 		for (size_t i = 0; i < size; ++i)
-			arrVal[i] = (*val)[i];
+			arrVal[i] = val->index_as_array_copy(i);
 
 		for (size_t i = 0; i < size; ++i) {
 			for (size_t j = 1; j <= count; ++j) {
@@ -937,7 +941,6 @@ namespace gstd {
 
 		value res;
 		res.reset(valType, arrVal);
-		res.make_unique();
 		return res;
 	}
 
@@ -951,7 +954,32 @@ namespace gstd {
 		if (!_index_check(machine, arr->get_type(), length, index))
 			return nullptr;
 
-		return &(*arr)[index];
+		return &arr->index_as_array(index);
+	}
+	value BaseFunction::index_copy(script_machine* machine, int argc, const value* arr, const value* indexer) {
+		_null_check(machine, arr, 1);
+
+		int index = indexer->as_int();
+		size_t length = arr->length_as_array();
+
+		if (index < 0) index += length;
+		if (!_index_check(machine, arr->get_type(), length, index))
+			return value();
+
+		return arr->index_as_array_copy(index);
+	}
+	bool BaseFunction::index_assign(script_machine* machine, value* arr, const value* indexer, const value* x) {
+		_null_check(machine, arr, 1);
+
+		int index = indexer->as_int();
+		size_t length = arr->length_as_array();
+
+		if (index < 0) index += length;
+		if (!_index_check(machine, arr->get_type(), length, index))
+			return false;
+
+		arr->index_assign(index, *x);
+		return true;
 	}
 
 	value BaseFunction::slice(script_machine* machine, int argc, const value* argv) {
@@ -985,8 +1013,7 @@ namespace gstd {
 
 				resArr.resize(index_2 - index_1);
 				for (size_t i = 0, j = index_1; i < resArr.size(); ++i, ++j) {
-					const value& v = argv[0][j];
-					resArr[i] = v;
+					resArr[i] = argv[0].index_as_array_copy(j);
 				}
 			}
 			else if (index_1 > index_2) {		//Reverse
@@ -995,14 +1022,12 @@ namespace gstd {
 
 				resArr.resize(index_1 - index_2);
 				for (size_t i = 0, j = index_1 - 1; i < resArr.size(); ++i, --j) {
-					const value& v = argv[0][j];
-					resArr[i] = v;
+					resArr[i] = argv[0].index_as_array_copy(j);
 				}
 			}
 		}
 
 		result.reset(argv[0].get_type(), resArr);
-		result.make_unique();
 		return result;
 	}
 	value BaseFunction::insert(script_machine* machine, int argc, const value* argv) {
@@ -1032,7 +1057,6 @@ namespace gstd {
 
 		value insertVal = argv[2];
 		type_data* insertType = insertVal.get_type();
-		insertVal.make_unique();
 
 		if (_is_empty_type(arrType)) {
 			arrType = script_type_manager::get_instance()->get_array_type(arrType);
@@ -1054,17 +1078,16 @@ namespace gstd {
 		{
 			size_t iArr = 0;
 			for (size_t i = 0; i < insertPos; ++i) {
-				resArr[iArr++] = argv[0][i];
+				resArr[iArr++] = argv[0].index_as_array_copy(i);
 			}
 			resArr[iArr++] = insertVal;
 			for (size_t i = insertPos; i < length; ++i) {
-				resArr[iArr++] = argv[0][i];
+				resArr[iArr++] = argv[0].index_as_array_copy(i);
 			}
 		}
 
 		value result;
 		result.reset(arrType, resArr);
-		result.make_unique();
 		_value_cast(&result, arrType);
 		return result;
 	}
@@ -1093,16 +1116,15 @@ namespace gstd {
 		{
 			size_t iArr = 0;
 			for (size_t i = 0; i < index_1; ++i) {
-				resArr[iArr++] = argv[0][i];
+				resArr[iArr++] = argv[0].index_as_array_copy(i);
 			}
 			for (size_t i = index_1 + 1; i < length; ++i) {
-				resArr[iArr++] = argv[0][i];
+				resArr[iArr++] = argv[0].index_as_array_copy(i);
 			}
 		}
 
 		value result;
 		result.reset(argv[0].get_type(), resArr);
-		result.make_unique();
 		return result;
 	}
 
@@ -1113,7 +1135,6 @@ namespace gstd {
 		type_data* type_appending = argv[1].get_type();
 
 		value result = argv[0];
-		result.make_unique();
 
 		_append_check(machine, type_array, type_appending);
 		type_data* type_target = type_array->get_element() == nullptr ?
@@ -1152,11 +1173,9 @@ namespace gstd {
 		_null_check(machine, argv, argc);
 		if (__chk_concat(machine, argv[0].get_type(), argv[1].get_type())) {
 			value result = argv[0];
-			result.make_unique();
 
 			value concat = argv[1];
 			if (concat.get_type() != result.get_type()) {
-				concat.make_unique();
 				BaseFunction::_value_cast(&concat, result.get_type());
 			}
 			result.concatenate(concat);
@@ -1165,21 +1184,20 @@ namespace gstd {
 		}
 		else return value();
 	}
-	value BaseFunction::concatenate_direct(script_machine* machine, int argc, const value* argv) {
-		_null_check(machine, argv, argc);
-		if (__chk_concat(machine, argv[0].get_type(), argv[1].get_type())) {
-			value result = argv[0];
-
-			value concat = argv[1];
-			if (concat.get_type() != result.get_type()) {
-				concat.make_unique();
-				BaseFunction::_value_cast(&concat, result.get_type());
+	//Concatenates onto dest in place, which only copies its array when it is shared
+	bool BaseFunction::concatenate_direct(script_machine* machine, value* dest, const value* x) {
+		if (!_null_check(machine, dest, 1) || !_null_check(machine, x, 1))
+			return false;
+		if (__chk_concat(machine, dest->get_type(), x->get_type())) {
+			value concat = *x;
+			if (concat.get_type() != dest->get_type()) {
+				BaseFunction::_value_cast(&concat, dest->get_type());
 			}
-			result.concatenate(concat);
+			dest->concatenate(concat);
 
-			return result;
+			return true;
 		}
-		else return value();
+		else return false;
 	}
 
 	value BaseFunction::round(script_machine* machine, int argc, const value* argv) {
@@ -1269,4 +1287,9 @@ namespace gstd {
 			DebugBreak();
 		return value();
 	}
+	value BaseFunction::script_isPacked(script_machine* machine, int argc, const value* argv) {
+		//For checking the engine's own array storage from test scripts
+		bool res = argv[0].is_packed_array() || argv[0].is_packed_string();
+		return value(script_type_manager::get_boolean_type(), res);
+	}
 }
\ No newline at end of file
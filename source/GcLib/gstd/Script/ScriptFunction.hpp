@@ -113,6 +113,9 @@ namespace gstd {
 		DNH_FUNCAPI_DECL_(successor);
 
 		static const value* index(script_machine* machine, int argc, value* arr, value* indexer);
+		static value index_copy(script_machine* machine, int argc, const value* arr, const value* indexer);
+		//Same checks as index, packed arrays take elements of their own type without expanding
+		static bool index_assign(script_machine* machine, value* arr, const value* indexer, const value* x);
 
 		DNH_FUNCAPI_DECL_(length);
 		DNH_FUNCAPI_DECL_(resize);
@@ -125,7 +128,7 @@ namespace gstd {
 		DNH_FUNCAPI_DECL_(erase);
 		DNH_FUNCAPI_DECL_(append);
 		DNH_FUNCAPI_DECL_(concatenate);
-		DNH_FUNCAPI_DECL_(concatenate_direct);
+		static bool concatenate_direct(script_machine* machine, value* dest, const value* x);
 
 		DNH_FUNCAPI_DECL_(round);
 		DNH_FUNCAPI_DECL_(truncate);
@@ -147,5 +150,6 @@ namespace gstd {
 
 		DNH_FUNCAPI_DECL_(assert_);
 		DNH_FUNCAPI_DECL_(script_debugBreak);
+		DNH_FUNCAPI_DECL_(script_isPacked);
 	};
 }
\ No newline at end of file
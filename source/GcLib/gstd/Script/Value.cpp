@@ -60,10 +60,7 @@ value::value(type_data* t, value* v) {
 	this->set(t, v);
 }
 value::value(type_data* t, const std::wstring& v) {
-	std::vector<value> vec(v.size());
-	for (size_t i = 0; i < v.size(); ++i)
-		vec[i] = value(t->get_element(), v[i]);
-	this->set(t, vec);
+	this->set(t, v);
 }
 value::~value() {
 	this->release();
@@ -73,6 +70,12 @@ void value::release() {
 	if (!has_data()) return;
 	if (kind == type_data::tk_array)
 		p_array_value.~ref_count_ptr();
+	else if (kind == type_data::tk_string && !string_inline)
+		p_string_value.~ref_count_ptr();
+	else if (kind == type_data::tk_packed_int || kind == type_data::tk_packed_boolean)
+		p_int_array_value.~ref_count_ptr();
+	else if (kind == type_data::tk_packed_float)
+		p_float_array_value.~ref_count_ptr();
 }
 
 value* value::reset(type_data* t, int64_t v) {
@@ -99,6 +102,18 @@ value* value::reset(type_data* t, std::vector<value>& v) {
 	release();
 	return this->set(t, v);
 }
+value* value::reset(type_data* t, const std::wstring& v) {
+	release();
+	return this->set(t, v);
+}
+value* value::reset(type_data* t, std::vector<int64_t> v) {
+	release();
+	return this->set(t, MOVE(v));
+}
+value* value::reset(type_data* t, std::vector<double> v) {
+	release();
+	return this->set(t, MOVE(v));
+}
 
 #pragma push_macro("new")
 #undef new
@@ -133,6 +148,39 @@ value* value::set(type_data* t, value* v) {
 	return this;
 }
 value* value::set(type_data* t, std::vector<value>& v) {
+	//Char arrays built element by element are packed back into a string
+	if (_is_string_type(t)) {
+		auto itrNonChar = std::find_if(v.begin(), v.end(),
+			[](const value& x) { return !x.has_data() || x.kind != type_data::tk_char; });
+		if (itrNonChar == v.end()) {
+			std::wstring str(v.size(), L'\0');
+			for (size_t i = 0; i < v.size(); ++i)
+				str[i] = v[i].char_value;
+			_set_string(t, str);
+			return this;
+		}
+	}
+	//Likewise numeric arrays are packed when every element has the element type
+	else if (type_data::type_kind kindPacked = _packed_kind(t)) {
+		type_data* elem = t->get_element();
+		auto itrOther = std::find_if(v.begin(), v.end(),
+			[&](const value& x) { return x.type != elem || x.kind != elem->get_kind(); });
+		if (itrOther == v.end()) {
+			if (kindPacked == type_data::tk_packed_float) {
+				std::vector<double> arr(v.size());
+				for (size_t i = 0; i < v.size(); ++i)
+					arr[i] = v[i].float_value;
+				return this->set(t, MOVE(arr));
+			}
+			else {
+				std::vector<int64_t> arr(v.size());
+				for (size_t i = 0; i < v.size(); ++i)
+					arr[i] = kindPacked == type_data::tk_packed_int ? v[i].int_value : (int64_t)v[i].boolean_value;
+				return this->set(t, MOVE(arr));
+			}
+		}
+	}
+
 	kind = type_data::tk_array;
 	type = t;
 	ref_unsync_ptr<std::vector<value>> nv(new std::vector<value>(v));
@@ -145,11 +193,201 @@ value* value::set(type_data* t, ref_unsync_ptr<std::vector<value>> v) {
 	new (&p_array_value) auto(v);
 	return this;
 }
+value* value::set(type_data* t, const std::wstring& v) {
+	if (_is_string_type(t)) {
+		_set_string(t, v);
+		return this;
+	}
+
+	std::vector<value> vec(v.size());
+	for (size_t i = 0; i < v.size(); ++i)
+		vec[i] = value(t->get_element(), v[i]);
+	return this->set(t, vec);
+}
+value* value::set(type_data* t, std::vector<int64_t> v) {
+	kind = _packed_kind(t) == type_data::tk_packed_boolean ?
+		type_data::tk_packed_boolean : type_data::tk_packed_int;
+	type = t;
+	ref_unsync_ptr<std::vector<int64_t>> nv(new std::vector<int64_t>(MOVE(v)));
+	new (&p_int_array_value) auto(nv);
+	return this;
+}
+value* value::set(type_data* t, std::vector<double> v) {
+	kind = type_data::tk_packed_float;
+	type = t;
+	ref_unsync_ptr<std::vector<double>> nv(new std::vector<double>(MOVE(v)));
+	new (&p_float_array_value) auto(nv);
+	return this;
+}
 value* value::set(type_data* t) {
+	if (is_packed_string()) {
+		if (_is_string_type(t)) {
+			type = t;
+			return this;
+		}
+		_unpack_string();
+	}
+	else if (is_packed_array()) {
+		if (_packed_kind(t) == kind) {
+			type = t;
+			return this;
+		}
+		_unpack_array();
+	}
+
 	kind = t ? t->get_kind() : type_data::tk_null;
 	type = t;
 	return this;
 }
+
+bool value::_is_string_type(type_data* t) {
+	if (t == nullptr || t->get_kind() != type_data::tk_array) return false;
+	type_data* elem = t->get_element();
+	return elem != nullptr && elem->get_kind() == type_data::tk_char;
+}
+type_data::type_kind value::_packed_kind(type_data* t) {
+	if (t == nullptr || t->get_kind() != type_data::tk_array) return type_data::tk_null;
+	type_data* elem = t->get_element();
+	if (elem == nullptr) return type_data::tk_null;
+	switch (elem->get_kind()) {
+	case type_data::tk_int:
+		return type_data::tk_packed_int;
+	case type_data::tk_float:
+		return type_data::tk_packed_float;
+	case type_data::tk_boolean:
+		return type_data::tk_packed_boolean;
+	}
+	return type_data::tk_null;
+}
+
+std::wstring_view value::_string_view() const {
+	if (!is_packed_string()) return std::wstring_view();
+	if (string_inline)
+		return std::wstring_view(inline_string_value.data, inline_string_value.length);
+	return std::wstring_view(*p_string_value);
+}
+void value::_set_string(type_data* t, std::wstring_view v) {
+	kind = type_data::tk_string;
+	type = t;
+	string_atom = 0;
+	if (v.size() <= STRING_INLINE_CAPACITY) {
+		string_inline = true;
+		std::copy(v.begin(), v.end(), inline_string_value.data);
+		inline_string_value.length = (uint16_t)v.size();
+	}
+	else {
+		string_inline = false;
+		ref_unsync_ptr<std::wstring> ns(new std::wstring(v));
+		new (&p_string_value) auto(ns);
+	}
+}
+//Appends in place, callers unshare a heap string with make_unique first
+void value::_string_append(std::wstring_view v) {
+	string_atom = 0;
+	if (string_inline) {
+		size_t len = inline_string_value.length;
+		if (len + v.size() <= STRING_INLINE_CAPACITY) {
+			std::copy(v.begin(), v.end(), inline_string_value.data + len);
+			inline_string_value.length = (uint16_t)(len + v.size());
+			return;
+		}
+
+		ref_unsync_ptr<std::wstring> ns(new std::wstring());
+		ns->reserve(len + v.size());
+		ns->append(inline_string_value.data, len);
+		ns->append(v);
+
+		string_inline = false;
+		new (&p_string_value) auto(ns);
+	}
+	else {
+		p_string_value->append(v);
+	}
+}
+void value::_copy_string(const value& source) {
+	kind = type_data::tk_string;
+	type = source.type;
+	string_inline = source.string_inline;
+	string_atom = source.string_atom;
+	if (string_inline)
+		inline_string_value = source.inline_string_value;
+	else
+		new (&p_string_value) auto(source.p_string_value);
+}
+//Expands the packed string into a char array, for when elements need to be referenced
+void value::_unpack_string() {
+	type_data* elem = type->get_element();
+
+	ref_unsync_ptr<std::vector<value>> arr;
+	{
+		std::wstring_view str = _string_view();
+		arr = ref_unsync_ptr<std::vector<value>>(new std::vector<value>(str.size()));
+		for (size_t i = 0; i < str.size(); ++i)
+			(*arr)[i].set(elem, str[i]);
+	}
+
+	type_data* t = type;
+	release();
+	this->set(t, arr);
+}
+
+size_t value::_packed_size() const {
+	if (kind == type_data::tk_packed_float)
+		return p_float_array_value->size();
+	return p_int_array_value->size();
+}
+value value::_packed_element(size_t i) const {
+	type_data* elem = type->get_element();
+	if (kind == type_data::tk_packed_float)
+		return value(elem, p_float_array_value->at(i));
+	else if (kind == type_data::tk_packed_int)
+		return value(elem, p_int_array_value->at(i));
+	return value(elem, p_int_array_value->at(i) != 0);
+}
+//Fails if x does not have the element type, callers unshare the array with make_unique first
+bool value::_packed_push(const value& x) {
+	if (x.type != type->get_element() || (type_data::type_kind)(x.kind | 0x80) != kind)
+		return false;
+	if (kind == type_data::tk_packed_float)
+		p_float_array_value->push_back(x.float_value);
+	else if (kind == type_data::tk_packed_int)
+		p_int_array_value->push_back(x.int_value);
+	else
+		p_int_array_value->push_back((int64_t)x.boolean_value);
+	return true;
+}
+//Same requirements as _packed_push
+bool value::_packed_set(size_t i, const value& x) {
+	if (x.type != type->get_element() || (type_data::type_kind)(x.kind | 0x80) != kind)
+		return false;
+	if (kind == type_data::tk_packed_float)
+		p_float_array_value->at(i) = x.float_value;
+	else if (kind == type_data::tk_packed_int)
+		p_int_array_value->at(i) = x.int_value;
+	else
+		p_int_array_value->at(i) = (int64_t)x.boolean_value;
+	return true;
+}
+void value::_copy_packed(const value& source) {
+	kind = source.kind;
+	type = source.type;
+	if (kind == type_data::tk_packed_float)
+		new (&p_float_array_value) auto(source.p_float_array_value);
+	else
+		new (&p_int_array_value) auto(source.p_int_array_value);
+}
+//Boxes the packed elements, for when elements need to be referenced or the array becomes mixed
+void value::_unpack_array() {
+	size_t count = _packed_size();
+
+	ref_unsync_ptr<std::vector<value>> arr(new std::vector<value>(count));
+	for (size_t i = 0; i < count; ++i)
+		(*arr)[i] = _packed_element(i);
+
+	type_data* t = type;
+	release();
+	this->set(t, arr);
+}
 #pragma pop_macro("new")
 
 value& value::operator=(const value& source) {
@@ -171,59 +409,190 @@ value& value::operator=(const value& source) {
 			this->set(source.type, source.ptr_value);
 		else if (kind == type_data::tk_array)
 			this->set(source.type, source.p_array_value);
+		else if (kind == type_data::tk_string)
+			this->_copy_string(source);
+		else if (source.is_packed_array())
+			this->_copy_packed(source);
 	}
 
 	return *this;
 }
 
+//Copy-on-write: only this level is copied, the elements keep sharing their own storage
+//	until something writes through them, see script_machine's pc_inline_index_array
 void value::make_unique() {
-	if (has_data() && kind == type_data::tk_array) {
+	if (!has_data()) return;
+	if (kind == type_data::tk_array) {
 		if (p_array_value.use_count() == 1) return;
-		std::vector<value> vec = *p_array_value.get();
-		for (value& v : vec)
-			v.make_unique();
-		this->reset(type, vec);
+		p_array_value = ref_unsync_ptr<std::vector<value>>(new std::vector<value>(*p_array_value));
+	}
+	else if (kind == type_data::tk_string && !string_inline) {
+		if (p_string_value.use_count() == 1) return;
+		std::wstring str = *p_string_value;
+		this->reset(type, str);
+	}
+	else if (kind == type_data::tk_packed_float) {
+		if (p_float_array_value.use_count() == 1) return;
+		p_float_array_value = ref_unsync_ptr<std::vector<double>>(new std::vector<double>(*p_float_array_value));
+	}
+	else if (kind == type_data::tk_packed_int || kind == type_data::tk_packed_boolean) {
+		if (p_int_array_value.use_count() == 1) return;
+		p_int_array_value = ref_unsync_ptr<std::vector<int64_t>>(new std::vector<int64_t>(*p_int_array_value));
 	}
 }
 
 void value::append(type_data* t, const value& x) {
-	if (!has_data() || kind != type_data::tk_array)
-		this->reset(t, std::vector<value>());
-	//make_unique();
+	make_unique();
+
+	if (is_packed_string()) {
+		if (_is_string_type(t) && x.has_data() && x.kind == type_data::tk_char) {
+			type = t;
+			_string_append(std::wstring_view(&x.char_value, 1));
+			return;
+		}
+		_unpack_string();
+	}
+	else if (is_packed_array()) {
+		if (_packed_kind(t) == kind) {
+			type = t;
+			if (_packed_push(x)) return;
+		}
+		_unpack_array();
+	}
+	else if (!has_data() || kind != type_data::tk_array || p_array_value->empty()) {
+		release();
+		if (type_data::type_kind kindPacked = _packed_kind(t)) {
+			if (kindPacked == type_data::tk_packed_float)
+				this->set(t, std::vector<double>());
+			else
+				this->set(t, std::vector<int64_t>());
+			if (_packed_push(x)) return;
+			_unpack_array();
+		}
+		else this->set(t, ref_unsync_ptr<std::vector<value>>(new std::vector<value>()));
+	}
 	type = t;
 	p_array_value->push_back(x);
 }
 void value::concatenate(const value& x) {
-	if (!has_data() || kind != type_data::tk_array)
+	if (!has_data() || (kind != type_data::tk_array && kind != type_data::tk_string && !is_packed_array()))
 		this->reset(x.type, std::vector<value>());
-	//make_unique();
+	make_unique();
 	if (type->get_element() == nullptr)
 		type = x.type;
-	p_array_value->insert(array_get_end(),
-		x.array_get_begin(), x.array_get_end());
+
+	if (is_packed_string()) {
+		if (x.is_packed_string()) {
+			std::wstring_view str = x._string_view();
+			if (str.data() == _string_view().data()) {
+				std::wstring self(str);		//Concatenating a string to itself
+				_string_append(self);
+			}
+			else _string_append(str);
+			return;
+		}
+		else if (x.length_as_array() == 0) {
+			return;
+		}
+		_unpack_string();
+	}
+	else if (is_packed_array()) {
+		if (x.kind == kind && x.type == type) {
+			//Anything else sharing the storage was unshared by make_unique, but x may be this value itself
+			if (kind == type_data::tk_packed_float) {
+				std::vector<double>& arr = *p_float_array_value;
+				size_t count = x.p_float_array_value->size();
+				arr.reserve(arr.size() + count);
+				for (size_t i = 0; i < count; ++i)
+					arr.push_back((*x.p_float_array_value)[i]);
+			}
+			else {
+				std::vector<int64_t>& arr = *p_int_array_value;
+				size_t count = x.p_int_array_value->size();
+				arr.reserve(arr.size() + count);
+				for (size_t i = 0; i < count; ++i)
+					arr.push_back((*x.p_int_array_value)[i]);
+			}
+			return;
+		}
+		else if (x.length_as_array() == 0) {
+			return;
+		}
+		_unpack_array();
+	}
+	else if (p_array_value->empty() && x.is_packed_array() && _packed_kind(type) == x.kind) {
+		//Nothing to keep from this array, share x's storage instead
+		type_data* t = type;
+		*this = x;
+		type = t;
+		return;
+	}
+
+	if (x.is_packed_string() || x.is_packed_array()) {
+		size_t count = x.length_as_array();
+
+		std::vector<value>& arr = *p_array_value;
+		arr.reserve(arr.size() + count);
+		for (size_t i = 0; i < count; ++i)
+			arr.push_back(x.index_as_array_copy(i));
+	}
+	else if (x.length_as_array() > 0) {
+		//x is an expanded array here, read its storage directly
+		p_array_value->insert(p_array_value->end(),
+			x.p_array_value->begin(), x.p_array_value->end());
+	}
 }
 
 size_t value::length_as_array() const {
-	if (has_data() && kind == type_data::tk_array)
-		return p_array_value->size();
+	if (has_data()) {
+		if (kind == type_data::tk_array)
+			return p_array_value->size();
+		else if (kind == type_data::tk_string)
+			return _string_view().size();
+		else if (is_packed_array())
+			return _packed_size();
+	}
 	return 0U;
 }
-const value& value::index_as_array(size_t i) const {
+value& value::index_as_array(size_t i) {
+	if (is_packed_string())
+		_unpack_string();
+	else if (is_packed_array())
+		_unpack_array();
 	if (has_data() && kind == type_data::tk_array)
 		return p_array_value->at(i);
 	throw wexception("index_as_array: not an array");
 }
-value& value::index_as_array(size_t i) {
+//Does not expand packed strings or arrays
+value value::index_as_array_copy(size_t i) const {
+	if (is_packed_string())
+		return value(type->get_element(), _string_view().at(i));
+	if (is_packed_array())
+		return _packed_element(i);
 	if (has_data() && kind == type_data::tk_array)
 		return p_array_value->at(i);
 	throw wexception("index_as_array: not an array");
 }
-std::vector<value>::iterator value::array_get_begin() const {
+void value::index_assign(size_t i, const value& x) {
+	make_unique();
+	if (is_packed_array() && _packed_set(i, x))
+		return;
+	index_as_array(i) = x;
+}
+std::vector<value>::iterator value::array_get_begin() {
+	if (is_packed_string())
+		_unpack_string();
+	else if (is_packed_array())
+		_unpack_array();
 	if (has_data() && kind == type_data::tk_array)
 		return p_array_value->begin();
 	return std::vector<value>::iterator();
 }
-std::vector<value>::iterator value::array_get_end() const {
+std::vector<value>::iterator value::array_get_end() {
+	if (is_packed_string())
+		_unpack_string();
+	else if (is_packed_array())
+		_unpack_array();
 	if (has_data() && kind == type_data::tk_array)
 		return p_array_value->end();
 	return std::vector<value>::iterator();
@@ -243,6 +612,14 @@ int64_t value::as_int() const {
 		return (int64_t)boolean_value;
 	if (kind == type_data::tk_pointer)
 		return (uint32_t)ptr_value;
+	if (kind == type_data::tk_string) {
+		try {
+			return std::stoll(as_string());
+		}
+		catch (...) {
+			return 0i64;
+		}
+	}
 	if (kind == type_data::tk_array) {
 		if (type->get_element()->get_kind() == type_data::tk_char) {
 			try {
@@ -254,6 +631,8 @@ int64_t value::as_int() const {
 		}
 		else return length_as_array();
 	}
+	if (is_packed_array())
+		return length_as_array();
 	return 0i64;
 }
 double value::as_float() const {
@@ -268,6 +647,14 @@ double value::as_float() const {
 		return (double)boolean_value;
 	if (kind == type_data::tk_pointer)
 		return (uint32_t)ptr_value;
+	if (kind == type_data::tk_string) {
+		try {
+			return std::stod(as_string());
+		}
+		catch (...) {
+			return 0.0;
+		}
+	}
 	if (kind == type_data::tk_array) {
 		if (type->get_element()->get_kind() == type_data::tk_char) {
 			try {
@@ -279,6 +666,8 @@ double value::as_float() const {
 		}
 		else return length_as_array();
 	}
+	if (is_packed_array())
+		return length_as_array();
 	return 0.0;
 }
 wchar_t value::as_char() const {
@@ -293,7 +682,7 @@ wchar_t value::as_char() const {
 		return boolean_value ? L'1' : L'0';
 	if (kind == type_data::tk_pointer)
 		return (wchar_t)(ptr_value != nullptr);
-	if (kind == type_data::tk_array)
+	if (kind == type_data::tk_array || kind == type_data::tk_string)
 		return L'\0';
 	return L'\0';
 }
@@ -311,6 +700,10 @@ bool value::as_boolean() const {
 		return (ptr_value != nullptr);
 	if (kind == type_data::tk_array)
 		return (p_array_value->size() != 0U);
+	if (kind == type_data::tk_string)
+		return (_string_view().size() != 0U);
+	if (is_packed_array())
+		return (_packed_size() != 0U);
 	return false;
 }
 std::wstring value::as_string() const {
@@ -325,6 +718,8 @@ std::wstring value::as_string() const {
 		return std::wstring(&char_value, 1);
 	if (kind == type_data::tk_pointer)
 		return StringUtility::Format(L"%08x", (uint32_t)ptr_value);
+	if (kind == type_data::tk_string)
+		return std::wstring(_string_view());
 	if (kind == type_data::tk_array) {
 		std::wstring result = L"";
 		if (type_data* elem = type->get_element()) {
@@ -346,11 +741,217 @@ std::wstring value::as_string() const {
 		else result = L"[]";
 		return result;
 	}
+	if (is_packed_array()) {
+		std::wstring result = L"[";
+		for (size_t i = 0; i < _packed_size(); ++i) {
+			if (i > 0) result += L",";
+			result += _packed_element(i).as_string();
+		}
+		result += L"]";
+		return result;
+	}
 	return L"(INVALID-TYPE)";
 }
 ref_unsync_ptr<std::vector<value>> value::as_array_ptr() const {
 	if (!has_data()) return nullptr;
 	if (kind == type_data::tk_array)
 		return p_array_value;
+	if (kind == type_data::tk_string) {
+		//Not shared with this value, packed strings stay packed
+		std::wstring_view str = _string_view();
+		type_data* elem = type->get_element();
+
+		ref_unsync_ptr<std::vector<value>> res(new std::vector<value>(str.size()));
+		for (size_t i = 0; i < str.size(); ++i)
+			(*res)[i].set(elem, str[i]);
+		return res;
+	}
+	if (is_packed_array()) {
+		//Likewise not shared
+		size_t count = _packed_size();
+		ref_unsync_ptr<std::vector<value>> res(new std::vector<value>(count));
+		for (size_t i = 0; i < count; ++i)
+			(*res)[i] = _packed_element(i);
+		return res;
+	}
 	return nullptr;
+}
+
+//*******************************************************************
+//script_atom_table
+//*******************************************************************
+script_atom_table::atom script_atom_table::find(std::wstring_view str) const {
+	std::shared_lock lock(mutex);
+	auto itr = map_atom.find(str);
+	return itr != map_atom.end() ? itr->second : ATOM_NONE;
+}
+script_atom_table::atom script_atom_table::intern(std::wstring_view str) {
+	if (atom res = find(str))
+		return res;
+
+	std::unique_lock lock(mutex);
+	auto itr = map_atom.find(str);
+	if (itr != map_atom.end())
+		return itr->second;
+
+	list_string.emplace_back(str);
+	atom res = (atom)list_string.size();
+	map_atom.insert(std::make_pair(std::wstring_view(list_string.back()), res));
+	return res;
+}
+
+script_atom_table::atom script_atom_table::find(const value& v) const {
+	if (atom res = v.get_string_atom())
+		return res;
+	if (v.is_packed_string())
+		return find(v.as_string_view());
+	return find(v.as_string());
+}
+
+void script_atom_table::intern_literal(value& v) {
+	if (!v.is_packed_string() || v.get_string_atom() != 0) return;
+
+	std::wstring_view str = v.as_string_view();
+	if (str.size() > MAX_LITERAL_LENGTH) return;
+
+	//IDs past what the value can cache still work, just through the hashed lookup
+	atom res = intern(str);
+	if (res <= UINT16_MAX)
+		v.set_string_atom((uint16_t)res);
+}
+
+std::wstring script_atom_table::get_string(atom id) const {
+	std::shared_lock lock(mutex);
+	if (id == ATOM_NONE || id > list_string.size())
+		return std::wstring();
+	return list_string[id - 1];
+}
+size_t script_atom_table::size() const {
+	std::shared_lock lock(mutex);
+	return list_string.size();
+}
+
+//*******************************************************************
+//script_value_table
+//*******************************************************************
+static std::wstring_view _key_string(const value& key, std::wstring& buffer) {
+	if (key.is_packed_string())
+		return key.as_string_view();
+	buffer = key.as_string();
+	return buffer;
+}
+
+//A key can only sit in the string map if it wasn't interned when it was set,
+//	so both maps are checked, and the table is only consulted when the atom map has entries
+value* script_value_table::find(const value& key) {
+	std::wstring buffer;
+	atom id = key.get_string_atom();
+	if (id == script_atom_table::ATOM_NONE) {
+		if (!map_string.empty()) {
+			auto itr = map_string.find(_key_string(key, buffer));
+			if (itr != map_string.end())
+				return &itr->second;
+		}
+		if (map_atom.empty())
+			return nullptr;
+		id = script_atom_table::get_instance()->find(key);
+		if (id == script_atom_table::ATOM_NONE)
+			return nullptr;
+	}
+
+	auto itr = map_atom.find(id);
+	if (itr != map_atom.end())
+		return &itr->second;
+
+	if (!map_string.empty()) {
+		auto itrStr = map_string.find(_key_string(key, buffer));
+		if (itrStr != map_string.end())
+			return &itrStr->second;
+	}
+	return nullptr;
+}
+value& script_value_table::operator[](const value& key) {
+	std::wstring buffer;
+	atom id = key.get_string_atom();
+	if (id == script_atom_table::ATOM_NONE && !map_atom.empty())
+		id = script_atom_table::get_instance()->find(key);
+
+	if (id == script_atom_table::ATOM_NONE) {
+		std::wstring_view str = _key_string(key, buffer);
+		auto itr = map_string.find(str);
+		if (itr == map_string.end())
+			itr = map_string.emplace(std::wstring(str), value()).first;
+		return itr->second;
+	}
+
+	//Moves the entry over if it was set before its string got interned
+	if (!map_string.empty()) {
+		auto itrStr = map_string.find(_key_string(key, buffer));
+		if (itrStr != map_string.end()) {
+			value& res = map_atom[id];
+			res = itrStr->second;
+			map_string.erase(itrStr);
+			return res;
+		}
+	}
+	return map_atom[id];
+}
+std::pair<value*, bool> script_value_table::_emplace(atom id, std::wstring_view str) {
+	if (id == script_atom_table::ATOM_NONE) {
+		auto itr = map_string.find(str);
+		if (itr != map_string.end())
+			return std::make_pair(&itr->second, false);
+		return std::make_pair(&map_string.emplace(std::wstring(str), value()).first->second, true);
+	}
+
+	auto itr = map_atom.find(id);
+	if (itr != map_atom.end())
+		return std::make_pair(&itr->second, false);
+
+	value& res = map_atom[id];
+	if (!map_string.empty()) {
+		auto itrStr = map_string.find(str);
+		if (itrStr != map_string.end()) {
+			res = itrStr->second;
+			map_string.erase(itrStr);
+			return std::make_pair(&res, false);
+		}
+	}
+	return std::make_pair(&res, true);
+}
+void script_value_table::insert_from(const script_value_table& src, bool bOverwrite) {
+	if (&src == this) return;
+
+	script_atom_table* table = script_atom_table::get_instance();
+	for (auto& [id, v] : src.map_atom) {
+		std::wstring str;
+		if (!map_string.empty())
+			str = table->get_string(id);
+		auto [pValue, bAdded] = _emplace(id, str);
+		if (bAdded || bOverwrite)
+			*pValue = v;
+	}
+	//Strings interned since they were set in src still end up under their atom
+	for (auto& [str, v] : src.map_string) {
+		auto [pValue, bAdded] = _emplace(table->find(str), str);
+		if (bAdded || bOverwrite)
+			*pValue = v;
+	}
+}
+size_t script_value_table::erase(const value& key) {
+	std::wstring buffer;
+	size_t res = 0;
+	if (!map_string.empty()) {
+		auto itr = map_string.find(_key_string(key, buffer));
+		if (itr != map_string.end()) {
+			map_string.erase(itr);
+			++res;
+		}
+	}
+	if (!map_atom.empty()) {
+		atom id = script_atom_table::get_instance()->find(key);
+		if (id != script_atom_table::ATOM_NONE)
+			res += map_atom.erase(id);
+	}
+	return res;
 }
\ No newline at end of file
@@ -14,7 +14,12 @@ namespace gstd {
 			tk_boolean	= 0x08,
 			tk_array	= 0x10,
 			tk_pointer	= 0x20,
-			tk_string	= 0x40,	//Dummy for the parser
+			tk_string	= 0x40,	//Dummy for the parser, also the storage kind of packed strings in value
+
+			//Storage kinds of packed numeric arrays in value (0x80 | element kind), never the kind of a type_data
+			tk_packed_int		= 0x81,
+			tk_packed_float		= 0x82,
+			tk_packed_boolean	= 0x88,
 		} type_kind;
 
 		type_data(type_kind k, type_data* t = nullptr) : kind(k), element(t) {}
@@ -34,8 +39,19 @@ namespace gstd {
 	};
 
 	class value {
+	public:
+		//Strings up to this length are stored inside the value itself
+		static constexpr size_t STRING_INLINE_CAPACITY =
+			(sizeof(ref_unsync_ptr<std::wstring>) - sizeof(uint16_t)) / sizeof(wchar_t);
 	private:
+		struct inline_string_t {
+			wchar_t data[STRING_INLINE_CAPACITY];
+			uint16_t length;
+		};
+
 		type_data::type_kind kind = type_data::tk_null;
+		bool string_inline = false;		//Only meaningful when kind is tk_string
+		uint16_t string_atom = 0;		//Cached script_atom_table ID of the string, 0 if unknown
 		type_data* type = nullptr;
 
 		// TODO: Switch to std::variant
@@ -46,7 +62,34 @@ namespace gstd {
 			int64_t int_value;
 			value* ptr_value;
 			ref_unsync_ptr<std::vector<value>> p_array_value;
+
+			//Strings (char arrays) are stored packed, and only expanded into
+			//	p_array_value when one of their elements is accessed by reference
+			ref_unsync_ptr<std::wstring> p_string_value;
+			inline_string_t inline_string_value;
+
+			//Int, float and bool arrays whose elements all have the array's element type are stored packed,
+			//	and only expanded into p_array_value when an element is accessed by reference
+			//	or an element of another type is put in
+			ref_unsync_ptr<std::vector<int64_t>> p_int_array_value;		//Also bool arrays, as 0 or 1
+			ref_unsync_ptr<std::vector<double>> p_float_array_value;
 		};
+
+		static bool _is_string_type(type_data* t);
+		static type_data::type_kind _packed_kind(type_data* t);
+
+		std::wstring_view _string_view() const;
+		void _set_string(type_data* t, std::wstring_view v);
+		void _string_append(std::wstring_view v);
+		void _copy_string(const value& source);
+		void _unpack_string();
+
+		size_t _packed_size() const;
+		value _packed_element(size_t i) const;
+		bool _packed_push(const value& x);
+		bool _packed_set(size_t i, const value& x);
+		void _copy_packed(const value& source);
+		void _unpack_array();
 	public:
 		value() {}
 		value(type_data* t, int64_t v);
@@ -72,6 +115,9 @@ namespace gstd {
 		value* reset(type_data* t, bool v);
 		value* reset(type_data* t, value* v);
 		value* reset(type_data* t, std::vector<value>& v);
+		value* reset(type_data* t, const std::wstring& v);
+		value* reset(type_data* t, std::vector<int64_t> v);
+		value* reset(type_data* t, std::vector<double> v);
 		value* set(type_data* t, int64_t v);
 		value* set(type_data* t, double v);
 		value* set(type_data* t, wchar_t v);
@@ -79,10 +125,15 @@ namespace gstd {
 		value* set(type_data* t, value* v);
 		value* set(type_data* t, std::vector<value>& v);
 		value* set(type_data* t, ref_unsync_ptr<std::vector<value>> v);
+		value* set(type_data* t, const std::wstring& v);
+		value* set(type_data* t, std::vector<int64_t> v);	//t must be an int or bool array type
+		value* set(type_data* t, std::vector<double> v);	//t must be a float array type
 		value* set(type_data* t);
 
+		//Arrays and strings are shared on copy, anything that writes to one in place unshares it with this first
 		void make_unique();
 
+		//In place, both unshare first
 		void append(type_data* t, const value& x);
 		void concatenate(const value& x);
 
@@ -91,14 +142,30 @@ namespace gstd {
 		bool has_data() const { return type != nullptr; }
 		type_data* get_type() const { return type; }
 
+		bool is_packed_string() const { return has_data() && kind == type_data::tk_string; }
+		bool is_packed_array() const {
+			return has_data() && (kind == type_data::tk_packed_int
+				|| kind == type_data::tk_packed_float || kind == type_data::tk_packed_boolean);
+		}
+		std::wstring_view as_string_view() const { return _string_view(); }
+
+		uint16_t get_string_atom() const { return is_packed_string() ? string_atom : 0; }
+		void set_string_atom(uint16_t atom) { if (is_packed_string()) string_atom = atom; }
+
 		size_t length_as_array() const;
-		const value& index_as_array(size_t i) const;
+		//Expands packed strings and arrays, only for element access by reference
 		value& index_as_array(size_t i);
+		//Reads without modifying the value, use for anything reached through a const value
+		value index_as_array_copy(size_t i) const;
+		//Writes element i in place, elements of a packed array's own type are stored without expanding it.
+		//	Unshares first, like append.
+		void index_assign(size_t i, const value& x);
 
-		std::vector<value>::iterator array_get_begin() const;
-		std::vector<value>::iterator array_get_end() const;
+		//Expand packed strings and arrays, same as index_as_array
+		std::vector<value>::iterator array_get_begin();
+		std::vector<value>::iterator array_get_end();
 
-		const value& operator[](size_t i) const { return index_as_array(i); }
+		value operator[](size_t i) const { return index_as_array_copy(i); }
 
 		//--------------------------------------------------------------------------
 
@@ -112,4 +179,114 @@ namespace gstd {
 		ref_unsync_ptr<std::vector<value>> as_array_ptr() const;
 	};
 #pragma pack(pop)
+
+	//Maps the string literals of compiled scripts to small integer IDs, cached in the literal values
+	//	so key lookups made with them skip hashing entirely.
+	//	Strings built at runtime are never interned, so the table is bounded by the scripts loaded
+	//	and IDs are never released.
+	class script_atom_table {
+	public:
+		typedef uint32_t atom;
+		static constexpr atom ATOM_NONE = 0;
+
+		//Longer literals are likely text rather than keys, and are left alone
+		static constexpr size_t MAX_LITERAL_LENGTH = 64;
+	private:
+		mutable std::shared_mutex mutex;
+		std::unordered_map<std::wstring_view, atom> map_atom;
+		std::deque<std::wstring> list_string;	//Stable storage for the views in map_atom
+
+		atom intern(std::wstring_view str);
+	public:
+		static script_atom_table* get_instance() {
+			static script_atom_table table;
+			return &table;
+		}
+
+		atom find(std::wstring_view str) const;
+		//Uses the ID cached in the value when it has one
+		atom find(const value& v) const;
+
+		//Interns a string literal and caches its ID in the value, only done when a script is compiled
+		void intern_literal(value& v);
+
+		std::wstring get_string(atom id) const;
+		size_t size() const;
+	};
+
+	//Vector of key-value pairs sorted by key, for per-object tables that usually hold a handful of entries
+	template<typename K>
+	class flat_value_map {
+	public:
+		using value_type = std::pair<K, value>;
+		using iterator = typename std::vector<value_type>::iterator;
+		using const_iterator = typename std::vector<value_type>::const_iterator;
+	private:
+		std::vector<value_type> data;
+
+		iterator _lower_bound(const K& key) {
+			return std::lower_bound(data.begin(), data.end(), key,
+				[](const value_type& a, const K& b) { return a.first < b; });
+		}
+	public:
+		iterator begin() { return data.begin(); }
+		iterator end() { return data.end(); }
+		const_iterator begin() const { return data.cbegin(); }
+		const_iterator end() const { return data.cend(); }
+
+		size_t size() const { return data.size(); }
+		void clear() { data.clear(); }
+
+		bool empty() const { return data.empty(); }
+
+		iterator find(const K& key) {
+			auto itr = _lower_bound(key);
+			return (itr != data.end() && itr->first == key) ? itr : data.end();
+		}
+		value& operator[](const K& key) {
+			auto itr = _lower_bound(key);
+			if (itr == data.end() || itr->first != key)
+				itr = data.insert(itr, value_type(key, value()));
+			return itr->second;
+		}
+		std::pair<iterator, bool> insert(const value_type& v) {
+			auto itr = _lower_bound(v.first);
+			if (itr != data.end() && itr->first == v.first)
+				return std::make_pair(itr, false);
+			return std::make_pair(data.insert(itr, v), true);
+		}
+		size_t erase(const K& key) {
+			auto itr = find(key);
+			if (itr == data.end()) return 0;
+			data.erase(itr);
+			return 1;
+		}
+	};
+
+	//String-keyed value table of a script object.
+	//	Keys that are interned literals are stored by atom, anything else by string.
+	class script_value_table {
+	public:
+		typedef script_atom_table::atom atom;
+		typedef std::map<std::wstring, value, std::less<>> string_map;
+	private:
+		flat_value_map<atom> map_atom;
+		string_map map_string;
+
+		//Entry of a key given by its atom (ATOM_NONE if not interned) and string, and whether it was just added
+		std::pair<value*, bool> _emplace(atom id, std::wstring_view str);
+	public:
+		value* find(const value& key);
+		value& operator[](const value& key);
+		size_t erase(const value& key);
+
+		//Copies every entry of src, keys resolve the same way as with operator[]
+		void insert_from(const script_value_table& src, bool bOverwrite);
+
+		size_t size() const { return map_atom.size() + map_string.size(); }
+		void clear() { map_atom.clear(); map_string.clear(); }
+
+		flat_value_map<atom>& get_atom_map() { return map_atom; }
+		string_map& get_string_map() { return map_string; }
+	};
 }
\ No newline at end of file
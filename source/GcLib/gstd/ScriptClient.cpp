@@ -25,23 +25,28 @@ void ScriptEngineData::SetSource(std::vector<char>& source) {
 ScriptEngineCache::ScriptEngineCache() {
 }
 void ScriptEngineCache::Clear() {
+	Lock lock(lock_);
 	cache_.clear();
 }
 ScriptEngineData* ScriptEngineCache::AddCache(const std::wstring& name, uptr<ScriptEngineData>&& data) {
+	Lock lock(lock_);
 	auto& res = (cache_[name] = MOVE(data));
 	return res.get();
 }
 void ScriptEngineCache::RemoveCache(const std::wstring& name) {
+	Lock lock(lock_);
 	auto itrFind = cache_.find(name);
 	if (cache_.find(name) != cache_.end())
 		cache_.erase(itrFind);
 }
 ScriptEngineData* ScriptEngineCache::GetCache(const std::wstring& name) {
+	Lock lock(lock_);
 	auto itrFind = cache_.find(name);
 	if (cache_.find(name) == cache_.end()) return nullptr;
 	return itrFind->second.get();
 }
 bool ScriptEngineCache::IsExists(const std::wstring& name) {
+	Lock lock(lock_);
 	return cache_.find(name) != cache_.end();
 }
 
@@ -246,6 +251,27 @@ static const std::vector<constant> commonConstant = {
 	constant("M_1_PHI", GM_1_PHI),
 };
 
+//Functions without side effects, calls to these with constant arguments are evaluated while compiling
+static const std::vector<dnh_func_callback_t> commonPureFunction = {
+	ScriptClientBase::Func_Min, ScriptClientBase::Func_Max, ScriptClientBase::Func_Clamp,
+
+	ScriptClientBase::Func_Log, ScriptClientBase::Func_Log2, ScriptClientBase::Func_Log10,
+	ScriptClientBase::Func_LogN, ScriptClientBase::Func_ErF, ScriptClientBase::Func_Gamma,
+
+	ScriptClientBase::Func_Cos, ScriptClientBase::Func_Sin, ScriptClientBase::Func_Tan,
+	ScriptClientBase::Func_RCos, ScriptClientBase::Func_RSin, ScriptClientBase::Func_RTan,
+	ScriptClientBase::Func_Acos, ScriptClientBase::Func_Asin, ScriptClientBase::Func_Atan, ScriptClientBase::Func_Atan2,
+	ScriptClientBase::Func_RAcos, ScriptClientBase::Func_RAsin, ScriptClientBase::Func_RAtan, ScriptClientBase::Func_RAtan2,
+
+	ScriptClientBase::Func_ToDegrees, ScriptClientBase::Func_ToRadians,
+	ScriptClientBase::Func_NormalizeAngle<false>, ScriptClientBase::Func_NormalizeAngle<true>,
+	ScriptClientBase::Func_AngularDistance<false>, ScriptClientBase::Func_AngularDistance<true>,
+	ScriptClientBase::Func_ReflectAngle<false>, ScriptClientBase::Func_ReflectAngle<true>,
+
+	ScriptClientBase::Func_Exp, ScriptClientBase::Func_Sqrt, ScriptClientBase::Func_Cbrt, ScriptClientBase::Func_NRoot,
+	ScriptClientBase::Func_Hypot, ScriptClientBase::Func_Distance, ScriptClientBase::Func_DistanceSq,
+};
+
 unique_ptr<script_type_manager> ScriptClientBase::pTypeManager_ = unique_ptr<script_type_manager>(new script_type_manager());
 uint64_t ScriptClientBase::randCalls_ = 0;
 uint64_t ScriptClientBase::prandCalls_ = 0;
@@ -272,6 +298,13 @@ ScriptClientBase::ScriptClientBase() {
 
 	_AddFunction(&commonFunction);
 	_AddConstant(&commonConstant);
+	{
+		static std::once_flag flagPure;
+		std::call_once(flagPure, []() {
+			for (dnh_func_callback_t iFunc : commonPureFunction)
+				parser::register_pure_function(iFunc);
+		});
+	}
 	{
 		definedMacro_[L"_DNH_PH3SX_"] = L"";
 	}
@@ -353,13 +386,248 @@ std::vector<char> ScriptClientBase::_ParseScriptSource(std::vector<char>& source
 
 	scriptLoader.Parse();
 
+	const std::set<std::wstring>& setInclude = scriptLoader.GetIncludedPaths();
+	engineData_->SetIncludePaths(std::vector<std::wstring>(setInclude.begin(), setInclude.end()));
+
 	return scriptLoader.GetResult();
 }
 bool ScriptClientBase::_CreateEngine() {
 	unique_ptr<script_engine> engine(new script_engine(engineData_->GetSource(), &func_, &const_));
+	if (!engine->get_error() && engine->code_count_optimized != engine->code_count_parsed) {
+		Logger::WriteTop(StringUtility::Format(L"Script optimized: %s (%u -> %u codes)",
+			PathProperty::ReduceModuleDirectory(engineData_->GetPath()).c_str(),
+			engine->code_count_parsed, engine->code_count_optimized));
+	}
 	engineData_->SetEngine(std::move(engine));
 	return !engineData_->GetEngine()->get_error();
 }
+//Compiled script cache file layout:
+//	header		magic, version, build config, key
+//	includes	[path, content hash] for every file pulled in by #include
+//	payload		hash, size, then the preprocessed source, line map and serialized engine
+static constexpr char COMPILE_CACHE_MAGIC[8] = { 'D', 'N', 'H', 'S', 'C', 'P', 'T', 'C' };
+static constexpr uint32_t COMPILE_CACHE_VERSION = 3;
+#ifdef _DEBUG
+static constexpr uint8_t COMPILE_CACHE_CONFIG = 1;
+#else
+static constexpr uint8_t COMPILE_CACHE_CONFIG = 0;
+#endif
+
+static constexpr uint64_t COMPILE_CACHE_HASH_BASE = 0xcbf29ce484222325ULL;
+static uint64_t _HashCompileCache(const void* data, size_t size, uint64_t hash = COMPILE_CACHE_HASH_BASE) {
+	//FNV-1a
+	const byte* pData = (const byte*)data;
+	for (size_t i = 0; i < size; ++i) {
+		hash ^= pData[i];
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+template<typename T>
+static uint64_t _HashCompileCacheValue(const T& val, uint64_t hash) {
+	return _HashCompileCache(&val, sizeof(T), hash);
+}
+template<typename E>
+static uint64_t _HashCompileCacheString(const std::basic_string<E>& str, uint64_t hash) {
+	hash = _HashCompileCacheValue((uint32_t)str.size(), hash);
+	return _HashCompileCache(str.data(), str.size() * sizeof(E), hash);
+}
+static bool _HashCompileCacheFile(const std::wstring& path, uint64_t* res) {
+	shared_ptr<FileReader> reader = FileManager::GetBase()->GetFileReader(path);
+	if (reader == nullptr || !reader->Open()) return false;
+
+	size_t size = reader->GetFileSize();
+	std::vector<char> data(size);
+	if (size > 0 && reader->Read(&data[0], size) != size) return false;
+
+	*res = _HashCompileCache(data.data(), data.size());
+	return true;
+}
+
+//What a script is compiled against: the engine build, the function and constant tables
+//	of this client type and the compile options. Clients of different types compiling
+//	the same file get separate cache files.
+uint64_t ScriptClientBase::_GetCompileCacheSignature() {
+	//Bytecode layout may change between builds
+	uint64_t hash = _HashCompileCacheString(std::string(__DATE__ " " __TIME__), COMPILE_CACHE_HASH_BASE);
+
+	auto _HashFunctions = [&](const std::vector<function>& listFunc) {
+		hash = _HashCompileCacheValue((uint32_t)listFunc.size(), hash);
+		for (const function& iFunc : listFunc) {
+			hash = _HashCompileCacheString(std::string(iFunc.name), hash);
+			hash = _HashCompileCacheValue(iFunc.argc, hash);
+		}
+	};
+	_HashFunctions(parser::get_base_operations());
+	_HashFunctions(func_);
+
+	hash = _HashCompileCacheValue((uint32_t)const_.size(), hash);
+	for (const constant& iConst : const_) {
+		hash = _HashCompileCacheString(std::string(iConst.name), hash);
+		hash = _HashCompileCacheValue(iConst.type, hash);
+		hash = _HashCompileCacheValue(iConst.data, hash);
+	}
+
+	hash = _HashCompileCacheValue(script_engine::optimize_enabled, hash);
+
+	hash = _HashCompileCacheValue((uint32_t)definedMacro_.size(), hash);
+	for (auto& [name, replacement] : definedMacro_) {
+		hash = _HashCompileCacheString(name, hash);
+		hash = _HashCompileCacheString(replacement, hash);
+	}
+
+	return hash;
+}
+uint64_t ScriptClientBase::_GetCompileCacheKey(uint64_t signature) {
+	uint64_t hash = _HashCompileCacheString(engineData_->GetPath(), signature);
+	{
+		std::vector<char>& source = engineData_->GetSource();
+		hash = _HashCompileCacheValue((uint32_t)source.size(), hash);
+		hash = _HashCompileCache(source.data(), source.size(), hash);
+	}
+	return hash;
+}
+std::wstring ScriptClientBase::_GetCompileCachePath(uint64_t signature) {
+	uint64_t hashPath = _HashCompileCacheString(engineData_->GetPath(), COMPILE_CACHE_HASH_BASE);
+	return PathProperty::GetModuleDirectory() + StringUtility::Format(L"cache/script/%016llx_%016llx.dat",
+		hashPath, signature);
+}
+bool ScriptClientBase::_LoadCompileCache(const std::wstring& pathCache, uint64_t key) {
+	if (!File::IsExists(pathCache)) return false;
+
+	try {
+		ByteBuffer buffer;
+		{
+			File file(pathCache);
+			if (!file.Open()) return false;
+
+			size_t size = file.GetSize();
+			if (size < sizeof(COMPILE_CACHE_MAGIC)) return false;
+
+			buffer.SetSize(size);
+			if (file.Read(buffer.GetPointer(), size) != size) return false;
+		}
+
+		char magic[sizeof(COMPILE_CACHE_MAGIC)];
+		buffer.Read(magic, sizeof(magic));
+		if (memcmp(magic, COMPILE_CACHE_MAGIC, sizeof(magic)) != 0) return false;
+		if (buffer.ReadValue<uint32_t>() != COMPILE_CACHE_VERSION) return false;
+		if (buffer.ReadValue<uint8_t>() != COMPILE_CACHE_CONFIG) return false;
+		if (buffer.ReadValue<uint64_t>() != key) return false;
+
+		//Every included file must be unchanged
+		std::vector<std::wstring> listInclude;
+		{
+			uint32_t countInclude = buffer.ReadValue<uint32_t>();
+			for (uint32_t iInclude = 0; iInclude < countInclude; ++iInclude) {
+				uint32_t lenPath = buffer.ReadValue<uint32_t>();
+				if (lenPath * sizeof(wchar_t) > buffer.GetSize() - buffer.GetOffset()) return false;
+
+				std::wstring path(lenPath, L'\0');
+				if (lenPath > 0)
+					buffer.Read(&path[0], lenPath * sizeof(wchar_t));
+				uint64_t hashInclude = buffer.ReadValue<uint64_t>();
+
+				uint64_t hashCurrent = 0;
+				if (!_HashCompileCacheFile(path, &hashCurrent) || hashCurrent != hashInclude)
+					return false;
+				listInclude.push_back(path);
+			}
+		}
+
+		uint64_t hashPayload = buffer.ReadValue<uint64_t>();
+		uint32_t sizePayload = buffer.ReadValue<uint32_t>();
+		if (sizePayload != buffer.GetSize() - buffer.GetOffset()) return false;
+		if (_HashCompileCache(buffer.GetPointer(buffer.GetOffset()), sizePayload) != hashPayload) return false;
+
+		std::vector<char> source(buffer.ReadValue<uint32_t>());
+		if (source.size() > 0)
+			buffer.Read(&source[0], source.size());
+
+		std::list<ScriptFileLineMap::Entry> listEntry;
+		{
+			uint32_t countEntry = buffer.ReadValue<uint32_t>();
+			for (uint32_t iEntry = 0; iEntry < countEntry; ++iEntry) {
+				ScriptFileLineMap::Entry entry;
+				entry.lineStart_ = buffer.ReadInteger();
+				entry.lineEnd_ = buffer.ReadInteger();
+				entry.lineStartOriginal_ = buffer.ReadInteger();
+				entry.lineEndOriginal_ = buffer.ReadInteger();
+				entry.path_.resize(buffer.ReadValue<uint32_t>());
+				if (entry.path_.size() > 0)
+					buffer.Read(&entry.path_[0], entry.path_.size() * sizeof(wchar_t));
+				listEntry.push_back(entry);
+			}
+		}
+
+		unique_ptr<script_engine> engine(new script_engine(&buffer, &func_));
+		if (engine->get_error()) return false;
+
+		engineData_->SetSource(source);
+		engineData_->GetScriptFileLineMap()->GetEntryList() = listEntry;
+		engineData_->SetIncludePaths(listInclude);
+		engineData_->SetEngine(std::move(engine));
+	}
+	catch (...) {
+		return false;
+	}
+	return true;
+}
+void ScriptClientBase::_SaveCompileCache(const std::wstring& pathCache, uint64_t key) {
+	ByteBuffer payload;
+	{
+		std::vector<char>& source = engineData_->GetSource();
+		payload.WriteValue<uint32_t>(source.size());
+		if (source.size() > 0)
+			payload.Write(&source[0], source.size());
+
+		std::list<ScriptFileLineMap::Entry>& listEntry = engineData_->GetScriptFileLineMap()->GetEntryList();
+		payload.WriteValue<uint32_t>(listEntry.size());
+		for (ScriptFileLineMap::Entry& entry : listEntry) {
+			payload.WriteInteger(entry.lineStart_);
+			payload.WriteInteger(entry.lineEnd_);
+			payload.WriteInteger(entry.lineStartOriginal_);
+			payload.WriteInteger(entry.lineEndOriginal_);
+			payload.WriteValue<uint32_t>(entry.path_.size());
+			payload.WriteString(entry.path_);
+		}
+
+		if (!engineData_->GetEngine()->write_compiled(&payload))
+			return;
+	}
+
+	ByteBuffer buffer;
+	buffer.Write((LPVOID)COMPILE_CACHE_MAGIC, sizeof(COMPILE_CACHE_MAGIC));
+	buffer.WriteValue<uint32_t>(COMPILE_CACHE_VERSION);
+	buffer.WriteValue<uint8_t>(COMPILE_CACHE_CONFIG);
+	buffer.WriteValue<uint64_t>(key);
+
+	std::vector<std::wstring>& listInclude = engineData_->GetIncludePaths();
+	buffer.WriteValue<uint32_t>(listInclude.size());
+	for (const std::wstring& path : listInclude) {
+		uint64_t hashInclude = 0;
+		if (!_HashCompileCacheFile(path, &hashInclude)) return;
+
+		buffer.WriteValue<uint32_t>(path.size());
+		buffer.WriteString(path);
+		buffer.WriteValue<uint64_t>(hashInclude);
+	}
+
+	buffer.WriteValue<uint64_t>(_HashCompileCache(payload.GetPointer(), payload.GetSize()));
+	buffer.WriteValue<uint32_t>(payload.GetSize());
+	buffer.Write(payload.GetPointer(), payload.GetSize());
+
+	try {
+		File::CreateFileDirectory(pathCache);
+
+		File file(pathCache);
+		if (file.Open(File::WRITEONLY))
+			file.Write(buffer.GetPointer(), buffer.GetSize());
+	}
+	catch (...) {
+		//The cache is optional, a failed write only costs a recompile next time
+	}
+}
 bool ScriptClientBase::SetSourceFromFile(std::wstring path) {
 	path = PathProperty::GetUnique(path);
 
@@ -369,9 +637,6 @@ bool ScriptClientBase::SetSourceFromFile(std::wstring path) {
 	}
 
 	// Script not found in cache, create a new entry
-
-	engineData_ = cache_->AddCache(path, make_unique<ScriptEngineData>());
-	engineData_->SetPath(path);
 	
 	shared_ptr<FileReader> reader = FileManager::GetBase()->GetFileReader(path);
 	if (reader == nullptr || !reader->Open())
@@ -383,7 +648,20 @@ bool ScriptClientBase::SetSourceFromFile(std::wstring path) {
 	source.resize(size);
 	reader->Read(&source[0], size);
 
-	SetSource(source);
+	{
+		//Another loader may have added the same script while the file was being read
+		Lock lock(cache_->GetLock());
+
+		if (auto pFindCache = cache_->GetCache(path)) {
+			engineData_ = pFindCache;
+			return true;
+		}
+
+		engineData_ = cache_->AddCache(path, make_unique<ScriptEngineData>());
+		engineData_->SetPath(path);
+
+		SetSource(source);
+	}
 
 	return true;
 }
@@ -399,14 +677,32 @@ void ScriptClientBase::SetSource(std::vector<char>& source) {
 	mapLine->AddEntry(engineData_->GetPath(), 1, StringUtility::CountCharacter(source, '\n') + 1);
 }
 void ScriptClientBase::Compile() {
-	if (engineData_->GetEngine() == nullptr) {
-		std::vector<char> source = _ParseScriptSource(engineData_->GetSource());
-		engineData_->SetSource(source);
+	{
+		Lock lock(engineData_->GetCompileLock());
+		if (engineData_->GetEngine() == nullptr) {
+			//Only scripts loaded from a file are cached on disk
+			bool bUseCache = engineData_->GetPath().size() > 0;
+			uint64_t keyCache = 0;
+			std::wstring pathCache;
+			if (bUseCache) {
+				uint64_t signature = _GetCompileCacheSignature();
+				keyCache = _GetCompileCacheKey(signature);
+				pathCache = _GetCompileCachePath(signature);
+			}
 
-		bool bCreateSuccess = _CreateEngine();
-		if (!bCreateSuccess) {
-			bError_ = true;
-			_RaiseErrorFromEngine();
+			if (!bUseCache || !_LoadCompileCache(pathCache, keyCache)) {
+				std::vector<char> source = _ParseScriptSource(engineData_->GetSource());
+				engineData_->SetSource(source);
+
+				bool bCreateSuccess = _CreateEngine();
+				if (!bCreateSuccess) {
+					bError_ = true;
+					_RaiseErrorFromEngine();
+				}
+
+				if (bUseCache)
+					_SaveCompileCache(pathCache, keyCache);
+			}
 		}
 	}
 
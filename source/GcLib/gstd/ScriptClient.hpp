@@ -48,6 +48,10 @@ namespace gstd {
 
 		unique_ptr<script_engine> engine_;
 		ScriptFileLineMap mapLine_;
+
+		std::vector<std::wstring> listIncludePath_;
+
+		gstd::CriticalSection lockCompile_;
 	public:
 		ScriptEngineData();
 		virtual ~ScriptEngineData();
@@ -63,6 +67,12 @@ namespace gstd {
 		unique_ptr<script_engine>& GetEngine() { return engine_; }
 
 		ScriptFileLineMap* GetScriptFileLineMap() { return &mapLine_; }
+
+		void SetIncludePaths(const std::vector<std::wstring>& paths) { listIncludePath_ = paths; }
+		std::vector<std::wstring>& GetIncludePaths() { return listIncludePath_; }
+
+		//Held while the engine is being built, so a script shared by several loads is compiled once
+		gstd::CriticalSection& GetCompileLock() { return lockCompile_; }
 	};
 
 	//*******************************************************************
@@ -70,10 +80,13 @@ namespace gstd {
 	//*******************************************************************
 	class ScriptEngineCache {
 	protected:
+		gstd::CriticalSection lock_;
 		std::map<std::wstring, uptr<ScriptEngineData>> cache_;
 	public:
 		ScriptEngineCache();
 
+		gstd::CriticalSection& GetLock() { return lock_; }
+
 		void Clear();
 
 		ScriptEngineData* AddCache(const std::wstring& name, uptr<ScriptEngineData>&& data);
@@ -133,6 +146,12 @@ namespace gstd {
 		virtual std::vector<char> _ParseScriptSource(std::vector<char>& source);
 		virtual bool _CreateEngine();
 
+		uint64_t _GetCompileCacheSignature();
+		uint64_t _GetCompileCacheKey(uint64_t signature);
+		std::wstring _GetCompileCachePath(uint64_t signature);
+		bool _LoadCompileCache(const std::wstring& pathCache, uint64_t key);
+		void _SaveCompileCache(const std::wstring& pathCache, uint64_t key);
+
 		std::wstring _ExtendPath(std::wstring path);
 	public:
 		ScriptClientBase();
@@ -361,17 +380,12 @@ namespace gstd {
 	}
 	template<typename T>
 	value ScriptClientBase::CreateFloatArrayValue(const T* ptrList, size_t count) {
-		type_data* type_float = script_type_manager::get_float_type();
 		type_data* type_arr = script_type_manager::get_float_array_type();
 		if (ptrList && count > 0) {
-			std::vector<value> res_arr;
-			res_arr.resize(count);
-			for (size_t iVal = 0U; iVal < count; ++iVal) {
-				res_arr[iVal] = value(type_float, (double)(ptrList[iVal]));
-			}
+			std::vector<double> res_arr(ptrList, ptrList + count);
 
 			value res;
-			res.reset(type_arr, res_arr);
+			res.reset(type_arr, MOVE(res_arr));
 			return res;
 		}
 		return value(type_arr, std::wstring());
@@ -386,17 +400,12 @@ namespace gstd {
 	}
 	template<typename T>
 	value ScriptClientBase::CreateIntArrayValue(const T* ptrList, size_t count) {
-		type_data* type_int = script_type_manager::get_int_type();
 		type_data* type_arr = script_type_manager::get_int_array_type();
 		if (ptrList && count > 0) {
-			std::vector<value> res_arr;
-			res_arr.resize(count);
-			for (size_t iVal = 0U; iVal < count; ++iVal) {
-				res_arr[iVal] = value(type_int, (int64_t)(ptrList[iVal]));
-			}
+			std::vector<int64_t> res_arr(ptrList, ptrList + count);
 
 			value res;
-			res.reset(type_arr, res_arr);
+			res.reset(type_arr, MOVE(res_arr));
 			return res;
 		}
 		return value(type_arr, std::wstring());
@@ -439,5 +448,6 @@ namespace gstd {
 
 		std::vector<char>& GetResult() { return src_; }
 		ScriptFileLineMap* GetLineMap() { return mapLine_; }
+		const std::set<std::wstring>& GetIncludedPaths() { return setIncludedPath_; }
 	};
 }
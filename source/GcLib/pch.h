@@ -134,6 +134,7 @@
 
 #include <array>
 #include <list>
+#include <deque>
 #include <vector>
 #include <set>
 #include <map>
@@ -148,6 +149,7 @@
 #include <numeric>
 #include <iterator>
 #include <future>
+#include <shared_mutex>
 
 #include <fstream>
 #include <sstream>
@@ -63,9 +63,16 @@ DnhConfiguration::DnhConfiguration() {
 	windowSizeList_ = { { 640, 480 }, { 800, 600 }, { 960, 720 }, { 1280, 960 } };
 
 	bEnableUnfocusedProcessing_ = false;
+	bScriptOptimize_ = true;
+	replayDigestInterval_ = 60;
+
+	bHeadless_ = false;
 
 	LoadConfigFile();
 	_LoadDefinitionFile();
+#if defined(DNH_PROJ_EXECUTOR)
+	_LoadCommandLine();
+#endif
 }
 DnhConfiguration::~DnhConfiguration() {}
 
@@ -97,6 +104,13 @@ bool DnhConfiguration::_LoadDefinitionFile() {
 		std::wstring str = prop.GetString(L"unfocused.processing", L"false");
 		bEnableUnfocusedProcessing_ = str == L"true" ? true : StringUtility::ToInteger(str);
 	}
+	{
+		std::wstring str = prop.GetString(L"script.optimize", L"true");
+		bScriptOptimize_ = str == L"true" ? true : StringUtility::ToInteger(str);
+	}
+
+	//Frames between replay state digests, 0 disables them
+	replayDigestInterval_ = std::max(prop.GetInteger(L"replay.digest.interval", 60), 0);
 
 	{
 		auto _AddWindowSize = [&](std::vector<POINT>& listSize, LONG width, LONG height) {
@@ -137,6 +151,39 @@ bool DnhConfiguration::_LoadDefinitionFile() {
 	return true;
 }
 
+//	-headless -script <main script> -replay <replay file> [-hashlog <output file>]
+//Plays the replay back without a window, sound or frame limit and writes one state digest per frame.
+void DnhConfiguration::_LoadCommandLine() {
+	std::vector<std::wstring> listArg;
+	for (int i = 1; i < __argc; ++i)
+		listArg.push_back(__wargv[i]);
+
+	for (size_t i = 0; i < listArg.size(); ++i) {
+		const std::wstring& arg = listArg[i];
+		bool bHasValue = (i + 1) < listArg.size();
+
+		if (arg == L"-headless")
+			bHeadless_ = true;
+		else if (arg == L"-script" && bHasValue)
+			pathHeadlessScript_ = PathProperty::GetUnique(listArg[++i]);
+		else if (arg == L"-replay" && bHasValue)
+			pathHeadlessReplay_ = PathProperty::GetUnique(listArg[++i]);
+		else if (arg == L"-hashlog" && bHasValue)
+			pathHeadlessHashLog_ = PathProperty::GetUnique(listArg[++i]);
+	}
+
+	if (bHeadless_) {
+		if (pathHeadlessHashLog_.size() == 0)
+			pathHeadlessHashLog_ = PathProperty::GetModuleDirectory() + L"headless_hash.txt";
+
+		modeScreen_ = ScreenMode::SCREENMODE_WINDOW;
+		bVSync_ = false;
+		bLogWindow_ = false;
+		bEnableUnfocusedProcessing_ = true;
+		multiSamples_ = D3DMULTISAMPLE_NONE;
+	}
+}
+
 bool DnhConfiguration::LoadConfigFile() {
 	std::wstring path = PathProperty::GetModuleDirectory() + L"config.dat";
 
@@ -30,6 +30,8 @@ public:
 	LONG screenWidth_;
 	LONG screenHeight_;
 	bool bEnableUnfocusedProcessing_;
+	bool bScriptOptimize_;
+	uint32_t replayDigestInterval_;
 
 	uint32_t fpsStandard_;
 	int fpsType_;
@@ -55,7 +57,14 @@ public:
 
 	std::wstring pathPackageScript_;
 
+	//Headless replay verification, see _LoadCommandLine
+	bool bHeadless_;
+	std::wstring pathHeadlessScript_;
+	std::wstring pathHeadlessReplay_;
+	std::wstring pathHeadlessHashLog_;
+
 	bool _LoadDefinitionFile();
+	void _LoadCommandLine();
 public:
 	DnhConfiguration();
 	virtual ~DnhConfiguration();
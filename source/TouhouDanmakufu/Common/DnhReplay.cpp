@@ -275,6 +275,20 @@ void ReplayInformation::StageData::ReadRecord(gstd::RecordBuffer& record) {
 		}
 	}
 
+	//State digests, replays saved before they existed have none of these entries
+	digestInterval_ = 0;
+	digestPartCount_ = 0;
+	listStateDigest_.clear();
+	if (record.IsExists("digestInterval")) {
+		record.GetRecord<uint32_t>("digestInterval", digestInterval_);
+		record.GetRecord<uint32_t>("digestPartCount", digestPartCount_);
+
+		size_t countStateDigest = *record.GetRecordAs<uint32_t>("countStateDigest");
+		listStateDigest_.resize(countStateDigest);
+		if (countStateDigest > 0)
+			record.GetRecord("listStateDigest", &listStateDigest_[0], sizeof(uint64_t) * countStateDigest);
+	}
+
 	//Player information
 	playerScriptID_ = *record.GetRecordAsStringW("playerScriptID");
 	playerScriptFileName_ = *record.GetRecordAsStringW("playerScriptFileName");
@@ -313,6 +327,16 @@ void ReplayInformation::StageData::WriteRecord(gstd::RecordBuffer& record) {
 		record.SetRecordAsRecordBuffer("mapCommonData", recComMap);
 	}
 
+	//State digests
+	if (digestInterval_ > 0) {
+		size_t countStateDigest = listStateDigest_.size();
+		record.SetRecord<uint32_t>("digestInterval", digestInterval_);
+		record.SetRecord<uint32_t>("digestPartCount", digestPartCount_);
+		record.SetRecord<uint32_t>("countStateDigest", countStateDigest);
+		if (countStateDigest > 0)
+			record.SetRecord("listStateDigest", &listStateDigest_[0], sizeof(uint64_t) * countStateDigest);
+	}
+
 	//Player information
 	record.SetRecordAsStringW("playerScriptID", playerScriptID_);
 	record.SetRecordAsStringW("playerScriptFileName", playerScriptFileName_);
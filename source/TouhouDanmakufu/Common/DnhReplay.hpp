@@ -84,6 +84,11 @@ private:
 	uint32_t randSeed_;
 	std::vector<float> listFramePerSecond_;
 
+	//State digests taken every digestInterval_ frames, digestPartCount_ hashes each. Interval is 0 when none were recorded.
+	uint32_t digestInterval_ = 0;
+	uint32_t digestPartCount_ = 0;
+	std::vector<uint64_t> listStateDigest_;
+
 	gstd::RecordBuffer recordKey_;
 	std::map<std::string, gstd::RecordBuffer> mapCommonData_;
 
@@ -121,6 +126,21 @@ public:
 	void AddFramePerSecond(float frame) { listFramePerSecond_.push_back(frame); }
 	double GetFramePerSecondAverage();
 
+	uint32_t GetStateDigestInterval() { return digestInterval_; }
+	uint32_t GetStateDigestPartCount() { return digestPartCount_; }
+	void SetStateDigestFormat(uint32_t interval, uint32_t countPart) {
+		digestInterval_ = interval;
+		digestPartCount_ = countPart;
+		listStateDigest_.clear();
+	}
+	void AddStateDigest(const uint64_t* listHash) {
+		listStateDigest_.insert(listStateDigest_.end(), listHash, listHash + digestPartCount_);
+	}
+	const uint64_t* GetStateDigest(size_t index) {
+		size_t pos = index * digestPartCount_;
+		return (digestPartCount_ > 0 && pos + digestPartCount_ <= listStateDigest_.size()) ? &listStateDigest_[pos] : nullptr;
+	}
+
 	gstd::RecordBuffer& GetReplayKeyRecord() { return recordKey_; }
 	void SetReplayKeyRecord(gstd::RecordBuffer&& rec) { recordKey_ = MOVE(rec); }
 	std::set<std::string> GetCommonDataAreaList();
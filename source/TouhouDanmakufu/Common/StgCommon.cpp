@@ -3,6 +3,243 @@
 #include "StgCommon.hpp"
 #include "StgSystem.hpp"
 
+#ifdef __L_MATH_VECTORIZE
+#include <immintrin.h>
+#endif
+
+//****************************************************************************
+//StgHotDataIndex
+//****************************************************************************
+StgHotDataIndex::StgHotDataIndex() {
+	originX_ = 0;
+	originY_ = 0;
+	cellSizeX_ = CELL_SIZE;
+	cellSizeY_ = CELL_SIZE;
+	countX_ = 0;
+	countY_ = 0;
+	depthScratchRow_ = 0;
+}
+
+void StgHotDataIndex::_GetCellRange(const DxRect<double>& rect, LONG* pRes) {
+	//Same mapping as Build, clamped the same way so that every row inside rect falls in range
+	auto _Map = [](double pos, double origin, double size, LONG count) -> LONG {
+		double cell = floor((pos - origin) / size);
+		if (!(cell >= 0)) return 0;
+		if (cell >= count - 1) return count - 1;
+		return (LONG)cell;
+	};
+	pRes[0] = _Map(std::min(rect.left, rect.right), originX_, cellSizeX_, countX_);
+	pRes[1] = _Map(std::min(rect.top, rect.bottom), originY_, cellSizeY_, countY_);
+	pRes[2] = _Map(std::max(rect.left, rect.right), originX_, cellSizeX_, countX_);
+	pRes[3] = _Map(std::max(rect.top, rect.bottom), originY_, cellSizeY_, countY_);
+}
+
+bool StgHotDataIndex::IsPointInLine(double px, double py, double x1, double y1, double x2, double y2, double width) {
+	double dx = x2 - x1;
+	double dy = y2 - y1;
+	double dpx = px - x1;
+	double dpy = py - y1;
+
+	double ll = Math::HypotSq(dx, dy);
+	double t = ll > 0 ? std::clamp((dpx * dx + dpy * dy) / ll, 0.0, 1.0) : 0.0;
+
+	double hw = width * 0.5;
+	return Math::HypotSq(dpx - dx * t, dpy - dy * t) <= hw * hw;
+}
+DxRect<double> StgHotDataIndex::GetLineBound(double x1, double y1, double x2, double y2, double width) {
+	double hw = abs(width) * 0.5;
+	return DxRect<double>(std::min(x1, x2) - hw, std::min(y1, y2) - hw, 
+		std::max(x1, x2) + hw, std::max(y1, y2) + hw);
+}
+
+void StgHotDataIndex::Build(StgHotDataTable* table) {
+	const size_t count = table->GetSize();
+	const double* pPosX = table->listPosX.data();
+	const double* pPosY = table->listPosY.data();
+	uint8_t* pFlag = table->listFlag.data();
+
+	listUnboundedRow_.clear();
+
+	double minX = DBL_MAX, minY = DBL_MAX;
+	double maxX = -DBL_MAX, maxY = -DBL_MAX;
+	for (size_t i = 0; i < count; ++i) {
+		pFlag[i] &= ~StgHotDataTable::FLAG_MOVED;
+
+		double x = pPosX[i];
+		double y = pPosY[i];
+		if (!std::isfinite(x) || !std::isfinite(y)) continue;
+		minX = std::min(minX, x);
+		minY = std::min(minY, y);
+		maxX = std::max(maxX, x);
+		maxY = std::max(maxY, y);
+	}
+
+	if (minX > maxX) {
+		originX_ = originY_ = 0;
+		countX_ = countY_ = 1;
+	}
+	else {
+		auto _Fit = [](double extent, double* pSize) -> LONG {
+			*pSize = CELL_SIZE;
+			if (extent / CELL_SIZE >= CELL_COUNT_MAX - 1)
+				*pSize = extent / (CELL_COUNT_MAX - 1);
+			return std::min<LONG>((LONG)(extent / *pSize) + 1, CELL_COUNT_MAX);
+		};
+		originX_ = minX;
+		originY_ = minY;
+		countX_ = _Fit(maxX - minX, &cellSizeX_);
+		countY_ = _Fit(maxY - minY, &cellSizeY_);
+	}
+
+	const size_t countCell = countX_ * countY_;
+	listCellStart_.assign(countCell + 1, 0);
+	listRowCell_.resize(count);
+
+	//Counting sort of the rows by cell, rows stay ascending within each cell
+	DxRect<double> rcPoint;
+	LONG cellRange[4];
+	for (size_t i = 0; i < count; ++i) {
+		double x = pPosX[i];
+		double y = pPosY[i];
+		if (!std::isfinite(x) || !std::isfinite(y)) {
+			listRowCell_[i] = UINT32_MAX;
+			listUnboundedRow_.push_back(i);
+			continue;
+		}
+
+		rcPoint.Set(x, y, x, y);
+		_GetCellRange(rcPoint, cellRange);
+		uint32_t cell = cellRange[1] * countX_ + cellRange[0];
+		listRowCell_[i] = cell;
+		++listCellStart_[cell + 1];
+	}
+	for (size_t iCell = 0; iCell < countCell; ++iCell)
+		listCellStart_[iCell + 1] += listCellStart_[iCell];
+
+	listCellRow_.resize(count - listUnboundedRow_.size());
+	{
+		std::vector<uint32_t> listCellFill(listCellStart_.begin(), listCellStart_.end() - 1);
+		for (size_t i = 0; i < count; ++i) {
+			uint32_t cell = listRowCell_[i];
+			if (cell != UINT32_MAX)
+				listCellRow_[listCellFill[cell]++] = i;
+		}
+	}
+
+	table->countIndexed = count;
+	table->listMovedRow.clear();
+}
+
+void StgHotDataIndex::GetCandidateRows(StgHotDataTable* table, const DxRect<double>& rect, std::vector<uint32_t>& res) {
+	res.clear();
+
+	const size_t count = table->GetSize();
+	const size_t countIndexed = std::min(table->countIndexed, count);
+	const uint8_t* pFlag = table->listFlag.data();
+
+	if (countIndexed > 0) {
+		//Positions are truncated to integers in some queries, pad by a pixel
+		DxRect<double> rcQuery(rect.left - 1, rect.top - 1, rect.right + 1, rect.bottom + 1);
+
+		LONG cellRange[4];
+		_GetCellRange(rcQuery, cellRange);
+		for (LONG iy = cellRange[1]; iy <= cellRange[3]; ++iy) {
+			for (LONG ix = cellRange[0]; ix <= cellRange[2]; ++ix) {
+				uint32_t cell = iy * countX_ + ix;
+				for (uint32_t iPos = listCellStart_[cell]; iPos < listCellStart_[cell + 1]; ++iPos) {
+					uint32_t row = listCellRow_[iPos];
+					if ((pFlag[row] & StgHotDataTable::FLAG_MOVED) == 0)
+						res.push_back(row);
+				}
+			}
+		}
+		for (uint32_t row : listUnboundedRow_) {
+			if ((pFlag[row] & StgHotDataTable::FLAG_MOVED) == 0)
+				res.push_back(row);
+		}
+		for (uint32_t row : table->listMovedRow)
+			res.push_back(row);
+
+		std::sort(res.begin(), res.end());
+	}
+
+	for (size_t row = countIndexed; row < count; ++row)
+		res.push_back(row);
+}
+
+//****************************************************************************
+//StgStateDigest
+//****************************************************************************
+const char* StgStateDigest::GetPartName(size_t part) {
+	static const char* listName[PART_COUNT] = {
+		"Player", "Shot", "Enemy", "Item", "Rand", "CommonData",
+	};
+	return part < PART_COUNT ? listName[part] : "Unknown";
+}
+uint64_t StgStateDigest::Hash(const void* data, size_t size, uint64_t hash) {
+	const byte* pData = (const byte*)data;
+	for (size_t i = 0; i < size; ++i) {
+		hash ^= pData[i];
+		hash *= 0x100000001b3ui64;
+	}
+	return hash;
+}
+uint64_t StgStateDigest::HashTable(const StgHotDataTable* table, uint64_t hash) {
+	//Flags are left out, FLAG_MOVED only tracks the spatial index
+	size_t count = table->GetSize();
+	hash = HashValue((uint32_t)count, hash);
+	if (count > 0) {
+		hash = Hash(table->listPosX.data(), count * sizeof(double), hash);
+		hash = Hash(table->listPosY.data(), count * sizeof(double), hash);
+		hash = Hash(table->listObjectID.data(), count * sizeof(int), hash);
+		hash = Hash(table->listType.data(), count * sizeof(int), hash);
+	}
+	return hash;
+}
+uint64_t StgStateDigest::HashScriptValue(const gstd::value& val, uint64_t hash) {
+	if (!val.has_data())
+		return HashValue((uint8_t)type_data::tk_null, hash);
+
+	type_data::type_kind kind = val.get_type()->get_kind();
+	hash = HashValue((uint8_t)kind, hash);
+
+	switch (kind) {
+	case type_data::tk_int:
+		return HashValue(val.as_int(), hash);
+	case type_data::tk_float:
+		return HashValue(val.as_float(), hash);
+	case type_data::tk_char:
+		return HashValue(val.as_char(), hash);
+	case type_data::tk_boolean:
+		return HashValue(val.as_boolean(), hash);
+	case type_data::tk_array:
+	{
+		//Packed and unpacked strings and arrays must hash the same
+		if (val.is_packed_string()) {
+			std::wstring_view str = val.as_string_view();
+			hash = HashValue((uint32_t)str.size(), hash);
+			for (wchar_t ch : str) {
+				hash = HashValue((uint8_t)type_data::tk_char, hash);
+				hash = HashValue(ch, hash);
+			}
+			return hash;
+		}
+
+		size_t count = val.length_as_array();
+		hash = HashValue((uint32_t)count, hash);
+		for (size_t i = 0; i < count; ++i)
+			hash = HashScriptValue(val.index_as_array_copy(i), hash);
+		return hash;
+	}
+	}
+
+	//Pointers differ between runs and are left out
+	return hash;
+}
+uint64_t StgStateDigest::GetCombinedHash() const {
+	return Hash(listHash.data(), listHash.size() * sizeof(uint64_t), HASH_INIT);
+}
+
 //****************************************************************************
 //StgMoveObject
 //****************************************************************************
@@ -11,17 +248,23 @@ StgMoveObject::StgMoveObject(StgStageController* stageController) : StgObjectBas
 	posY_ = 0;
 	framePattern_ = 0;
 
+	pHotTable_ = nullptr;
+	idxHotData_ = 0;
+
 	pattern_ = nullptr;
 	bEnableMovement_ = true;
 	frameMove_ = 0;
+
+	pMoveBatch_ = nullptr;
+	idxMoveBatch_ = 0;
 }
 StgMoveObject::~StgMoveObject() {
 	pattern_ = nullptr;
 }
 
 void StgMoveObject::Copy(StgMoveObject* src) {
-	posX_ = src->posX_;
-	posY_ = src->posY_;
+	SetPositionX(src->posX_);
+	SetPositionY(src->posY_);
 
 	auto _ClonePattern = [](StgMovePattern* srcPattern, StgMoveObject* newTarget) {
 		ref_unsync_ptr<StgMovePattern> pattern = nullptr;
@@ -38,35 +281,36 @@ void StgMoveObject::Copy(StgMoveObject* src) {
 	frameMove_ = src->frameMove_;
 	framePattern_ = src->framePattern_;
 
-	mapPattern_.clear();
-	for (auto& iPair : src->mapPattern_) {
-		std::list<ref_unsync_ptr<StgMovePattern>> listPattern;
-		for (auto& iPattern : iPair.second) {
-			auto pattern = _ClonePattern(iPattern.get(), this);
-			listPattern.push_back(pattern);
-		}
-		mapPattern_[iPair.first] = listPattern;
-	}
+	listPattern_.clear();
+	for (const ReservedPattern& srcReserved : src->listPattern_)
+		listPattern_.push_back(ReservedPattern{ srcReserved.frame, _ClonePattern(srcReserved.pattern.get(), this) });
 }
 
 void StgMoveObject::_Move() {
+	StgMoveBatch* pMoveBatch = pMoveBatch_;
+	pMoveBatch_ = nullptr;
+
 	if (!bEnableMovement_) return;
 	++frameMove_;
 
-	if (mapPattern_.size() > 0) {
-		auto itr = mapPattern_.begin();
-		while (framePattern_ >= itr->first) {
-			for (auto& ipPattern : itr->second)
-				_AttachReservedPattern(ipPattern);
-			itr = mapPattern_.erase(itr);
-			if (mapPattern_.size() == 0) break;
+	if (listPattern_.size() > 0) {
+		size_t countApplied = 0;
+		while (countApplied < listPattern_.size() && framePattern_ >= listPattern_[countApplied].frame) {
+			ref_unsync_ptr<StgMovePattern> pattern = listPattern_[countApplied].pattern;
+			listPattern_[countApplied].pattern = nullptr;
+			++countApplied;
+			_AttachReservedPattern(pattern);
 		}
+		//Patterns added meanwhile are due later, so they always sort after the applied ones
+		if (countApplied > 0)
+			listPattern_.erase(listPattern_.begin(), listPattern_.begin() + countApplied);
 		if (pattern_ == nullptr)
 			pattern_.reset(new StgMovePattern_Angle(this));
 	}
 	else if (pattern_ == nullptr) return;
 
-	pattern_->Move();
+	if (pMoveBatch == nullptr || !pMoveBatch->Apply(idxMoveBatch_, this))
+		pattern_->Move();
 	++framePattern_;
 }
 void StgMoveObject::_AttachReservedPattern(ref_unsync_ptr<StgMovePattern> pattern) {
@@ -78,9 +322,21 @@ void StgMoveObject::AddPattern(uint32_t frameDelay, ref_unsync_ptr<StgMovePatter
 		_AttachReservedPattern(pattern);
 	else {
 		uint32_t frame = frameDelay + framePattern_;
-		mapPattern_[frame].push_back(pattern);
+
+		//Usually appends, patterns tend to be added in increasing delay order
+		auto itrInsert = std::upper_bound(listPattern_.begin(), listPattern_.end(), frame,
+			[](uint32_t f, const ReservedPattern& r) { return f < r.frame; });
+		listPattern_.insert(itrInsert, ReservedPattern{ frame, pattern });
 	}
 }
+bool StgMoveObject::IsSimpleMovement() {
+	if (!bEnableMovement_ || pattern_ == nullptr || pattern_->GetType() != StgMovePattern::TYPE_ANGLE)
+		return false;
+	//A reserved pattern due this frame replaces pattern_ before it moves
+	if (listPattern_.size() > 0 && framePattern_ >= listPattern_[0].frame)
+		return false;
+	return true;
+}
 double StgMoveObject::GetSpeed() {
 	if (pattern_ == nullptr) return 0;
 	double res = pattern_->GetSpeed();
@@ -120,6 +376,193 @@ void StgMoveObject::SetSpeedY(double speedY) {
 	pattern->SetSpeedY(speedY);
 }
 
+//****************************************************************************
+//StgMoveBatch
+//****************************************************************************
+StgMoveBatch::StgMoveBatch() {
+	const CpuInformation& cpuInfo = SystemUtility::GetCpuInfo();
+	bUseFMA_ = cpuInfo.FlagFMA() && cpuInfo.FlagAVX() && cpuInfo.FlagOSXSAVE();
+	countApplied_ = 0;
+}
+
+void StgMoveBatch::Clear() {
+	listObject_.clear();
+	listPattern_.clear();
+	for (auto& iField : listField_)
+		iField.clear();
+	countApplied_ = 0;
+}
+bool StgMoveBatch::Add(StgMoveObject* obj) {
+	if (!obj->IsSimpleMovement()) return false;
+
+	StgMovePattern_Angle* pattern = (StgMovePattern_Angle*)obj->pattern_.get();
+	if (pattern->target_ != obj) return false;
+
+	obj->pMoveBatch_ = this;
+	obj->idxMoveBatch_ = listObject_.size();
+
+	listObject_.push_back(obj);
+	listPattern_.push_back(pattern);
+
+	listField_[IN_POS_X].push_back(obj->posX_);
+	listField_[IN_POS_Y].push_back(obj->posY_);
+	listField_[IN_SPEED].push_back(pattern->speed_);
+	listField_[IN_ACCEL].push_back(pattern->acceleration_);
+	listField_[IN_SPMAX].push_back(pattern->maxSpeed_);
+	listField_[IN_AGVEL].push_back(pattern->angularVelocity_);
+	listField_[IN_AGACC].push_back(pattern->angularAcceleration_);
+	listField_[IN_AGMAX].push_back(pattern->angularMaxVelocity_);
+	listField_[IN_ANGLE].push_back(pattern->angDirection_);
+	listField_[IN_COS].push_back(pattern->c_);
+	listField_[IN_SIN].push_back(pattern->s_);
+
+	return true;
+}
+
+//Same as the acceleration step of StgMovePattern_Angle::Move
+double StgMoveBatch::_Accelerate(double value, double accel, double max) {
+	if (accel != 0) {
+		value += accel;
+		if (max != StgMovePattern::UNCAPPED) {
+			if (accel > 0)
+				value = std::min(value, max);
+			if (accel < 0)
+				value = std::max(value, max);
+		}
+	}
+	return value;
+}
+
+#ifdef __L_MATH_VECTORIZE
+//Branchless _Accelerate for two lanes.
+//	The compares are ordered so that NaN and signed zeros select the same operand std::min/std::max would.
+static inline __m128d _AccelerateVec(__m128d value, __m128d accel, __m128d max) {
+	const __m128d zero = _mm_setzero_pd();
+	const __m128d uncapped = _mm_set1_pd((double)StgMovePattern::UNCAPPED);
+
+	__m128d sum = _mm_add_pd(value, accel);
+
+	//std::min(sum, max) -> (max < sum) ? max : sum
+	//std::max(sum, max) -> (sum < max) ? max : sum
+	__m128d resMin = _mm_blendv_pd(sum, max, _mm_cmplt_pd(max, sum));
+	__m128d resMax = _mm_blendv_pd(sum, max, _mm_cmplt_pd(sum, max));
+
+	__m128d bCapped = _mm_cmpneq_pd(max, uncapped);
+	__m128d res = sum;
+	res = _mm_blendv_pd(res, resMin, _mm_and_pd(bCapped, _mm_cmpgt_pd(accel, zero)));
+	res = _mm_blendv_pd(res, resMax, _mm_and_pd(bCapped, _mm_cmplt_pd(accel, zero)));
+
+	return _mm_blendv_pd(value, res, _mm_cmpneq_pd(accel, zero));
+}
+#endif
+
+void StgMoveBatch::Step() {
+	size_t count = listObject_.size();
+	for (size_t i = COUNT_INPUT; i < COUNT_FIELD; ++i)
+		listField_[i].resize(count);
+	if (count == 0) return;
+
+	const double* inPosX = listField_[IN_POS_X].data();
+	const double* inPosY = listField_[IN_POS_Y].data();
+	const double* inSpeed = listField_[IN_SPEED].data();
+	const double* inAccel = listField_[IN_ACCEL].data();
+	const double* inSpMax = listField_[IN_SPMAX].data();
+	const double* inAgVel = listField_[IN_AGVEL].data();
+	const double* inAgAcc = listField_[IN_AGACC].data();
+	const double* inAgMax = listField_[IN_AGMAX].data();
+	const double* inAngle = listField_[IN_ANGLE].data();
+	const double* inCos = listField_[IN_COS].data();
+	const double* inSin = listField_[IN_SIN].data();
+	double* outPosX = listField_[OUT_POS_X].data();
+	double* outPosY = listField_[OUT_POS_Y].data();
+	double* outSpeed = listField_[OUT_SPEED].data();
+	double* outAgVel = listField_[OUT_AGVEL].data();
+	double* outAngle = listField_[OUT_ANGLE].data();
+	double* outCos = listField_[OUT_COS].data();
+	double* outSin = listField_[OUT_SIN].data();
+
+	size_t i = 0;
+
+	//Speed and angular velocity
+#ifdef __L_MATH_VECTORIZE
+	for (; i + 2 <= count; i += 2) {
+		_mm_storeu_pd(outSpeed + i, _AccelerateVec(_mm_loadu_pd(inSpeed + i),
+			_mm_loadu_pd(inAccel + i), _mm_loadu_pd(inSpMax + i)));
+		_mm_storeu_pd(outAgVel + i, _AccelerateVec(_mm_loadu_pd(inAgVel + i),
+			_mm_loadu_pd(inAgAcc + i), _mm_loadu_pd(inAgMax + i)));
+	}
+#endif
+	for (; i < count; ++i) {
+		outSpeed[i] = _Accelerate(inSpeed[i], inAccel[i], inSpMax[i]);
+		outAgVel[i] = _Accelerate(inAgVel[i], inAgAcc[i], inAgMax[i]);
+	}
+
+	//Direction, kept scalar as there is no vector cos/sin that matches the CRT bit for bit
+	for (i = 0; i < count; ++i) {
+		double angle = inAngle[i];
+		double c = inCos[i];
+		double s = inSin[i];
+		if (outAgVel[i] != 0) {
+			angle = angle + outAgVel[i];
+			if (angle != StgMovePattern::NO_CHANGE) {
+				angle = Math::NormalizeAngleRad(angle);
+				c = cos(angle);
+				s = sin(angle);
+			}
+		}
+		outAngle[i] = angle;
+		outCos[i] = c;
+		outSin[i] = s;
+	}
+
+	//Position, the fused multiply-add is only vectorized where FMA3 is available
+	i = 0;
+#ifdef __L_MATH_VECTORIZE
+	if (bUseFMA_) {
+		for (; i + 2 <= count; i += 2) {
+			__m128d speed = _mm_loadu_pd(outSpeed + i);
+			_mm_storeu_pd(outPosX + i, _mm_fmadd_pd(speed, _mm_loadu_pd(outCos + i), _mm_loadu_pd(inPosX + i)));
+			_mm_storeu_pd(outPosY + i, _mm_fmadd_pd(speed, _mm_loadu_pd(outSin + i), _mm_loadu_pd(inPosY + i)));
+		}
+	}
+#endif
+	for (; i < count; ++i) {
+		outPosX[i] = fma(outSpeed[i], outCos[i], inPosX[i]);
+		outPosY[i] = fma(outSpeed[i], outSin[i], inPosY[i]);
+	}
+}
+bool StgMoveBatch::Apply(size_t index, StgMoveObject* obj) {
+	if (index >= listObject_.size() || listObject_[index] != obj) return false;
+
+	StgMovePattern_Angle* pattern = listPattern_[index];
+	if (obj->pattern_.get() != pattern) return false;
+
+	//Anything written to the object since Add invalidates its result, compared bitwise to also catch -0 and NaN
+	const double current[COUNT_INPUT] = {
+		obj->posX_, obj->posY_,
+		pattern->speed_, pattern->acceleration_, pattern->maxSpeed_,
+		pattern->angularVelocity_, pattern->angularAcceleration_, pattern->angularMaxVelocity_,
+		pattern->angDirection_, pattern->c_, pattern->s_,
+	};
+	for (size_t i = 0; i < COUNT_INPUT; ++i) {
+		if (memcmp(&current[i], &listField_[i][index], sizeof(double)) != 0)
+			return false;
+	}
+
+	pattern->speed_ = listField_[OUT_SPEED][index];
+	pattern->angularVelocity_ = listField_[OUT_AGVEL][index];
+	pattern->angDirection_ = listField_[OUT_ANGLE][index];
+	pattern->c_ = listField_[OUT_COS][index];
+	pattern->s_ = listField_[OUT_SIN][index];
+
+	obj->SetPositionX(listField_[OUT_POS_X][index]);
+	obj->SetPositionY(listField_[OUT_POS_Y][index]);
+
+	++(pattern->frameWork_);
+	++countApplied_;
+	return true;
+}
+
 //****************************************************************************
 //StgMovePattern
 //****************************************************************************
@@ -16,23 +16,233 @@ class StgPackageController;
 class StgStageInformation;
 class StgSystemInformation;
 class StgMovePattern;
+class StgMovePattern_Angle;
+class StgMoveBatch;
+
+//*******************************************************************
+//StgHotDataTable
+//	Contiguous structure-of-arrays copy of the object data that managers query
+//	every frame. Rows are kept in sync by the attached objects themselves.
+//*******************************************************************
+class StgHotDataTable {
+public:
+	enum : uint8_t {
+		FLAG_DELETED = 1 << 0,
+		FLAG_SPELL_RESIST = 1 << 1,
+		FLAG_MOVED = 1 << 2,		//Moved since the last StgHotDataIndex build
+	};
+public:
+	std::vector<double> listPosX;
+	std::vector<double> listPosY;
+	std::vector<int> listObjectID;
+	std::vector<int> listType;		//Shot owner type, item type, etc.
+	std::vector<uint8_t> listFlag;
+
+	size_t countIndexed = 0;			//Rows [0, countIndexed) are covered by the spatial index
+	std::vector<uint32_t> listMovedRow;	//Indexed rows that moved after the build
+public:
+	size_t GetSize() const { return listObjectID.size(); }
+
+	void SetPositionX(size_t index, double pos) {
+		listPosX[index] = pos;
+		_MarkMoved(index);
+	}
+	void SetPositionY(size_t index, double pos) {
+		listPosY[index] = pos;
+		_MarkMoved(index);
+	}
+	void _MarkMoved(size_t index) {
+		if (index < countIndexed && (listFlag[index] & FLAG_MOVED) == 0) {
+			listFlag[index] |= FLAG_MOVED;
+			listMovedRow.push_back(index);
+		}
+	}
+
+	size_t AddRow(double x, double y, int id, int type, uint8_t flag) {
+		listPosX.push_back(x);
+		listPosY.push_back(y);
+		listObjectID.push_back(id);
+		listType.push_back(type);
+		listFlag.push_back(flag);
+		return listObjectID.size() - 1U;
+	}
+	void MoveRow(size_t dst, size_t src) {
+		listPosX[dst] = listPosX[src];
+		listPosY[dst] = listPosY[src];
+		listObjectID[dst] = listObjectID[src];
+		listType[dst] = listType[src];
+		listFlag[dst] = listFlag[src];
+	}
+	void Resize(size_t size) {
+		//Rows may have been shuffled around, the index has to be rebuilt
+		countIndexed = 0;
+		listMovedRow.clear();
+
+		listPosX.resize(size);
+		listPosY.resize(size);
+		listObjectID.resize(size);
+		listType.resize(size);
+		listFlag.resize(size);
+	}
+	void Clear() { Resize(0); }
+
+	void SetFlag(size_t index, uint8_t flag, bool b) {
+		if (b) listFlag[index] |= flag;
+		else listFlag[index] &= ~flag;
+	}
+};
+
+//*******************************************************************
+//StgHotDataIndex
+//	Uniform grid over a StgHotDataTable, rebuilt once per frame.
+//	Rows that move or get added in between are tracked by the table and
+//	always handed out as candidates, so queries never miss anything.
+//*******************************************************************
+class StgHotDataIndex {
+public:
+	enum {
+		CELL_SIZE = 32,
+		CELL_COUNT_MAX = 256,	//Per axis
+	};
+protected:
+	double originX_;
+	double originY_;
+	double cellSizeX_;
+	double cellSizeY_;
+	LONG countX_;
+	LONG countY_;
+
+	std::vector<uint32_t> listCellStart_;		//Offsets into listCellRow_, one extra at the end
+	std::vector<uint32_t> listCellRow_;			//Rows sorted by cell, ascending within a cell
+	std::vector<uint32_t> listRowCell_;
+	std::vector<uint32_t> listUnboundedRow_;	//Rows with non-finite positions
+
+	//Reused candidate lists for ForEachRow, one per nesting level since callbacks may query again
+	std::deque<std::vector<uint32_t>> listScratchRow_;
+	size_t depthScratchRow_;
+
+	void _GetCellRange(const DxRect<double>& rect, LONG* pRes);
+public:
+	StgHotDataIndex();
+
+	//Point-to-segment test for line sweep queries, a zero-length segment is a circle of diameter width
+	static bool IsPointInLine(double px, double py, double x1, double y1, double x2, double y2, double width);
+	static DxRect<double> GetLineBound(double x1, double y1, double x2, double y2, double width);
+
+	void Build(StgHotDataTable* table);
+	void GetCandidateRows(StgHotDataTable* table, const DxRect<double>& rect, std::vector<uint32_t>& res);
+
+	//Calls func(row) for every row that may lie in rect, in ascending row order.
+	//	func is allowed to move, add, or delete rows; rows that move into the region 
+	//	before they would have been visited and rows that get added are still visited,
+	//	matching the behaviour of a plain linear scan.
+	template<class F> void ForEachRow(StgHotDataTable* table, const DxRect<double>& rect, F&& func);
+};
+template<class F> void StgHotDataIndex::ForEachRow(StgHotDataTable* table, const DxRect<double>& rect, F&& func) {
+	if (depthScratchRow_ >= listScratchRow_.size())
+		listScratchRow_.emplace_back();
+	std::vector<uint32_t>& listRow = listScratchRow_[depthScratchRow_];
+
+	struct _ScratchLevel {
+		size_t* pDepth;
+		_ScratchLevel(size_t* p) : pDepth(p) { ++(*pDepth); }
+		~_ScratchLevel() { --(*pDepth); }
+	} scratchLevel(&depthScratchRow_);
+
+	GetCandidateRows(table, rect, listRow);
+
+	const size_t countRowStart = table->GetSize();
+	size_t countMovedSeen = table->listMovedRow.size();
+
+	for (size_t iRow = 0; iRow < listRow.size(); ++iRow) {
+		uint32_t row = listRow[iRow];
+		func(row);
+
+		const std::vector<uint32_t>& listMoved = table->listMovedRow;
+		for (; countMovedSeen < listMoved.size(); ++countMovedSeen) {
+			uint32_t rowMoved = listMoved[countMovedSeen];
+			if (rowMoved <= row) continue;
+
+			auto itrInsert = std::lower_bound(listRow.begin() + (iRow + 1), listRow.end(), rowMoved);
+			if (itrInsert == listRow.end() || *itrInsert != rowMoved)
+				listRow.insert(itrInsert, rowMoved);
+		}
+	}
+	for (size_t row = countRowStart; row < table->GetSize(); ++row)
+		func(row);
+}
+
+//*******************************************************************
+//StgStateDigest
+//	Per-subsystem hashes of the deterministic stage state. Two runs of the
+//	same replay must produce identical digests on every frame.
+//*******************************************************************
+class StgStateDigest {
+public:
+	enum : uint8_t {
+		PART_PLAYER,
+		PART_SHOT,
+		PART_ENEMY,
+		PART_ITEM,
+		PART_RAND,
+		PART_COMMON_DATA,
+
+		PART_COUNT,
+	};
+
+	static constexpr uint64_t HASH_INIT = 0xcbf29ce484222325ui64;
+public:
+	std::array<uint64_t, PART_COUNT> listHash;
+public:
+	StgStateDigest() { listHash.fill(HASH_INIT); }
+
+	static const char* GetPartName(size_t part);
+
+	//FNV-1a
+	static uint64_t Hash(const void* data, size_t size, uint64_t hash);
+	template<typename T> static uint64_t HashValue(const T& val, uint64_t hash) {
+		return Hash(&val, sizeof(T), hash);
+	}
+	static uint64_t HashTable(const StgHotDataTable* table, uint64_t hash);
+	static uint64_t HashScriptValue(const gstd::value& val, uint64_t hash);
+
+	uint64_t GetCombinedHash() const;
+
+	bool operator==(const StgStateDigest& other) const { return listHash == other.listHash; }
+	bool operator!=(const StgStateDigest& other) const { return listHash != other.listHash; }
+};
 
 //*******************************************************************
 //StgMoveObject
 //*******************************************************************
 class StgMoveObject : public StgObjectBase {
 	friend StgMovePattern;
+	friend StgMoveBatch;
+	DECLARE_OBJECT_MIXIN(StgMoveObject, TypeClass::Move, 0);
 protected:
 	double posX_;
 	double posY_;
 
+	StgHotDataTable* pHotTable_;
+	size_t idxHotData_;
+
 	ref_unsync_ptr<StgMovePattern> pattern_;
 
 	bool bEnableMovement_;
 	int frameMove_;
 
+	//Patterns waiting to be attached, sorted by trigger frame; patterns of the same frame keep their insertion order
+	struct ReservedPattern {
+		uint32_t frame;
+		ref_unsync_ptr<StgMovePattern> pattern;
+	};
+
 	uint32_t framePattern_;
-	std::map<uint32_t, std::list<ref_unsync_ptr<StgMovePattern>>> mapPattern_;
+	std::vector<ReservedPattern> listPattern_;
+
+	//Batch holding a precomputed step of this object for the current frame
+	StgMoveBatch* pMoveBatch_;
+	size_t idxMoveBatch_;
 
 	virtual void _Move();
 	void _AttachReservedPattern(ref_unsync_ptr<StgMovePattern> pattern);
@@ -46,9 +256,23 @@ public:
 	bool IsEnableMovement() { return bEnableMovement_; }
 
 	double GetPositionX() { return posX_; }
-	void SetPositionX(double pos) { posX_ = pos; }
+	void SetPositionX(double pos) {
+		posX_ = pos;
+		if (pHotTable_) pHotTable_->SetPositionX(idxHotData_, pos);
+	}
 	double GetPositionY() { return posY_; }
-	void SetPositionY(double pos) { posY_ = pos; }
+	void SetPositionY(double pos) {
+		posY_ = pos;
+		if (pHotTable_) pHotTable_->SetPositionY(idxHotData_, pos);
+	}
+
+	void AttachHotData(StgHotDataTable* table, size_t index) {
+		pHotTable_ = table;
+		idxHotData_ = index;
+	}
+	void DetachHotData() { pHotTable_ = nullptr; }
+	bool IsHotDataAttached() { return pHotTable_ != nullptr; }
+	size_t GetHotDataIndex() { return idxHotData_; }
 
 	double GetSpeed();
 	void SetSpeed(double speed);
@@ -64,9 +288,64 @@ public:
 	}
 	void AddPattern(uint32_t frameDelay, ref_unsync_ptr<StgMovePattern> pattern, bool bForceMap = false);
 
+	//Whether the next pattern step is a plain StgMovePattern_Angle::Move with no pattern switch
+	virtual bool IsSimpleMovement();
+
 	int GetMoveFrame() { return frameMove_; }
 };
 
+//*******************************************************************
+//StgMoveBatch
+//	Steps the StgMovePattern_Angle patterns of many objects together, ahead of the objects' Work.
+//	When an object moves, it takes its precomputed result only if its position and pattern are
+//	still exactly as batched, and otherwise falls back to the per-object Move(). Both paths perform
+//	the same IEEE operations in the same order, so the results are bit-identical.
+//*******************************************************************
+class StgMoveBatch {
+	enum {
+		IN_POS_X,
+		IN_POS_Y,
+		IN_SPEED,
+		IN_ACCEL,
+		IN_SPMAX,
+		IN_AGVEL,
+		IN_AGACC,
+		IN_AGMAX,
+		IN_ANGLE,
+		IN_COS,
+		IN_SIN,
+		COUNT_INPUT,
+
+		OUT_POS_X = COUNT_INPUT,
+		OUT_POS_Y,
+		OUT_SPEED,
+		OUT_AGVEL,
+		OUT_ANGLE,
+		OUT_COS,
+		OUT_SIN,
+		COUNT_FIELD,
+	};
+
+	std::vector<StgMoveObject*> listObject_;
+	std::vector<StgMovePattern_Angle*> listPattern_;
+	std::array<std::vector<double>, COUNT_FIELD> listField_;
+
+	bool bUseFMA_;
+	size_t countApplied_;
+
+	static double _Accelerate(double value, double accel, double max);
+public:
+	StgMoveBatch();
+
+	void Clear();
+	bool Add(StgMoveObject* obj);
+	void Step();
+	bool Apply(size_t index, StgMoveObject* obj);
+
+	size_t GetCount() const { return listObject_.size(); }
+	size_t GetAppliedCount() const { return countApplied_; }
+};
+
 //*******************************************************************
 //StgMovePattern
 //*******************************************************************
@@ -97,7 +376,36 @@ protected:
 	double s_;
 	double angDirection_;
 
-	std::list<std::pair<int8_t, double>> listCommand_;
+	//Applied in order on activation, pattern chains rarely have more than a handful so those are stored inline
+	class CommandList {
+	public:
+		using Command = std::pair<int8_t, double>;
+		static constexpr size_t INLINE_COUNT = 8;
+	private:
+		Command listInline_[INLINE_COUNT];
+		std::vector<Command> listHeap_;
+		size_t count_ = 0;
+	public:
+		size_t size() const { return count_; }
+		void clear() { count_ = 0; listHeap_.clear(); }
+
+		void push_back(const Command& cmd) {
+			if (count_ < INLINE_COUNT)
+				listInline_[count_] = cmd;
+			else {
+				if (count_ == INLINE_COUNT)
+					listHeap_.assign(listInline_, listInline_ + INLINE_COUNT);
+				listHeap_.push_back(cmd);
+			}
+			++count_;
+		}
+
+		Command* begin() { return count_ > INLINE_COUNT ? listHeap_.data() : listInline_; }
+		Command* end() { return begin() + count_; }
+		const Command* begin() const { return count_ > INLINE_COUNT ? listHeap_.data() : listInline_; }
+		const Command* end() const { return begin() + count_; }
+	};
+	CommandList listCommand_;
 
 	StgStageController* _GetStageController() { return target_->GetStageController(); }
 	ref_unsync_ptr<StgMoveObject> _GetMoveObject(int id);
@@ -128,8 +436,10 @@ class StgMovePattern_XY;
 class StgMovePattern_XY_Angle;
 class StgMovePattern_Angle : public StgMovePattern {
 	friend StgMoveObject;
+	friend StgMoveBatch;
 	friend StgMovePattern_XY;
 	friend StgMovePattern_XY_Angle;
+	DECLARE_POOL_ALLOCATOR(StgMovePattern_Angle, "Move");
 public:
 	enum : int8_t {
 		SET_SPEED,
@@ -194,6 +504,7 @@ class StgMovePattern_XY : public StgMovePattern {
 	friend StgMoveObject;
 	friend StgMovePattern_Angle;
 	friend StgMovePattern_XY_Angle;
+	DECLARE_POOL_ALLOCATOR(StgMovePattern_XY, "Move");
 public:
 	enum : int8_t {
 		SET_S_X,
@@ -246,6 +557,7 @@ class StgMovePattern_XY_Angle : public StgMovePattern {
 	friend StgMoveObject;
 	friend StgMovePattern_Angle;
 	friend StgMovePattern_XY;
+	DECLARE_POOL_ALLOCATOR(StgMovePattern_XY_Angle, "Move");
 public:
 	enum : int8_t {
 		SET_S_X,
@@ -15,11 +15,13 @@ ScriptCommonDataManager::~ScriptCommonDataManager() {
 }
 
 void ScriptCommonDataManager::Clear() {
+	mapAtomArea_.clear();
 	mapData_.clear();
 }
 void ScriptCommonDataManager::Erase(const std::string& name) {
 	auto itr = mapData_.find(name);
 	if (itr != mapData_.end()) {
+		mapAtomArea_.clear();
 		itr->second->Clear();
 		mapData_.erase(itr);
 	}
@@ -47,6 +49,8 @@ ScriptCommonDataManager::DataArea* ScriptCommonDataManager::CreateArea(
 	return inserted.get();
 }
 void ScriptCommonDataManager::CopyArea(const std::string& nameDest, const std::string& nameSrc) {
+	mapAtomArea_.clear();
+
 	auto& dataSrc = mapData_[nameSrc];
 	auto dataDest = make_unique<ScriptCommonDataArea>();
 
@@ -62,7 +66,23 @@ ScriptCommonDataManager::DataArea* ScriptCommonDataManager::GetArea(const std::s
 	}
 	return nullptr;
 }
+//Only literal names carry an atom, anything built at runtime is looked up by string
+ScriptCommonDataManager::DataArea* ScriptCommonDataManager::GetArea(const gstd::value& name) {
+	auto id = name.get_string_atom();
+	if (id == script_atom_table::ATOM_NONE)
+		return GetArea(STR_MULTI(name.as_string()));
+
+	auto itrAtom = mapAtomArea_.find(id);
+	if (itrAtom != mapAtomArea_.end())
+		return itrAtom->second;
+
+	DataArea* res = GetArea(STR_MULTI(name.as_string()));
+	if (res)
+		mapAtomArea_[id] = res;
+	return res;
+}
 void ScriptCommonDataManager::SetArea(const std::string& name, DataArea_UPtr&& source) {
+	mapAtomArea_.clear();
 	mapData_[name] = MOVE(source);
 }
 void ScriptCommonDataManager::SetArea(const std::string& name, const DataArea& source) {
@@ -79,9 +99,22 @@ void ScriptCommonDataManager::SetArea(const std::string& name, const DataArea& s
 //****************************************************************************
 ScriptCommonDataArea::ScriptCommonDataArea() : verifHash_(DATA_HASH) {
 }
+ScriptCommonDataArea::ScriptCommonDataArea(const ScriptCommonDataArea& source) : verifHash_(DATA_HASH) {
+	mapValue_ = source.mapValue_;
+}
 ScriptCommonDataArea::~ScriptCommonDataArea() {}
 
+//The atom cache holds iterators into the source's map, so it is never copied
+ScriptCommonDataArea& ScriptCommonDataArea::operator=(const ScriptCommonDataArea& source) {
+	if (this != &source) {
+		mapAtom_.clear();
+		mapValue_ = source.mapValue_;
+	}
+	return *this;
+}
+
 void ScriptCommonDataArea::Clear() {
+	mapAtom_.clear();
 	mapValue_.clear();
 }
 
@@ -101,6 +134,24 @@ value* ScriptCommonDataArea::GetValueRef(MapIter where) {
 		return nullptr;
 	return &where->second;
 }
+value* ScriptCommonDataArea::GetValueRef(const value& key) {
+	return GetValueRef(_FindByAtom(key.get_string_atom(), key));
+}
+
+//Only literal keys carry an atom, anything built at runtime is looked up by string
+ScriptCommonDataArea::MapIter ScriptCommonDataArea::_FindByAtom(script_atom_table::atom id, const value& key) {
+	if (id == script_atom_table::ATOM_NONE)
+		return mapValue_.find(STR_MULTI(key.as_string()));
+
+	auto itrAtom = mapAtom_.find(id);
+	if (itrAtom != mapAtom_.end())
+		return itrAtom->second;
+
+	auto itr = mapValue_.find(STR_MULTI(key.as_string()));
+	if (itr != mapValue_.end())
+		mapAtom_[id] = itr;
+	return itr;
+}
 
 void ScriptCommonDataArea::SetValue(const std::string& name, value v) {
 	mapValue_[name] = v;
@@ -110,16 +161,33 @@ void ScriptCommonDataArea::SetValue(MapIter where, value v) {
 		return;
 	where->second = v;
 }
+void ScriptCommonDataArea::SetValue(const value& key, value v) {
+	auto id = key.get_string_atom();
+
+	auto itr = _FindByAtom(id, key);
+	if (itr == mapValue_.end()) {
+		itr = mapValue_.insert(std::make_pair(STR_MULTI(key.as_string()), value())).first;
+		if (id != script_atom_table::ATOM_NONE)
+			mapAtom_[id] = itr;
+	}
+	itr->second = v;
+}
 
 void ScriptCommonDataArea::DeleteValue(const std::string& name) {
+	mapAtom_.clear();
 	mapValue_.erase(name);
 }
+void ScriptCommonDataArea::DeleteValue(const value& key) {
+	DeleteValue(STR_MULTI(key.as_string()));
+}
 void ScriptCommonDataArea::Copy(ScriptCommonDataArea* source) {
 	// Copy assign
+	mapAtom_.clear();
 	mapValue_ = source->mapValue_;
 }
 
 void ScriptCommonDataArea::ReadRecord(RecordBuffer& record) {
+	mapAtom_.clear();
 	mapValue_.clear();
 
 	for (const std::string& key : record.GetKeyList()) {
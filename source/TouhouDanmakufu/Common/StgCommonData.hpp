@@ -23,24 +23,35 @@ public:
 	using MapIter = decltype(mapValue_)::iterator;
 
 protected:
+	//Entries looked up by script key atoms, dropped whenever an entry is erased
+	std::unordered_map<gstd::script_atom_table::atom, MapIter> mapAtom_;
+
 	gstd::value _ReadRecord(gstd::ByteBuffer& buffer);
 	void _WriteRecord(gstd::ByteBuffer& buffer, const gstd::value& comValue);
 
+	MapIter _FindByAtom(gstd::script_atom_table::atom id, const gstd::value& key);
+
 public:
 	ScriptCommonDataArea();
+	ScriptCommonDataArea(const ScriptCommonDataArea& source);
 	virtual ~ScriptCommonDataArea();
 
+	ScriptCommonDataArea& operator=(const ScriptCommonDataArea& source);
+
 	void Clear();
 
 	optional<MapIter> GetValue(const std::string& name);
 
 	gstd::value* GetValueRef(const std::string& name);
 	gstd::value* GetValueRef(MapIter where);
+	gstd::value* GetValueRef(const gstd::value& key);
 
 	void SetValue(const std::string& name, gstd::value v);
 	void SetValue(MapIter where, gstd::value v);
+	void SetValue(const gstd::value& key, gstd::value v);
 
 	void DeleteValue(const std::string& name);
+	void DeleteValue(const gstd::value& key);
 	void Copy(ScriptCommonDataArea* source);
 
 	auto begin() const { return mapValue_.cbegin(); }
@@ -80,6 +91,9 @@ protected:
 
 	DataArea_Map mapData_;
 	DataArea* defaultArea_;
+
+	//Areas looked up by script name atoms, dropped whenever an area is removed or replaced
+	std::unordered_map<gstd::script_atom_table::atom, DataArea*> mapAtomArea_;
 public:
 	ScriptCommonDataManager();
 	virtual ~ScriptCommonDataManager();
@@ -97,6 +111,7 @@ public:
 	void CopyArea(const std::string& nameDest, const std::string& nameSrc);
 
 	DataArea* GetArea(const std::string& name);
+	DataArea* GetArea(const gstd::value& name);
 	void SetArea(const std::string& name, const DataArea& source);
 	void SetArea(const std::string& name, DataArea_UPtr&& source);
 
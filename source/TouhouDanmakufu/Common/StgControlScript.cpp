@@ -231,7 +231,7 @@ value StgControlScript::Func_SetCommonData(script_machine* machine, int argc, co
 	auto commonDataManager = script->systemController_->GetCommonDataManager();
 
 	auto area = commonDataManager->GetDefaultArea();
-	std::string key = STR_MULTI(argv[0].as_string());
+	const value& key = argv[0];
 
 	area->SetValue(key, argv[1]);
 
@@ -242,7 +242,7 @@ value StgControlScript::Func_GetCommonData(script_machine* machine, int argc, co
 	auto commonDataManager = script->systemController_->GetCommonDataManager();
 
 	auto area = commonDataManager->GetDefaultArea();
-	std::string key = STR_MULTI(argv[0].as_string());
+	const value& key = argv[0];
 
 	value res;
 
@@ -268,7 +268,7 @@ value StgControlScript::Func_DeleteCommonData(script_machine* machine, int argc,
 	auto commonDataManager = script->systemController_->GetCommonDataManager();
 
 	auto area = commonDataManager->GetDefaultArea();
-	std::string key = STR_MULTI(argv[0].as_string());
+	const value& key = argv[0];
 
 	area->DeleteValue(key);
 
@@ -278,8 +278,8 @@ value StgControlScript::Func_SetAreaCommonData(script_machine* machine, int argc
 	StgControlScript* script = rcast(StgControlScript*, machine->data);
 	auto commonDataManager = script->systemController_->GetCommonDataManager();
 
-	std::string area = STR_MULTI(argv[0].as_string());
-	std::string key = STR_MULTI(argv[1].as_string());
+	const value& area = argv[0];
+	const value& key = argv[1];
 
 	if (auto pArea = commonDataManager->GetArea(area)) {
 		pArea->SetValue(key, argv[2]);
@@ -291,8 +291,8 @@ value StgControlScript::Func_GetAreaCommonData(script_machine* machine, int argc
 	StgControlScript* script = rcast(StgControlScript*, machine->data);
 	auto commonDataManager = script->systemController_->GetCommonDataManager();
 
-	std::string area = STR_MULTI(argv[0].as_string());
-	std::string key = STR_MULTI(argv[1].as_string());
+	const value& area = argv[0];
+	const value& key = argv[1];
 
 	value res;
 
@@ -310,7 +310,7 @@ value StgControlScript::Func_ClearAreaCommonData(script_machine* machine, int ar
 	StgControlScript* script = rcast(StgControlScript*, machine->data);
 	auto commonDataManager = script->systemController_->GetCommonDataManager();
 
-	std::string area = STR_MULTI(argv[0].as_string());
+	const value& area = argv[0];
 
 	if (auto pArea = commonDataManager->GetArea(area)) {
 		pArea->Clear();
@@ -322,8 +322,8 @@ value StgControlScript::Func_DeleteAreaCommonData(script_machine* machine, int a
 	StgControlScript* script = rcast(StgControlScript*, machine->data);
 	auto commonDataManager = script->systemController_->GetCommonDataManager();
 
-	std::string area = STR_MULTI(argv[0].as_string());
-	std::string key = STR_MULTI(argv[1].as_string());
+	const value& area = argv[0];
+	const value& key = argv[1];
 
 	if (auto pArea = commonDataManager->GetArea(area)) {
 		pArea->DeleteValue(key);
@@ -408,7 +408,7 @@ value StgControlScript::Func_LoadCommonDataValuePointer(script_machine* machine,
 	auto commonDataManager = script->systemController_->GetCommonDataManager();
 
 	auto area = commonDataManager->GetDefaultArea();
-	std::string key = STR_MULTI(argv[0].as_string());
+	const value& key = argv[0];
 
 	uint64_t res = 0;
 	{
@@ -431,8 +431,8 @@ value StgControlScript::Func_LoadAreaCommonDataValuePointer(script_machine* mach
 	StgControlScript* script = rcast(StgControlScript*, machine->data);
 	auto commonDataManager = script->systemController_->GetCommonDataManager();
 
-	std::string nameArea = STR_MULTI(argv[0].as_string());
-	std::string key = STR_MULTI(argv[1].as_string());
+	const value& nameArea = argv[0];
+	const value& key = argv[1];
 
 	uint64_t res = 0;
 	if (auto area = commonDataManager->GetArea(nameArea)) {
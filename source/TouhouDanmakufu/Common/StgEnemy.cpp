@@ -133,6 +133,10 @@ lab_cancel_all:
 //StgEnemyObject
 //*******************************************************************
 StgEnemyObject::StgEnemyObject(StgStageController* stageController) : StgMoveObject(stageController) {
+	_AddObjectClass<StgEnemyObject>(this);
+	_AddObjectClass<StgMoveObject>(this);
+	_AddObjectClass<StgIntersectionObject>(this);
+	pObjectBase_ = this;
 	typeObject_ = TypeObject::Enemy;
 
 	SetRenderPriorityI(40);
@@ -233,7 +237,7 @@ void StgEnemyObject::Intersect(StgIntersectionTarget* ownTarget, StgIntersection
 	double damage = 0;
 	if (auto ptrObj = otherTarget->GetObject()) {
 		if (otherTarget->GetTargetType() == StgIntersectionTarget::TYPE_PLAYER_SHOT) {
-			if (StgShotObject* shot = dynamic_cast<StgShotObject*>(ptrObj.get())) {
+			if (StgShotObject* shot = ptrObj->GetObjectAs<StgShotObject>()) {
 				if (ref_unsync_weak_ptr<StgEnemyObject> self = ownTarget->GetObject()) {
 					//Register intersection only if the enemy is off hit cooldown
 					if (!shot->CheckEnemyHitCooldownExists(self)) {
@@ -249,7 +253,7 @@ void StgEnemyObject::Intersect(StgIntersectionTarget* ownTarget, StgIntersection
 			}
 		}
 		else if (otherTarget->GetTargetType() == StgIntersectionTarget::TYPE_PLAYER_SPELL) {
-			if (StgPlayerSpellObject* spell = dynamic_cast<StgPlayerSpellObject*>(ptrObj.get()))
+			if (StgPlayerSpellObject* spell = ptrObj->GetObjectAs<StgPlayerSpellObject>())
 				damage = spell->GetDamage() * rateDamageSpell_;
 		}
 	}
@@ -296,6 +300,7 @@ void StgEnemyBossObject::Clone(DxScriptObjectBase* _src) {
 //StgEnemyBossSceneObject
 //*******************************************************************
 StgEnemyBossSceneObject::StgEnemyBossSceneObject(StgStageController* stageController) : StgObjectBase(stageController) {
+	_AddObjectClass<StgEnemyBossSceneObject>(this);
 	typeObject_ = TypeObject::EnemyBossScene;
 
 	bScriptsLoaded_ = false;
@@ -80,6 +80,7 @@ protected:
 	void _DeleteInAutoDeleteFrame();
 	virtual void _Move();
 	virtual void _AddRelativeIntersection();
+	DECLARE_OBJECT_CLASS(StgEnemyObject, TypeClass::Enemy);
 public:
 	StgEnemyObject(StgStageController* stageController);
 	virtual ~StgEnemyObject();
@@ -155,6 +156,7 @@ private:
 
 	void _WaitForStepLoad(int iStep);
 	bool _NextScript();
+	DECLARE_OBJECT_CLASS(StgEnemyBossSceneObject, TypeClass::EnemyBossScene);
 public:
 	StgEnemyBossSceneObject(StgStageController* stageController);
 	~StgEnemyBossSceneObject();
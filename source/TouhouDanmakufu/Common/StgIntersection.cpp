@@ -131,29 +131,31 @@ void StgIntersectionManager::Work() {
 		size_t currentCheck = 0;
 		auto listCheck = space->CreateIntersectionCheckList(this, currentCheck);
 
+		//Narrow-phase, the shape tests are pure and may run in any order
+		_CheckIntersectedPairs(listCheck, currentCheck);
+
+		//Callbacks are applied serially in the check list order to keep things deterministic
 		for (size_t iCheck = 0; iCheck < currentCheck; iCheck++) {
-			auto& cTargetPair = listCheck->at(iCheck);
+			if ((listHitBitmap_[iCheck >> 5] & (1U << (iCheck & 31))) == 0) continue;
 
+			auto& cTargetPair = listCheck->at(iCheck);
 			StgIntersectionTarget* targetA = cTargetPair.first;
 			StgIntersectionTarget* targetB = cTargetPair.second;
-			if (targetA == nullptr || targetB == nullptr) continue;
 
-			if (IsIntersected(targetA, targetB)) {
-				ref_unsync_weak_ptr<StgIntersectionObject>& ptrA = targetA->GetObject();
-				ref_unsync_weak_ptr<StgIntersectionObject>& ptrB = targetB->GetObject();
-				{
-					if (ptrA) {
-						ptrA->Intersect(targetA, targetB);
-						ptrA->SetIntersected();
-						if (ptrB)
-							ptrA->AddIntersectedId(ptrB);
-					}
-					if (ptrB) {
-						ptrB->Intersect(targetB, targetA);
-						ptrB->SetIntersected();
-						if (ptrA)
-							ptrB->AddIntersectedId(ptrA);
-					}
+			ref_unsync_weak_ptr<StgIntersectionObject>& ptrA = targetA->GetObject();
+			ref_unsync_weak_ptr<StgIntersectionObject>& ptrB = targetB->GetObject();
+			{
+				if (ptrA) {
+					ptrA->Intersect(targetA, targetB);
+					ptrA->SetIntersected();
+					if (ptrB)
+						ptrA->AddIntersectedId(ptrB);
+				}
+				if (ptrB) {
+					ptrB->Intersect(targetB, targetA);
+					ptrB->SetIntersected();
+					if (ptrA)
+						ptrB->AddIntersectedId(ptrA);
 				}
 			}
 		}
@@ -287,6 +289,33 @@ void StgIntersectionManager::AddEnemyTargetToPlayer(ref_unsync_ptr<StgIntersecti
 	}
 }
 
+void StgIntersectionManager::_CheckIntersectedPairs(std::vector<StgIntersectionSpace::TargetCheckListPair>* listCheck,
+	size_t count)
+{
+	//One bit per pair; each word is owned by exactly one range, so the writes never race
+	size_t countWord = (count + 31U) / 32U;
+	if (listHitBitmap_.size() < countWord)
+		listHitBitmap_.resize(countWord);
+
+	size_t countCore = JobSystem::GetBase()->GetThreadCount();
+	size_t countRange = countWord >= countCore * 4 ? countCore : 1U;
+
+	ParallelForRange(countWord, countRange, [&](size_t iRange, size_t begin, size_t end) {
+		for (size_t iWord = begin; iWord < end; ++iWord) {
+			uint32_t word = 0;
+
+			size_t iCheckBegin = iWord * 32U;
+			size_t iCheckEnd = std::min(iCheckBegin + 32U, count);
+			for (size_t iCheck = iCheckBegin; iCheck < iCheckEnd; ++iCheck) {
+				auto& cTargetPair = listCheck->at(iCheck);
+				if (IsIntersected(cTargetPair.first, cTargetPair.second))
+					word |= 1U << (iCheck & 31);
+			}
+
+			listHitBitmap_[iWord] = word;
+		}
+	});
+}
 bool StgIntersectionManager::IsIntersected(StgIntersectionTarget* p1, StgIntersectionTarget* p2) {
 	if (p1 != nullptr && p2 != nullptr) {
 		StgIntersectionTarget::Shape shape1 = p1->GetShape();
@@ -327,6 +356,13 @@ lab_fail:
 void StgIntersectionManager::AddVisualization(ref_unsync_ptr<StgIntersectionTarget>& target) {
 	if (!bRenderIntersection_ || target == nullptr) return;
 
+	if (target->GetShape() == StgIntersectionTarget::SHAPE_CHAIN) {
+		StgIntersectionTarget_Chain* pChain = (StgIntersectionTarget_Chain*)target.get();
+		for (auto& iTarget : pChain->GetTargetList())
+			AddVisualization(iTarget);
+		return;
+	}
+
 	ParticleRenderer2D* objParticleCircle = objIntersectionVisualizerCircle_->GetParticlePointer();
 	RenderObjectTLX* objParticleLine = objIntersectionVisualizerLine_->GetRenderObject();
 
@@ -444,16 +480,34 @@ ref_unsync_ptr<StgIntersectionTarget> StgIntersectionCheckList::GetTargetB(size_
 StgIntersectionSpace::StgIntersectionSpace() {
 	spaceRect_ = DxRect<double>(0, 0, 0, 0);
 	previousCheckCreated_ = 0;
+
+	gridCellSize_ = 64;
+	gridOriginX_ = 0;
+	gridOriginY_ = 0;
+	gridCountX_ = 0;
+	gridCountY_ = 0;
 }
 StgIntersectionSpace::~StgIntersectionSpace() {
 }
 bool StgIntersectionSpace::Initialize(double left, double top, double right, double bottom) {
 	spaceRect_ = DxRect<double>(left, top, right, bottom);
 	pooledCheckList_.resize(64U);
+
+	gridOriginX_ = (LONG)floor(left);
+	gridOriginY_ = (LONG)floor(top);
+	gridCountX_ = std::max<LONG>((LONG)ceil((right - left) / gridCellSize_), 1);
+	gridCountY_ = std::max<LONG>((LONG)ceil((bottom - top) / gridCellSize_), 1);
+	listGridCell_.resize(gridCountX_ * gridCountY_);
+
 	return true;
 }
 bool StgIntersectionSpace::RegistTarget(ListTarget* pVec, ref_unsync_ptr<StgIntersectionTarget>& target) {
-	if (!spaceRect_.IsIntersected(target->GetIntersectionSpaceRect()))
+	if (target->GetShape() == StgIntersectionTarget::SHAPE_CHAIN) {
+		//Leaves are clipped as if they were separate targets, in place, as every space shares the same rect
+		if (!((StgIntersectionTarget_Chain*)target.get())->ClipTarget(spaceRect_))
+			return false;
+	}
+	else if (!spaceRect_.IsIntersected(target->GetIntersectionSpaceRect()))
 		return false;
 	pVec->push_back(target);
 	return true;
@@ -466,6 +520,63 @@ void StgIntersectionSpace::ClearTarget() {
 		pooledCheckList_[i].first = nullptr;
 		pooledCheckList_[i].second = nullptr;
 	}
+	for (auto& iCell : listGridCell_)
+		iCell.clear();
+	for (auto& iChunk : listCheckChunk_)
+		iChunk.listPair.clear();
+}
+
+//Writes the inclusive cell range [x1, y1, x2, y2] covered by the rect
+//	Clamping is monotonic, so any two rects that pass DxRect::IsIntersected are guaranteed to share a cell
+void StgIntersectionSpace::_GetGridRange(const DxRect<LONG>& rect, LONG* pRes) {
+	auto _ToCell = [&](LONG pos, LONG origin, LONG count) -> LONG {
+		int64_t cell = ((int64_t)pos - origin) / gridCellSize_;
+		return (LONG)std::clamp<int64_t>(cell, 0, count - 1);
+	};
+	pRes[0] = _ToCell(std::min(rect.left, rect.right), gridOriginX_, gridCountX_);
+	pRes[1] = _ToCell(std::min(rect.top, rect.bottom), gridOriginY_, gridCountY_);
+	pRes[2] = _ToCell(std::max(rect.left, rect.right), gridOriginX_, gridCountX_);
+	pRes[3] = _ToCell(std::max(rect.top, rect.bottom), gridOriginY_, gridCountY_);
+}
+void StgIntersectionSpace::_AddGridTarget(const DxRect<LONG>& rect, uint32_t index) {
+	LONG range[4];
+	_GetGridRange(rect, range);
+	for (LONG iy = range[1]; iy <= range[3]; ++iy) {
+		std::vector<uint32_t>* pRow = &listGridCell_[iy * gridCountX_];
+		for (LONG ix = range[0]; ix <= range[2]; ++ix) {
+			//Targets are added in order, so the leaves of a chain sharing a cell are all at its back
+			std::vector<uint32_t>& cell = pRow[ix];
+			if (cell.empty() || cell.back() != index)
+				cell.push_back(index);
+		}
+	}
+}
+//Returns true if the candidates may hold duplicates
+bool StgIntersectionSpace::_GatherGridCandidate(const DxRect<LONG>& rect, std::vector<uint32_t>& listCandidate) {
+	LONG range[4];
+	_GetGridRange(rect, range);
+	for (LONG iy = range[1]; iy <= range[3]; ++iy) {
+		std::vector<uint32_t>* pRow = &listGridCell_[iy * gridCountX_];
+		for (LONG ix = range[0]; ix <= range[2]; ++ix)
+			listCandidate.insert(listCandidate.end(), pRow[ix].begin(), pRow[ix].end());
+	}
+	return range[0] != range[2] || range[1] != range[3];
+}
+void StgIntersectionSpace::_BuildGrid(ListTarget* pListTarget) {
+	for (size_t iTarget = 0; iTarget < pListTarget->size(); ++iTarget) {
+		StgIntersectionTarget* pTarget = pListTarget->at(iTarget).get();
+		if (pTarget == nullptr) continue;
+
+		//Chains are binned leaf by leaf, their root bound may cover most of the grid
+		if (pTarget->GetShape() == StgIntersectionTarget::SHAPE_CHAIN) {
+			StgIntersectionTarget_Chain* pChain = (StgIntersectionTarget_Chain*)pTarget;
+			for (size_t iLeaf = 0; iLeaf < pChain->GetTargetCount(); ++iLeaf)
+				_AddGridTarget(pChain->GetTarget(iLeaf)->GetIntersectionSpaceRect(), (uint32_t)iTarget);
+		}
+		else {
+			_AddGridTarget(pTarget->GetIntersectionSpaceRect(), (uint32_t)iTarget);
+		}
+	}
 }
 
 std::vector<StgIntersectionSpace::TargetCheckListPair>* StgIntersectionSpace::CreateIntersectionCheckList(
@@ -474,18 +585,9 @@ std::vector<StgIntersectionSpace::TargetCheckListPair>* StgIntersectionSpace::Cr
 	ListTarget* pListTargetA = &pairTargetList_.first;
 	ListTarget* pListTargetB = &pairTargetList_.second;
 
-	CriticalSection& criticalSection = manager->GetLock();
-	std::atomic_uint count = 0;
+	size_t count = 0;
 
 	if (manager->IsEnableVisualizer()) {
-		/*
-		ParallelFor(pListTargetA->size(), [&](size_t i) {
-			manager->AddVisualization(pListTargetA->at(i));
-		});
-		ParallelFor(pListTargetB->size(), [&](size_t i) {
-			manager->AddVisualization(pListTargetB->at(i));
-		});
-		*/
 		for (auto& pTarget : *pListTargetA)
 			manager->AddVisualization(pTarget);
 		for (auto& pTarget : *pListTargetB)
@@ -493,62 +595,138 @@ std::vector<StgIntersectionSpace::TargetCheckListPair>* StgIntersectionSpace::Cr
 	}
 
 	if (pListTargetA->size() > 0 && pListTargetB->size() > 0) {
-		auto CheckSpaceRect = [&](StgIntersectionTarget* targetA, StgIntersectionTarget* targetB) {
-			if (targetA == nullptr || targetB == nullptr) return;
-			const DxRect<LONG>& boundA = targetA->GetIntersectionSpaceRect();
-			const DxRect<LONG>& boundB = targetB->GetIntersectionSpaceRect();
-			if (boundA.IsIntersected(boundB)) {
-				Lock lock(criticalSection);
-				if ((size_t)count >= pooledCheckList_.size()) {
-					pooledCheckList_.resize(pooledCheckList_.size() * 2);
+		//Broad-phase:
+		//	List B is binned into the uniform grid, then every target in list A gathers the B targets
+		//	sharing its cells. Each chunk of A writes to its own buffer, so no locking is needed.
+		//	Candidates are sorted per A target, so the final pair order is identical to
+		//	a serial A-major, B-minor nested loop regardless of the thread count.
+		_BuildGrid(pListTargetB);
+
+		size_t countCore = JobSystem::GetBase()->GetThreadCount();
+		size_t countChunk = pListTargetA->size() >= countCore * 8 ? countCore : 1U;
+		if (listCheckChunk_.size() < countChunk)
+			listCheckChunk_.resize(countChunk);
+
+		ParallelForRange(pListTargetA->size(), countChunk, [&](size_t iChunk, size_t begin, size_t end) {
+			CheckChunk& chunk = listCheckChunk_[iChunk];
+			std::vector<uint32_t>& listCandidate = chunk.listCandidate;
+
+			for (size_t iA = begin; iA < end; ++iA) {
+				StgIntersectionTarget* pTargetA = pListTargetA->at(iA).get();
+				if (pTargetA == nullptr) continue;
+				const DxRect<LONG>& boundA = pTargetA->GetIntersectionSpaceRect();
+
+				listCandidate.clear();
+				bool bDuplicate = false;
+				if (pTargetA->GetShape() == StgIntersectionTarget::SHAPE_CHAIN) {
+					StgIntersectionTarget_Chain* pChainA = (StgIntersectionTarget_Chain*)pTargetA;
+					for (size_t iLeaf = 0; iLeaf < pChainA->GetTargetCount(); ++iLeaf)
+						_GatherGridCandidate(pChainA->GetTarget(iLeaf)->GetIntersectionSpaceRect(), listCandidate);
+					bDuplicate = pChainA->GetTargetCount() > 1;
 				}
-				pooledCheckList_[count.load()] = std::make_pair(targetA, targetB);
-				++count;
-			}
-		};
+				else {
+					bDuplicate = _GatherGridCandidate(boundA, listCandidate);
+				}
+				if (listCandidate.empty()) continue;
 
-		//Attempt to most efficiently utilize multithreading
-		if (pListTargetA->size() >= pListTargetB->size()) {
-			ParallelFor(pListTargetA->size(), [&](size_t iA) {
-				StgIntersectionTarget* pTargetA = pListTargetA->at(iA).get();
-				for (auto itrB = pListTargetB->begin(); itrB != pListTargetB->end(); ++itrB) {
-					StgIntersectionTarget* pTargetB = itrB->get();
-					CheckSpaceRect(pTargetA, pTargetB);
+				//Targets spanning several cells are registered more than once
+				if (bDuplicate) {
+					std::sort(listCandidate.begin(), listCandidate.end());
+					listCandidate.erase(std::unique(listCandidate.begin(), listCandidate.end()), listCandidate.end());
 				}
-			});
-		}
-		else {
-			ParallelFor(pListTargetB->size(), [&](size_t iB) {
-				StgIntersectionTarget* pTargetB = pListTargetB->at(iB).get();
-				for (auto itrA = pListTargetA->begin(); itrA != pListTargetA->end(); ++itrA) {
-					StgIntersectionTarget* pTargetA = itrA->get();
-					CheckSpaceRect(pTargetA, pTargetB);
+
+				if (pTargetA->GetShape() == StgIntersectionTarget::SHAPE_CHAIN) {
+					_AddChainCheckPair(chunk, (StgIntersectionTarget_Chain*)pTargetA);
+					continue;
+				}
+
+				for (uint32_t iB : listCandidate) {
+					StgIntersectionTarget* pTargetB = pListTargetB->at(iB).get();
+					if (boundA.IsIntersected(pTargetB->GetIntersectionSpaceRect()))
+						_AddCheckPair(chunk, pTargetA, pTargetB);
 				}
-			});
-		}
-		/*
-		//No multithreading mode
-		for (auto itrA = pListTargetA->begin(); itrA != pListTargetA->end(); ++itrA) {
-			StgIntersectionTarget* pTargetA = itrA->get();
-			for (auto itrB = pListTargetB->begin(); itrB != pListTargetB->end(); ++itrB) {
-				StgIntersectionTarget* pTargetB = itrB->get();
-				CheckSpaceRect(pTargetA, pTargetB);
 			}
+		});
+
+		//Merge the chunk buffers in range order
+		for (size_t iChunk = 0; iChunk < countChunk; ++iChunk)
+			count += listCheckChunk_[iChunk].listPair.size();
+		if (count > pooledCheckList_.size())
+			pooledCheckList_.resize(Math::GetNextPow2(count));
+
+		auto itrDst = pooledCheckList_.begin();
+		for (size_t iChunk = 0; iChunk < countChunk; ++iChunk) {
+			auto& listPair = listCheckChunk_[iChunk].listPair;
+			itrDst = std::copy(listPair.begin(), listPair.end(), itrDst);
 		}
-		*/
 	}
 
-	total = (size_t)count;
+	total = count;
 	previousCheckCreated_ = total;
 	return &pooledCheckList_;
 }
 
+//Chains are expanded into their overlapping leaves in leaf order, which is the same
+//	pair order as if every leaf had been registered as a separate target
+void StgIntersectionSpace::_AddCheckPair(CheckChunk& chunk, StgIntersectionTarget* pTargetA, StgIntersectionTarget* pTargetB) {
+	if (pTargetB->GetShape() != StgIntersectionTarget::SHAPE_CHAIN) {
+		chunk.listPair.push_back(std::make_pair(pTargetA, pTargetB));
+		return;
+	}
+
+	StgIntersectionTarget_Chain* pChainB = (StgIntersectionTarget_Chain*)pTargetB;
+	chunk.listLeafB.clear();
+	pChainB->QueryTarget(pTargetA->GetIntersectionSpaceRect(), &chunk.listLeafB);
+	for (uint32_t iLeafB : chunk.listLeafB)
+		chunk.listPair.push_back(std::make_pair(pTargetA, pChainB->GetTarget(iLeafB)));
+}
+void StgIntersectionSpace::_AddChainCheckPair(CheckChunk& chunk, StgIntersectionTarget_Chain* pChainA) {
+	ListTarget* pListTargetB = &pairTargetList_.second;
+	const DxRect<LONG>& boundA = pChainA->GetIntersectionSpaceRect();
+
+	auto& listChainPair = chunk.listChainPair;
+	listChainPair.clear();
+
+	for (uint32_t iB : chunk.listCandidate) {
+		StgIntersectionTarget* pTargetB = pListTargetB->at(iB).get();
+		const DxRect<LONG>& boundB = pTargetB->GetIntersectionSpaceRect();
+		if (!boundA.IsIntersected(boundB)) continue;
+
+		chunk.listLeafA.clear();
+		pChainA->QueryTarget(boundB, &chunk.listLeafA);
+
+		if (pTargetB->GetShape() == StgIntersectionTarget::SHAPE_CHAIN) {
+			StgIntersectionTarget_Chain* pChainB = (StgIntersectionTarget_Chain*)pTargetB;
+			for (uint32_t iLeafA : chunk.listLeafA) {
+				chunk.listLeafB.clear();
+				pChainB->QueryTarget(pChainA->GetTarget(iLeafA)->GetIntersectionSpaceRect(), &chunk.listLeafB);
+				for (uint32_t iLeafB : chunk.listLeafB)
+					listChainPair.push_back({ iLeafA, iB, iLeafB });
+			}
+		}
+		else {
+			for (uint32_t iLeafA : chunk.listLeafA)
+				listChainPair.push_back({ iLeafA, iB, 0U });
+		}
+	}
+
+	//Candidates are visited B-major, restore the A-major order
+	std::sort(listChainPair.begin(), listChainPair.end());
+	for (auto& [iLeafA, iB, iLeafB] : listChainPair) {
+		StgIntersectionTarget* pTargetB = pListTargetB->at(iB).get();
+		if (pTargetB->GetShape() == StgIntersectionTarget::SHAPE_CHAIN)
+			pTargetB = ((StgIntersectionTarget_Chain*)pTargetB)->GetTarget(iLeafB);
+		chunk.listPair.push_back(std::make_pair(pChainA->GetTarget(iLeafA), pTargetB));
+	}
+}
+
 //*******************************************************************
 //StgIntersectionObject
 //*******************************************************************
 StgIntersectionObject::StgIntersectionObject() {
 	bIntersected_ = false;
 	intersectedCount_ = 0;
+	pObjectBase_ = nullptr;
 }
 void StgIntersectionObject::Copy(StgIntersectionObject* src) {
 	bIntersected_ = src->bIntersected_;
@@ -619,8 +797,7 @@ void StgIntersectionObject::RegistIntersectionRelativeTarget(StgIntersectionMana
 }
 int StgIntersectionObject::GetDxScriptObjectID() {
 	int res = DxScript::ID_INVALID;
-	DxScriptObjectBase* objBase = dynamic_cast<DxScriptObjectBase*>(this);
-	if (objBase) res = objBase->GetObjectID();
+	if (pObjectBase_) res = pObjectBase_->GetObjectID();
 	return res;
 }
 
@@ -647,6 +824,7 @@ std::wstring StgIntersectionTarget::GetInfoAsString() {
 	switch (shape_) {
 	case SHAPE_CIRCLE:res += L"CIRCLE"; break;
 	case SHAPE_LINE:res += L"LINE"; break;
+	case SHAPE_CHAIN:res += L"CHAIN"; break;
 	}
 	res += L"] ";
 
@@ -674,4 +852,59 @@ std::wstring StgIntersectionTarget::GetInfoAsString() {
 	res += L"] ";
 
 	return res;
-}
\ No newline at end of file
+}
+//*******************************************************************
+//StgIntersectionTarget_Chain
+//*******************************************************************
+void StgIntersectionTarget_Chain::SetIntersectionSpace() {
+	//Padding leaves get an inverted rect, which never intersects anything and vanishes in unions
+	static const DxRect<LONG> rcEmpty(LONG_MAX, LONG_MAX, LONG_MIN, LONG_MIN);
+
+	size_t countTarget = listTarget_.size();
+	countLeafNode_ = Math::GetNextPow2<size_t>(std::max<size_t>(countTarget, 1U));
+
+	listNodeBound_.resize(countLeafNode_ * 2U);
+	for (size_t i = 0; i < countLeafNode_; ++i) {
+		listNodeBound_[countLeafNode_ + i] = i < countTarget ? 
+			listTarget_[i]->GetIntersectionSpaceRect() : rcEmpty;
+	}
+	for (size_t i = countLeafNode_ - 1U; i > 0; --i) {
+		const DxRect<LONG>& rcL = listNodeBound_[i * 2U];
+		const DxRect<LONG>& rcR = listNodeBound_[i * 2U + 1U];
+		listNodeBound_[i] = DxRect<LONG>(std::min(rcL.left, rcR.left), std::min(rcL.top, rcR.top),
+			std::max(rcL.right, rcR.right), std::max(rcL.bottom, rcR.bottom));
+	}
+
+	StgIntersectionTarget::SetIntersectionSpace(listNodeBound_[1]);
+}
+bool StgIntersectionTarget_Chain::ClipTarget(const DxRect<double>& rect) {
+	auto itrEnd = std::remove_if(listTarget_.begin(), listTarget_.end(),
+		[&](ref_unsync_ptr<StgIntersectionTarget>& target) {
+			return !rect.IsIntersected(target->GetIntersectionSpaceRect());
+		});
+	if (itrEnd != listTarget_.end()) {
+		listTarget_.erase(itrEnd, listTarget_.end());
+		SetIntersectionSpace();
+	}
+	return !listTarget_.empty();
+}
+void StgIntersectionTarget_Chain::QueryTarget(const DxRect<LONG>& rect, std::vector<uint32_t>* listRes) const {
+	if (listTarget_.empty()) return;
+
+	//Depth-first, left child first, so leaves come out in ascending order
+	size_t stack[64];
+	size_t countStack = 0;
+	stack[countStack++] = 1U;
+	while (countStack > 0) {
+		size_t iNode = stack[--countStack];
+		if (!listNodeBound_[iNode].IsIntersected(rect)) continue;
+
+		if (iNode >= countLeafNode_) {
+			listRes->push_back((uint32_t)(iNode - countLeafNode_));
+		}
+		else {
+			stack[countStack++] = iNode * 2U + 1U;
+			stack[countStack++] = iNode * 2U;
+		}
+	}
+}
@@ -19,6 +19,7 @@ public:
 	typedef enum : uint8_t {
 		SHAPE_CIRCLE = 0,
 		SHAPE_LINE = 1,
+		SHAPE_CHAIN = 2,
 	} Shape;
 	typedef enum : uint8_t {
 		TYPE_PLAYER,
@@ -62,6 +63,7 @@ public:
 class StgIntersectionTarget_Circle : public StgIntersectionTarget {
 	friend StgIntersectionManager;
 	DxCircle circle_;
+	DECLARE_POOL_ALLOCATOR(StgIntersectionTarget_Circle, "Target");
 public:
 	StgIntersectionTarget_Circle() { shape_ = Shape::SHAPE_CIRCLE; }
 	virtual ~StgIntersectionTarget_Circle() {}
@@ -80,6 +82,7 @@ public:
 class StgIntersectionTarget_Line : public StgIntersectionTarget {
 	friend StgIntersectionManager;
 	DxWidthLine line_;
+	DECLARE_POOL_ALLOCATOR(StgIntersectionTarget_Line, "Target");
 public:
 	StgIntersectionTarget_Line() { shape_ = Shape::SHAPE_LINE; }
 	virtual ~StgIntersectionTarget_Line() {}
@@ -95,6 +98,37 @@ public:
 	}
 };
 
+//A run of consecutive segment targets of one object, such as the body of a curvy laser
+//	The targets are leaves of an implicit bounding tree, the broad-phase only tests
+//	the root bound and descends into the leaves when it overlaps.
+//	Chains are never passed to the narrow-phase, only their leaves are.
+class StgIntersectionTarget_Chain : public StgIntersectionTarget {
+	friend StgIntersectionManager;
+	std::vector<ref_unsync_ptr<StgIntersectionTarget>> listTarget_;
+
+	//Node i has children 2i and 2i+1, leaf j is node (countLeafNode_ + j), node 0 is unused
+	std::vector<DxRect<LONG>> listNodeBound_;
+	size_t countLeafNode_;
+public:
+	StgIntersectionTarget_Chain() { shape_ = Shape::SHAPE_CHAIN; countLeafNode_ = 0; }
+	virtual ~StgIntersectionTarget_Chain() {}
+
+	//Builds the bounding tree, call after all the leaves are added
+	virtual void SetIntersectionSpace();
+
+	void ClearTarget() { listTarget_.clear(); }
+	void AddTarget(ref_unsync_ptr<StgIntersectionTarget>& target) { listTarget_.push_back(target); }
+	size_t GetTargetCount() const { return listTarget_.size(); }
+	StgIntersectionTarget* GetTarget(size_t index) const { return listTarget_[index].get(); }
+	std::vector<ref_unsync_ptr<StgIntersectionTarget>>& GetTargetList() { return listTarget_; }
+
+	//Drops the leaves outside the rect, keeping their order. Returns false if none are left
+	bool ClipTarget(const DxRect<double>& rect);
+
+	//Appends the indices of the leaves whose bounds overlap the rect, in ascending order
+	void QueryTarget(const DxRect<LONG>& rect, std::vector<uint32_t>* listRes) const;
+};
+
 class StgIntersectionTargetPoint;
 
 //*******************************************************************
@@ -122,7 +156,12 @@ private:
 	shared_ptr<Shader> shaderVisualizerCircle_;
 	shared_ptr<Shader> shaderVisualizerLine_;
 
+	//Narrow-phase results, bit i is set if pair i of the current check list intersects
+	std::vector<uint32_t> listHitBitmap_;
+
 	CriticalSection lock_;
+
+	void _CheckIntersectedPairs(std::vector<std::pair<StgIntersectionTarget*, StgIntersectionTarget*>>* listCheck, size_t count);
 public:
 	StgIntersectionManager();
 	virtual ~StgIntersectionManager();
@@ -172,12 +211,38 @@ class StgIntersectionSpace {
 public:
 	typedef std::vector<ref_unsync_ptr<StgIntersectionTarget>> ListTarget;
 	typedef std::pair<StgIntersectionTarget*, StgIntersectionTarget*> TargetCheckListPair;
+protected:
+	//Broad-phase work buffer of a contiguous range of list A
+	struct CheckChunk {
+		std::vector<uint32_t> listCandidate;
+		std::vector<uint32_t> listLeafA;
+		std::vector<uint32_t> listLeafB;
+		//[leaf of A, index of B, leaf of B], sorted to restore the A-major order of chain pairs
+		std::vector<std::array<uint32_t, 3>> listChainPair;
+		std::vector<TargetCheckListPair> listPair;
+	};
 protected:
 	DxRect<double> spaceRect_;
 
+	//Uniform grid over spaceRect_, holds the indices of list B's targets overlapping each cell
+	LONG gridCellSize_;
+	LONG gridOriginX_;
+	LONG gridOriginY_;
+	LONG gridCountX_;
+	LONG gridCountY_;
+	std::vector<std::vector<uint32_t>> listGridCell_;
+
 	size_t previousCheckCreated_;
 	std::pair<ListTarget, ListTarget> pairTargetList_;
+	std::vector<CheckChunk> listCheckChunk_;
 	std::vector<TargetCheckListPair> pooledCheckList_;
+
+	inline void _GetGridRange(const DxRect<LONG>& rect, LONG* pRes);
+	void _AddGridTarget(const DxRect<LONG>& rect, uint32_t index);
+	bool _GatherGridCandidate(const DxRect<LONG>& rect, std::vector<uint32_t>& listCandidate);
+	void _BuildGrid(ListTarget* pListTarget);
+	void _AddCheckPair(CheckChunk& chunk, StgIntersectionTarget* pTargetA, StgIntersectionTarget* pTargetB);
+	void _AddChainCheckPair(CheckChunk& chunk, StgIntersectionTarget_Chain* pChainA);
 public:
 	StgIntersectionSpace();
 	virtual ~StgIntersectionSpace();
@@ -193,6 +258,7 @@ public:
 };
 
 class StgIntersectionObject {
+	DECLARE_OBJECT_MIXIN(StgIntersectionObject, TypeClass::Intersection, 1);
 public:
 	using IntersectionPairType = std::pair<bool, ref_unsync_ptr<StgIntersectionTarget>>;
 	using IntersectionListType = std::vector<IntersectionPairType>;
@@ -211,6 +277,9 @@ protected:
 	std::vector<ref_unsync_weak_ptr<StgIntersectionObject>> listIntersectedID_;
 
 	std::vector<IntersectionRelativeTarget> listRelativeTarget_;
+
+	//Set by the script object class inheriting this one
+	DxScriptObjectBase* pObjectBase_;
 public:
 	StgIntersectionObject();
 	virtual ~StgIntersectionObject() {}
@@ -238,6 +307,8 @@ public:
 	size_t GetIntersectionRelativeTargetCount() { return listRelativeTarget_.size(); }
 
 	int GetDxScriptObjectID();
+	DxScriptObjectBase* GetObjectBase() { return pObjectBase_; }
+	template<class T> T* GetObjectAs() { return pObjectBase_ ? pObjectBase_->As<T>() : nullptr; }
 
 	virtual IntersectionListType GetIntersectionTargetList() {
 		return IntersectionListType();
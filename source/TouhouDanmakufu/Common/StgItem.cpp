@@ -56,22 +56,31 @@ StgItemManager::StgItemManager(StgStageController* stageController) {
 	pLastTexture_ = nullptr;
 }
 StgItemManager::~StgItemManager() {
+	for (ref_unsync_ptr<StgItemObject>& obj : listObj_) {
+		if (obj)
+			obj->DetachHotData();
+	}
 }
 void StgItemManager::Work() {
 	ref_unsync_ptr<StgPlayerObject> objPlayer = stageController_->GetPlayerObject();
-	if (objPlayer == nullptr) return;
+	if (objPlayer == nullptr) {
+		hotIndex_.Build(&hotData_);
+		return;
+	}
 
 	float px = objPlayer->GetX();
 	float py = objPlayer->GetY();
 	int pr = objPlayer->GetItemIntersectionRadius() * objPlayer->GetItemIntersectionRadius();
 	int pAutoItemCollectY = objPlayer->GetAutoItemCollectY();
 
-	for (auto itr = listObj_.begin(); itr != listObj_.end();) {
-		ref_unsync_ptr<StgItemObject>& obj = *itr;
+	//Item events may register new items, which get processed in this same pass
+	std::vector<size_t> listErase;
+	for (size_t iItem = 0; iItem < listObj_.size(); ++iItem) {
+		ref_unsync_ptr<StgItemObject> obj = listObj_[iItem];
 
 		if (obj->IsDeleted()) {
 			//obj->Clear();
-			itr = listObj_.erase(itr);
+			listErase.push_back(iItem);
 		}
 		else {
 			float ix = obj->GetPositionX();
@@ -145,9 +154,30 @@ lab_move_to_player:
 			}
 
 lab_next_item:
-			++itr;
+			;
+		}
+	}
+
+	//Stable compaction of listObj_ and its hot data rows
+	if (listErase.size() > 0) {
+		size_t iWrite = listErase[0];
+		for (size_t iRead = iWrite, iNextErase = 0; iRead < listObj_.size(); ++iRead) {
+			ref_unsync_ptr<StgItemObject>& obj = listObj_[iRead];
+			if (iNextErase < listErase.size() && listErase[iNextErase] == iRead) {
+				obj->DetachHotData();
+				++iNextErase;
+				continue;
+			}
+
+			listObj_[iWrite] = obj;
+			hotData_.MoveRow(iWrite, iRead);
+			obj->AttachHotData(&hotData_, iWrite);
+			++iWrite;
 		}
+		listObj_.resize(iWrite);
+		hotData_.Resize(iWrite);
 	}
+	hotIndex_.Build(&hotData_);
 
 	listCircleToPlayer_.clear();
 
@@ -254,6 +284,16 @@ void StgItemManager::LoadRenderQueue() {
 bool StgItemManager::LoadItemData(const std::wstring& path, bool bReload) {
 	return listItemData_->AddItemDataList(path, bReload);
 }
+void StgItemManager::AddItem(ref_unsync_ptr<StgItemObject> obj) {
+	if (obj->IsHotDataAttached()) return;	//Already registered
+
+	listObj_.push_back(obj);
+
+	uint8_t flag = obj->IsDeleted() ? StgHotDataTable::FLAG_DELETED : 0;
+	size_t index = hotData_.AddRow(obj->GetPositionX(), obj->GetPositionY(),
+		obj->GetObjectID(), obj->GetItemType(), flag);
+	obj->AttachHotData(&hotData_, index);
+}
 ref_unsync_ptr<StgItemObject> StgItemManager::CreateItem(int type) {
 	ref_unsync_ptr<StgItemObject> res;
 	switch (type) {
@@ -291,22 +331,51 @@ void StgItemManager::CancelCollectItems() {
 	bCancelToPlayer_ = true;
 }
 
-std::vector<int> StgItemManager::GetItemIdInCircle(int cx, int cy, optional<int> radius, optional<int> itemType) {
-	int r = radius.has_value() ? *radius : 0;
-	int rr = r * r;
-
+template<class Pred> std::vector<int> StgItemManager::_GetItemIdInRegion(const DxRect<double>* pBound, 
+	optional<int> itemType, Pred&& pred) 
+{
 	std::vector<int> res;
-	for (ref_unsync_ptr<StgItemObject>& obj : listObj_) {
-		if (obj->IsDeleted()) continue;
-		if (itemType.has_value() && (*itemType != obj->GetItemType())) continue;
 
-		bool bInRadius = Math::HypotSq<int>(cx - obj->GetPositionX(), cy - obj->GetPositionY()) <= rr;
-		if (!radius.has_value() || bInRadius)
-			res.push_back(obj->GetObjectID());
+	auto _Process = [&](size_t i) {
+		if (hotData_.listFlag[i] & StgHotDataTable::FLAG_DELETED) return;
+		if (itemType.has_value() && (*itemType != hotData_.listType[i])) return;
+		if (pred(hotData_.listPosX[i], hotData_.listPosY[i]))
+			res.push_back(hotData_.listObjectID[i]);
+	};
+
+	if (pBound)
+		hotIndex_.ForEachRow(&hotData_, *pBound, _Process);
+	else {
+		const size_t count = hotData_.GetSize();
+		for (size_t i = 0; i < count; ++i)
+			_Process(i);
 	}
 
 	return res;
 }
+std::vector<int> StgItemManager::GetItemIdInCircle(int cx, int cy, optional<int> radius, optional<int> itemType) {
+	if (!radius.has_value())
+		return _GetItemIdInRegion(nullptr, itemType, [](double, double) { return true; });
+
+	int r = *radius;
+	int rr = r * r;
+
+	DxRect<double> rcBound(cx - r, cy - r, cx + r, cy + r);
+	return _GetItemIdInRegion(&rcBound, itemType, [&](double x, double y) {
+		return Math::HypotSq<int>(cx - x, cy - y) <= rr;
+	});
+}
+std::vector<int> StgItemManager::GetItemIdInRect(const DxRect<double>& rect, optional<int> itemType) {
+	return _GetItemIdInRegion(&rect, itemType, [&](double x, double y) {
+		return rect.IsPointIntersected(x, y);
+	});
+}
+std::vector<int> StgItemManager::GetItemIdInLine(double x1, double y1, double x2, double y2, double width, optional<int> itemType) {
+	DxRect<double> rcBound = StgHotDataIndex::GetLineBound(x1, y1, x2, y2, width);
+	return _GetItemIdInRegion(&rcBound, itemType, [&](double x, double y) {
+		return StgHotDataIndex::IsPointInLine(x, y, x1, y1, x2, y2, width);
+	});
+}
 
 //*******************************************************************
 //StgItemDataList
@@ -706,6 +775,10 @@ StgItemDataFrame* StgItemData::GetFrame(size_t frame) {
 //StgItemObject
 //*******************************************************************
 StgItemObject::StgItemObject(StgStageController* stageController) : StgMoveObject(stageController) {
+	_AddObjectClass<StgItemObject>(this);
+	_AddObjectClass<StgMoveObject>(this);
+	_AddObjectClass<StgIntersectionObject>(this);
+	pObjectBase_ = this;
 	stageController_ = stageController;
 	typeObject_ = TypeObject::Item;
 
@@ -1100,6 +1173,7 @@ void StgItemObject_ScoreText::Intersect(StgIntersectionTarget* ownTarget, StgInt
 
 //StgItemObject_User
 StgItemObject_User::StgItemObject_User(StgStageController* stageController) : StgItemObject(stageController) {
+	_AddObjectClass<StgItemObject_User>(this);
 	typeItem_ = ITEM_USER;
 	SetMoveType(StgMovePattern_Item::MOVE_DOWN);
 
@@ -1114,7 +1188,7 @@ void StgItemObject_User::Clone(DxScriptObjectBase* _src) {
 	StgMoveObject::Copy((StgMoveObject*)src);
 	StgIntersectionObject::Copy((StgIntersectionObject*)src);
 
-	typeItem_ = src->typeItem_;
+	SetItemType(src->typeItem_);
 	frameWork_ = src->frameWork_;
 	score_ = src->score_;
 
@@ -1136,7 +1210,7 @@ void StgItemObject_User::SetImageID(int id) {
 	idImage_ = id;
 	StgItemData* data = _GetItemData();
 	if (data) {
-		typeItem_ = data->GetItemType();
+		SetItemType(data->GetItemType());
 	}
 }
 StgItemData* StgItemObject_User::_GetItemData() {
@@ -36,7 +36,11 @@ protected:
 
 	unique_ptr<StgItemDataList> listItemData_;
 
-	std::list<ref_unsync_ptr<StgItemObject>> listObj_;
+	//Registered items, index-aligned with hotData_
+	std::vector<ref_unsync_ptr<StgItemObject>> listObj_;
+	StgHotDataTable hotData_;
+	StgHotDataIndex hotIndex_;
+
 	std::vector<RenderQueue> listRenderQueue_;		//one for each render pri
 
 	std::list<DxCircle> listCircleToPlayer_;
@@ -52,6 +56,9 @@ protected:
 
 	ID3DXEffect* effectItem_;
 	D3DXMATRIX matProj_;
+
+	template<class Pred> std::vector<int> _GetItemIdInRegion(const DxRect<double>* pBound, 
+		optional<int> itemType, Pred&& pred);
 public:
 	IDirect3DTexture9* pLastTexture_;
 public:
@@ -62,11 +69,11 @@ public:
 	void Render(int targetPriority);
 	void LoadRenderQueue();
 
-	void AddItem(ref_unsync_ptr<StgItemObject> obj) {
-		listObj_.push_back(obj); 
-	}
+	void AddItem(ref_unsync_ptr<StgItemObject> obj);
 	size_t GetItemCount() { return listObj_.size(); }
 
+	StgHotDataTable* GetHotDataTable() { return &hotData_; }
+
 	ID3DXEffect* GetEffect() { return effectItem_; }
 	D3DXMATRIX* GetProjectionMatrix() { return &matProj_; }
 
@@ -92,6 +99,8 @@ public:
 	void CancelCollectItems();
 
 	std::vector<int> GetItemIdInCircle(int cx, int cy, optional<int> radius, optional<int> itemType);
+	std::vector<int> GetItemIdInRect(const DxRect<double>& rect, optional<int> itemType);
+	std::vector<int> GetItemIdInLine(double x1, double y1, double x2, double y2, double width, optional<int> itemType);
 
 	bool IsDefaultBonusItemEnable() { return bDefaultBonusItemEnable_; }
 	void SetDefaultBonusItemEnable(bool bEnable) { bDefaultBonusItemEnable_ = bEnable; }
@@ -180,6 +189,7 @@ public:
 //*******************************************************************
 class StgItemObject : public DxScriptShaderObject, public StgMoveObject, public StgIntersectionObject {
 	friend StgItemManager;
+	DECLARE_OBJECT_CLASS(StgItemObject, TypeClass::Item);
 public:
 	enum {
 		//Default item IDs
@@ -242,6 +252,10 @@ protected:
 	void _CreateScoreItem();
 	void _NotifyEventToPlayerScript(gstd::value* listValue, size_t count);
 	void _NotifyEventToItemScript(gstd::value* listValue, size_t count);
+
+	virtual void _OnDelete() {
+		if (pHotTable_) pHotTable_->SetFlag(idxHotData_, StgHotDataTable::FLAG_DELETED, true);
+	}
 public:
 	StgItemObject(StgStageController* stageController);
 
@@ -259,8 +273,8 @@ public:
 
 	virtual void Intersect(StgIntersectionTarget* ownTarget, StgIntersectionTarget* otherTarget) = 0;
 
-	virtual void SetX(float x) { posX_ = x; DxScriptRenderObject::SetX(x); }
-	virtual void SetY(float y) { posY_ = y; DxScriptRenderObject::SetY(y); }
+	virtual void SetX(float x) { SetPositionX(x); DxScriptRenderObject::SetX(x); }
+	virtual void SetY(float y) { SetPositionY(y); DxScriptRenderObject::SetY(y); }
 	virtual void SetColor(int r, int g, int b);
 	virtual void SetAlpha(int alpha);
 	void SetToPosition(D3DXVECTOR2& pos);
@@ -268,7 +282,10 @@ public:
 	int GetFrameWork() { return frameWork_; }
 
 	int GetItemType() { return typeItem_; }
-	void SetItemType(int type) { typeItem_ = type; }
+	void SetItemType(int type) {
+		typeItem_ = type;
+		if (pHotTable_) pHotTable_->listType[idxHotData_] = type;
+	}
 
 	int64_t GetScore() { return score_; }
 	void SetScore(int64_t score) { score_ = score; }
@@ -301,6 +318,7 @@ public:
 };
 
 class StgItemObject_1UP : public StgItemObject {
+	DECLARE_POOL_ALLOCATOR(StgItemObject_1UP, "Item");
 public:
 	StgItemObject_1UP(StgStageController* stageController);
 	
@@ -308,6 +326,7 @@ public:
 };
 
 class StgItemObject_Bomb : public StgItemObject {
+	DECLARE_POOL_ALLOCATOR(StgItemObject_Bomb, "Item");
 public:
 	StgItemObject_Bomb(StgStageController* stageController);
 	
@@ -315,6 +334,7 @@ public:
 };
 
 class StgItemObject_Power : public StgItemObject {
+	DECLARE_POOL_ALLOCATOR(StgItemObject_Power, "Item");
 public:
 	StgItemObject_Power(StgStageController* stageController);
 	
@@ -322,6 +342,7 @@ public:
 };
 
 class StgItemObject_Point : public StgItemObject {
+	DECLARE_POOL_ALLOCATOR(StgItemObject_Point, "Item");
 public:
 	StgItemObject_Point(StgStageController* stageController);
 	
@@ -329,6 +350,7 @@ public:
 };
 
 class StgItemObject_Bonus : public StgItemObject {
+	DECLARE_POOL_ALLOCATOR(StgItemObject_Bonus, "Item");
 public:
 	StgItemObject_Bonus(StgStageController* stageController);
 	
@@ -338,6 +360,7 @@ public:
 
 class StgItemObject_ScoreText : public StgItemObject {
 	int frameDelete_;
+	DECLARE_POOL_ALLOCATOR(StgItemObject_ScoreText, "Item");
 public:
 	StgItemObject_ScoreText(StgStageController* stageController);
 	
@@ -351,6 +374,8 @@ class StgItemObject_User : public StgItemObject {
 	weak_ptr<Texture> renderTarget_;
 protected:
 	inline StgItemData* _GetItemData();
+	DECLARE_POOL_ALLOCATOR(StgItemObject_User, "Item");
+	DECLARE_OBJECT_CLASS(StgItemObject_User, TypeClass::ItemUser);
 public:
 	StgItemObject_User(StgStageController* stageController);
 
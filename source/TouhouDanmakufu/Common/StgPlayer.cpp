@@ -7,6 +7,10 @@
 //StgPlayerObject
 //*******************************************************************
 StgPlayerObject::StgPlayerObject(StgStageController* stageController) : StgMoveObject(stageController) {
+	_AddObjectClass<StgPlayerObject>(this);
+	_AddObjectClass<StgMoveObject>(this);
+	_AddObjectClass<StgIntersectionObject>(this);
+	pObjectBase_ = this;
 	typeObject_ = TypeObject::Player;
 
 	infoPlayer_.reset(new StgPlayerInformation());
@@ -264,7 +268,7 @@ void StgPlayerObject::SendGrazeEvent() {
 	for (auto iObj = listGrazedShot_.begin(); iObj != listGrazedShot_.end(); ++iObj) {
 		if (auto& wObj = *iObj) {
 			//No need to check for a nullptr, listGrazedShot_ only contains StgShotObject* anyway
-			StgShotObject* objShot = dynamic_cast<StgShotObject*>(wObj.get());
+			StgShotObject* objShot = wObj->GetObjectAs<StgShotObject>();
 			if (!objShot->IsDeleted()) {
 				double listShotPos[2] = { objShot->GetPositionX(), objShot->GetPositionY() };
 				listValPos.push_back(script_->CreateFloatArrayValue(listShotPos, 2U));
@@ -298,7 +302,7 @@ void StgPlayerObject::Intersect(StgIntersectionTarget* ownTarget, StgIntersectio
 	switch (otherTarget->GetTargetType()) {
 	case StgIntersectionTarget::TYPE_ENEMY_SHOT:
 	{
-		auto objShot = dynamic_cast<StgShotObject*>(wObj.get());
+		auto objShot = wObj ? wObj->GetObjectAs<StgShotObject>() : nullptr;
 		if (!tPlayer->IsGraze()) {
 			int hitID = objShot ? objShot->GetObjectID() : DxScript::ID_INVALID;
 			KillSelf(hitID);
@@ -319,7 +323,7 @@ void StgPlayerObject::Intersect(StgIntersectionTarget* ownTarget, StgIntersectio
 	case StgIntersectionTarget::TYPE_ENEMY:
 	{
 		if (!tPlayer->IsGraze()) {
-			if (auto objEnemy = dynamic_cast<StgEnemyObject*>(wObj.get()))
+			if (auto objEnemy = wObj ? wObj->GetObjectAs<StgEnemyObject>() : nullptr)
 				KillSelf(objEnemy->GetObjectID());
 		}
 		break;
@@ -353,6 +357,9 @@ bool StgPlayerObject::IsWaitLastSpell() {
 //StgPlayerSpellObject
 //*******************************************************************
 StgPlayerSpellObject::StgPlayerSpellObject(StgStageController* stageController) : StgObjectBase(stageController) {
+	_AddObjectClass<StgPlayerSpellObject>(this);
+	_AddObjectClass<StgIntersectionObject>(this);
+	pObjectBase_ = this;
 	damage_ = 0;
 	bEraseShot_ = true;
 	life_ = 256 * 256 * 256;
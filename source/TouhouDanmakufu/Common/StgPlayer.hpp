@@ -36,6 +36,7 @@ public:
 };
 
 class StgPlayerObject : public DxScriptSpriteObject2D, public StgMoveObject, public StgIntersectionObject {
+	DECLARE_OBJECT_CLASS(StgPlayerObject, TypeClass::Player);
 public:
 	enum {
 		STATE_NORMAL,
@@ -183,6 +184,7 @@ protected:
 	double damage_;
 	bool bEraseShot_;
 	double life_;
+	DECLARE_OBJECT_CLASS(StgPlayerSpellObject, TypeClass::PlayerSpell);
 public:
 	StgPlayerSpellObject(StgStageController* stageController);
 
@@ -6,6 +6,63 @@
 #include "StgItem.hpp"
 #include "../../GcLib/directx/HLSL.hpp"
 
+//****************************************************************************
+//StgShotRenderBatch
+//****************************************************************************
+void StgShotRenderBatch::Clear() {
+	for (std::vector<DrawItem>& listDraw : listDraw_)
+		listDraw.clear();
+	listPending_.clear();
+	listInstance_.clear();
+}
+void StgShotRenderBatch::AddShot(StgShotObject* shot) {
+	StgShotRenderInstance inst;
+	AddItem(shot, shot->GetRenderInstance(&inst) ? &inst : nullptr);
+}
+void StgShotRenderBatch::AddItem(StgShotObject* shot, const StgShotRenderInstance* pInstance) {
+	if (pInstance == nullptr) {
+		//Drawn on its own in every blend pass
+		for (std::vector<DrawItem>& listDraw : listDraw_)
+			listDraw.push_back({ shot, nullptr, 0, 0 });
+		return;
+	}
+
+	const StgShotRenderInstance& inst = *pInstance;
+	if (inst.frame == nullptr || inst.blend >= BLEND_SLOT_COUNT) return;
+
+	//Only joins the draw right before it in the pass, merging past other draws would reorder the shots
+	std::vector<DrawItem>& listDraw = listDraw_[inst.blend];
+	if (listDraw.size() == 0 || listDraw.back().pShot != nullptr || listDraw.back().pFrame != inst.frame)
+		listDraw.push_back({ nullptr, inst.frame, 0, 0 });
+	++(listDraw.back().instanceCount);
+
+	listPending_.push_back({ inst.blend, listDraw.size() - 1, inst.instance });
+}
+void StgShotRenderBatch::Finalize() {
+	//Lay the instances of each draw out contiguously, instanceStart temporarily marks the end of the range
+	size_t countInstance = 0;
+	for (std::vector<DrawItem>& listDraw : listDraw_) {
+		for (DrawItem& item : listDraw) {
+			countInstance += item.instanceCount;
+			item.instanceStart = countInstance;
+		}
+	}
+
+	//Filled back to front so that each draw keeps its shots in queue order
+	listInstance_.resize(countInstance);
+	for (auto itr = listPending_.rbegin(); itr != listPending_.rend(); ++itr) {
+		DrawItem& item = listDraw_[itr->blend][itr->item];
+		listInstance_[--(item.instanceStart)] = itr->instance;
+	}
+	listPending_.clear();
+}
+void StgShotRenderBatch::Build(StgShotObject* const* listShot, size_t count) {
+	Clear();
+	for (size_t i = 0; i < count; ++i)
+		AddShot(listShot[i]);
+	Finalize();
+}
+
 //****************************************************************************
 //StgShotManager
 //****************************************************************************
@@ -42,22 +99,44 @@ StgShotManager::StgShotManager(StgStageController* stageController) {
 }
 StgShotManager::~StgShotManager() {
 	for (ref_unsync_ptr<StgShotObject>& obj : listObj_) {
-		if (obj)
+		if (obj) {
 			obj->ClearShotObject();
+			obj->DetachHotData();
+		}
+	}
+}
+//Steps the movement of all simple angular shots at once, each shot takes its result in its own _Move
+void StgShotManager::PrepareMoveBatch() {
+	moveBatch_.Clear();
+	for (auto& obj : listObj_) {
+		if (obj->IsDeleted() || !obj->IsActive()) continue;
+		moveBatch_.Add(obj.get());
 	}
+	moveBatch_.Step();
 }
 void StgShotManager::Work() {
-	for (auto itr = listObj_.begin(); itr != listObj_.end(); ) {
-		ref_unsync_ptr<StgShotObject>& obj = *itr;
-		if (obj->IsDeleted()) {
-			obj->ClearShotObject();
-			itr = listObj_.erase(itr);
+	//Stable compaction of listObj_ and its hot data rows
+	size_t iWrite = 0;
+	for (size_t iRead = 0; iRead < listObj_.size(); ++iRead) {
+		ref_unsync_ptr<StgShotObject>& obj = listObj_[iRead];
+		if (obj->IsDeleted() || !obj->IsActive()) {
+			if (obj->IsDeleted())
+				obj->ClearShotObject();
+			obj->DetachHotData();
+			continue;
 		}
-		else if (!obj->IsActive()) {
-			itr = listObj_.erase(itr);
+
+		if (iWrite != iRead) {
+			listObj_[iWrite] = obj;
+			hotData_.MoveRow(iWrite, iRead);
+			obj->AttachHotData(&hotData_, iWrite);
 		}
-		else ++itr;
+		++iWrite;
 	}
+	listObj_.resize(iWrite);
+	hotData_.Resize(iWrite);
+
+	hotIndex_.Build(&hotData_);
 }
 
 std::array<BlendMode, StgShotManager::BLEND_COUNT> StgShotManager::blendTypeRenderOrder = {
@@ -73,14 +152,18 @@ std::array<BlendMode, StgShotManager::BLEND_COUNT> StgShotManager::blendTypeRend
 void StgShotManager::Render(int targetPriority) {
 	if (targetPriority < 0 || targetPriority >= listRenderQueueEnemy_.size()) return;
 
-	const RenderQueue& renderQueuePlayer = listRenderQueuePlayer_[targetPriority];
-	const RenderQueue& renderQueueEnemy = listRenderQueueEnemy_[targetPriority];
+	RenderQueue& renderQueuePlayer = listRenderQueuePlayer_[targetPriority];
+	RenderQueue& renderQueueEnemy = listRenderQueueEnemy_[targetPriority];
 	if (renderQueuePlayer.count == 0 && renderQueueEnemy.count == 0) return;
 
 	DirectGraphics* graphics = DirectGraphics::GetBase();
 	IDirect3DDevice9* device = graphics->GetDevice();
 	RenderShaderLibrary* shaderManager = ShaderManager::GetBase()->GetRenderLib();
 
+	VertexBufferManager* bufferManager = VertexBufferManager::GetBase();
+	GrowableVertexBuffer* instanceBuffer = bufferManager->GetInstancingVertexBuffer();
+	FixedIndexBuffer* indexBuffer = bufferManager->GetIndexBuffer();
+
 	graphics->SetZBufferEnable(false);
 	graphics->SetZWriteEnable(false);
 	graphics->SetCullingMode(D3DCULL_NONE);
@@ -105,18 +188,116 @@ void StgShotManager::Render(int targetPriority) {
 		effectShot_->SetMatrix(handle, &matProj_);
 	}
 
-	auto _RenderQueue = [&](const RenderQueue& renderQueue) {
+	ID3DXEffect* effectInstance = shaderManager->GetInstancing2DShader();
+	if (D3DXHANDLE handle = effectInstance->GetParameterBySemantic(nullptr, "WORLDVIEWPROJ")) {
+		effectInstance->SetMatrix(handle, &matProj_);
+	}
+
+	bool bIndexLoaded = false;
+	bool bInstancedState = false;
+
+	auto _BeginInstanced = [&]() {
+		if (bInstancedState) return;
+		bInstancedState = true;
+
+		if (!bIndexLoaded) {
+			bIndexLoaded = true;
+
+			std::array<uint16_t, 4> listIndex = { 0, 1, 2, 3 };
+			BufferLockParameter lockParam = BufferLockParameter(D3DLOCK_DISCARD);
+			lockParam.SetSource(listIndex, listIndex.size(), sizeof(uint16_t));
+			indexBuffer->UpdateBuffer(&lockParam);
+		}
+
+		device->SetVertexDeclaration(shaderManager->GetVertexDeclarationInstancedTLX());
+		device->SetIndices(indexBuffer->GetBuffer());
+	};
+	auto _EndInstanced = [&]() {
+		if (!bInstancedState) return;
+		bInstancedState = false;
+
+#ifdef __L_USE_HWINSTANCING
+		device->SetStreamSourceFreq(0, 1);
+		device->SetStreamSourceFreq(1, 1);
+#endif
+		device->SetVertexDeclaration(shaderManager->GetVertexDeclarationTLX());
+	};
+
+	auto _RenderInstanced = [&](const StgShotRenderBatch::DrawItem& item, BlendMode blend) {
+		StgShotVertexBufferContainer* pVB = item.pFrame->GetVertexBufferContainer();
+		if (pVB == nullptr || item.instanceCount == 0) return;
+
+		if (graphics->IsAllowRenderTargetChange())
+			graphics->SetRenderTarget(nullptr);
+
+		IDirect3DTexture9* pTexture = pVB->GetD3DTexture();
+		if (pTexture != pLastTexture_) {
+			device->SetTexture(0, pTexture);
+			pLastTexture_ = pTexture;
+		}
+
+		_BeginInstanced();
+
+		device->SetStreamSource(0, pVB->GetD3DBuffer(), item.pFrame->vertexOffset_ * sizeof(VERTEX_TLX), sizeof(VERTEX_TLX));
+#ifdef __L_USE_HWINSTANCING
+		device->SetStreamSourceFreq(0, D3DSTREAMSOURCE_INDEXEDDATA | item.instanceCount);
+		device->SetStreamSource(1, instanceBuffer->GetBuffer(), 
+			item.instanceStart * sizeof(VERTEX_INSTANCE), sizeof(VERTEX_INSTANCE));
+		device->SetStreamSourceFreq(1, D3DSTREAMSOURCE_INSTANCEDATA | 1U);
+#endif
+
+		effectInstance->SetTechnique(pTexture ? (blend == MODE_BLEND_ALPHA_INV ?
+			"RenderInv" : "Render") : "RenderNoTexture");
+
+		UINT countPass = 1;
+		effectInstance->Begin(&countPass, D3DXFX_DONOTSAVESHADERSTATE);
+		for (UINT iPass = 0; iPass < countPass; ++iPass) {
+			effectInstance->BeginPass(iPass);
+#ifdef __L_USE_HWINSTANCING
+			device->DrawIndexedPrimitive(D3DPT_TRIANGLESTRIP, 0, 0, 4, 0, 2);
+#else
+			for (size_t iInst = 0; iInst < item.instanceCount; ++iInst) {
+				device->SetStreamSource(1, instanceBuffer->GetBuffer(),
+					(item.instanceStart + iInst) * sizeof(VERTEX_INSTANCE), 0);
+				device->DrawIndexedPrimitive(D3DPT_TRIANGLESTRIP, 0, 0, 4, 0, 2);
+			}
+#endif
+			effectInstance->EndPass();
+		}
+		effectInstance->End();
+	};
+
+	auto _RenderQueue = [&](RenderQueue& renderQueue) {
 		if (renderQueue.count == 0) return;
+		StgShotRenderBatch& batch = renderQueue.batch;
+
+		//One upload for all instanced draws of the queue
+		std::vector<VERTEX_INSTANCE>& listInstance = batch.GetInstanceList();
+		if (listInstance.size() > 0) {
+			instanceBuffer->Expand(listInstance.size());
+
+			BufferLockParameter lockParam = BufferLockParameter(D3DLOCK_DISCARD);
+			lockParam.SetSource(listInstance, listInstance.size(), sizeof(VERTEX_INSTANCE));
+			instanceBuffer->UpdateBuffer(&lockParam);
+		}
 
 		for (size_t iBlend = 0; iBlend < blendTypeRenderOrder.size(); ++iBlend) {
 			BlendMode blend = blendTypeRenderOrder[iBlend];
 
+			const std::vector<StgShotRenderBatch::DrawItem>& listDraw = batch.GetDrawList(blend);
+			if (listDraw.size() == 0) continue;
+
 			graphics->SetBlendMode(blend);
 			effectShot_->SetTechnique(blend == MODE_BLEND_ALPHA_INV ? "RenderInv" : "Render");
 
-			for (size_t i = 0; i < renderQueue.count; ++i) {
-				StgShotObject* pShot = renderQueue.listShot[i];
-				pShot->Render(blend);
+			for (const StgShotRenderBatch::DrawItem& item : listDraw) {
+				if (item.pShot) {
+					_EndInstanced();
+					item.pShot->Render(blend);
+				}
+				else {
+					_RenderInstanced(item, blend);
+				}
 			}
 		}
 	};
@@ -124,6 +305,7 @@ void StgShotManager::Render(int targetPriority) {
 	//Always renders enemy shots above player shots, completely obliterates TAΣ's wet dream.
 	_RenderQueue(renderQueuePlayer);
 	_RenderQueue(renderQueueEnemy);
+	_EndInstanced();
 
 	device->SetVertexShader(nullptr);
 	device->SetPixelShader(nullptr);
@@ -149,6 +331,13 @@ void StgShotManager::LoadRenderQueue() {
 			listShot.resize(listShot.size() * 2);
 		listShot[count++] = obj.get();
 	}
+
+	for (size_t i = 0; i < listRenderQueuePlayer_.size(); ++i) {
+		for (RenderQueue* pQueue : { &listRenderQueuePlayer_[i], &listRenderQueueEnemy_[i] }) {
+			if (pQueue->count > 0)
+				pQueue->batch.Build(pQueue->listShot.data(), pQueue->count);
+		}
+	}
 }
 
 void StgShotManager::RegistIntersectionTarget() {
@@ -160,64 +349,137 @@ void StgShotManager::RegistIntersectionTarget() {
 	}
 }
 void StgShotManager::AddShot(ref_unsync_ptr<StgShotObject> obj) {
+	if (obj->IsHotDataAttached()) return;	//Already registered
+
 	obj->SetOwnObjectReference();
 	listObj_.push_back(obj);
-}
 
-void StgShotManager::DeleteInCircle(int typeDelete, int typeTo, int typeOwner, int cx, int cy, optional<int> radius) {
-	int r = radius ? *radius : 0;
-	int rr = r * r;
-
-	DxRect<int> rcBox(cx - r, cy - r, cx + r, cy + r);
-
-	for (ref_unsync_ptr<StgShotObject>& obj : listObj_) {
-		if (obj->IsDeleted()) continue;
-		if ((typeOwner != StgShotObject::OWNER_NULL) && (obj->GetOwnerType() != typeOwner)) continue;
-		if (typeDelete == DEL_TYPE_SHOT && obj->IsSpellResist()) continue;
+	uint8_t flag = 0;
+	if (obj->IsDeleted()) flag |= StgHotDataTable::FLAG_DELETED;
+	if (obj->IsSpellResist()) flag |= StgHotDataTable::FLAG_SPELL_RESIST;
+	size_t index = hotData_.AddRow(obj->GetPositionX(), obj->GetPositionY(), 
+		obj->GetObjectID(), obj->GetOwnerType(), flag);
+	obj->AttachHotData(&hotData_, index);
+}
 
-		int sx = obj->GetPositionX();
-		int sy = obj->GetPositionY();
+template<class Pred> void StgShotManager::_DeleteInRegion(int typeDelete, int typeTo, int typeOwner, 
+	const DxRect<double>* pBound, Pred&& pred) 
+{
+	uint8_t maskSkip = StgHotDataTable::FLAG_DELETED;
+	if (typeDelete == DEL_TYPE_SHOT)
+		maskSkip |= StgHotDataTable::FLAG_SPELL_RESIST;
+
+	//Deleting may fire events that move or register shots, don't cache the array pointers
+	auto _Process = [&](size_t i) {
+		if (hotData_.listFlag[i] & maskSkip) return;
+		if ((typeOwner != StgShotObject::OWNER_NULL) && (hotData_.listType[i] != typeOwner)) return;
+		if (!pred(hotData_.listPosX[i], hotData_.listPosY[i])) return;
+
+		StgShotObject* obj = listObj_[i].get();
+		if (typeTo == TO_TYPE_IMMEDIATE)
+			obj->DeleteImmediate();
+		else if (typeTo == TO_TYPE_FADE)
+			obj->SetFadeDelete();
+		else if (typeTo == TO_TYPE_ITEM)
+			obj->ConvertToItem();
+	};
 
-		bool bInRadius = rcBox.IsPointIntersected(sx, sy) && Math::HypotSq<int64_t>(cx - sx, cy - sy) <= rr;
-		if (!radius.has_value() || bInRadius) {
-			if (typeTo == TO_TYPE_IMMEDIATE)
-				obj->DeleteImmediate();
-			else if (typeTo == TO_TYPE_FADE)
-				obj->SetFadeDelete();
-			else if (typeTo == TO_TYPE_ITEM)
-				obj->ConvertToItem();
-		}
+	if (pBound)
+		hotIndex_.ForEachRow(&hotData_, *pBound, _Process);
+	else {
+		for (size_t i = 0; i < hotData_.GetSize(); ++i)
+			_Process(i);
 	}
 }
+void StgShotManager::DeleteInCircle(int typeDelete, int typeTo, int typeOwner, int cx, int cy, optional<int> radius) {
+	if (!radius.has_value()) {
+		_DeleteInRegion(typeDelete, typeTo, typeOwner, nullptr, [](double, double) { return true; });
+		return;
+	}
 
-std::vector<int> StgShotManager::GetShotIdInCircle(int typeOwner, int cx, int cy, optional<int> radius) {
-	int r = radius ? *radius : 0;
-	int rr = r * r;
+	int r = *radius;
+	int64_t rr = (int64_t)r * r;
 
 	DxRect<int> rcBox(cx - r, cy - r, cx + r, cy + r);
+	DxRect<double> rcBound = rcBox;
+	_DeleteInRegion(typeDelete, typeTo, typeOwner, &rcBound, [&](double x, double y) {
+		int sx = x;
+		int sy = y;
+		return rcBox.IsPointIntersected(sx, sy) && Math::HypotSq<int64_t>(cx - sx, cy - sy) <= rr;
+	});
+}
+void StgShotManager::DeleteInRect(int typeDelete, int typeTo, int typeOwner, const DxRect<double>& rect) {
+	_DeleteInRegion(typeDelete, typeTo, typeOwner, &rect, [&](double x, double y) {
+		return rect.IsPointIntersected(x, y);
+	});
+}
+void StgShotManager::DeleteInLine(int typeDelete, int typeTo, int typeOwner, 
+	double x1, double y1, double x2, double y2, double width) 
+{
+	DxRect<double> rcBound = StgHotDataIndex::GetLineBound(x1, y1, x2, y2, width);
+	_DeleteInRegion(typeDelete, typeTo, typeOwner, &rcBound, [&](double x, double y) {
+		return StgHotDataIndex::IsPointInLine(x, y, x1, y1, x2, y2, width);
+	});
+}
 
+template<class Pred> std::vector<int> StgShotManager::_GetShotIdInRegion(int typeOwner, 
+	const DxRect<double>* pBound, Pred&& pred) 
+{
 	std::vector<int> res;
-	for (ref_unsync_ptr<StgShotObject>& obj : listObj_) {
-		if (obj->IsDeleted()) continue;
-		if ((typeOwner != StgShotObject::OWNER_NULL) && (obj->GetOwnerType() != typeOwner)) continue;
 
-		int sx = obj->GetPositionX();
-		int sy = obj->GetPositionY();
+	auto _Process = [&](size_t i) {
+		if (hotData_.listFlag[i] & StgHotDataTable::FLAG_DELETED) return;
+		if ((typeOwner != StgShotObject::OWNER_NULL) && (hotData_.listType[i] != typeOwner)) return;
+		if (pred(hotData_.listPosX[i], hotData_.listPosY[i]))
+			res.push_back(hotData_.listObjectID[i]);
+	};
 
-		bool bInRadius = rcBox.IsPointIntersected(sx, sy) && Math::HypotSq<int64_t>(cx - sx, cy - sy) <= rr;
-		if (!radius.has_value() || bInRadius) {
-			res.push_back(obj->GetObjectID());
-		}
+	if (pBound)
+		hotIndex_.ForEachRow(&hotData_, *pBound, _Process);
+	else {
+		const size_t count = hotData_.GetSize();
+		for (size_t i = 0; i < count; ++i)
+			_Process(i);
 	}
 
 	return res;
 }
+std::vector<int> StgShotManager::GetShotIdInCircle(int typeOwner, int cx, int cy, optional<int> radius) {
+	if (!radius.has_value())
+		return _GetShotIdInRegion(typeOwner, nullptr, [](double, double) { return true; });
+
+	int r = *radius;
+	int64_t rr = (int64_t)r * r;
+
+	DxRect<int> rcBox(cx - r, cy - r, cx + r, cy + r);
+	DxRect<double> rcBound = rcBox;
+	return _GetShotIdInRegion(typeOwner, &rcBound, [&](double x, double y) {
+		int sx = x;
+		int sy = y;
+		return rcBox.IsPointIntersected(sx, sy) && Math::HypotSq<int64_t>(cx - sx, cy - sy) <= rr;
+	});
+}
+std::vector<int> StgShotManager::GetShotIdInRect(int typeOwner, const DxRect<double>& rect) {
+	return _GetShotIdInRegion(typeOwner, &rect, [&](double x, double y) {
+		return rect.IsPointIntersected(x, y);
+	});
+}
+std::vector<int> StgShotManager::GetShotIdInLine(int typeOwner, double x1, double y1, double x2, double y2, double width) {
+	DxRect<double> rcBound = StgHotDataIndex::GetLineBound(x1, y1, x2, y2, width);
+	return _GetShotIdInRegion(typeOwner, &rcBound, [&](double x, double y) {
+		return StgHotDataIndex::IsPointInLine(x, y, x1, y1, x2, y2, width);
+	});
+}
 size_t StgShotManager::GetShotCount(int typeOwner) {
 	size_t res = 0;
 
-	for (ref_unsync_ptr<StgShotObject>& obj : listObj_) {
-		if (obj->IsDeleted()) continue;
-		if ((typeOwner != StgShotObject::OWNER_NULL) && (obj->GetOwnerType() != typeOwner)) continue;
+	const size_t count = hotData_.GetSize();
+	const int* pType = hotData_.listType.data();
+	const uint8_t* pFlag = hotData_.listFlag.data();
+
+	for (size_t i = 0; i < count; ++i) {
+		if (pFlag[i] & StgHotDataTable::FLAG_DELETED) continue;
+		if ((typeOwner != StgShotObject::OWNER_NULL) && (pType[i] != typeOwner)) continue;
 		++res;
 	}
 
@@ -737,6 +999,10 @@ HRESULT StgShotVertexBufferContainer::LoadData(const std::vector<VERTEX_TLX>& da
 //StgShotObject
 //****************************************************************************
 StgShotObject::StgShotObject(StgStageController* stageController) : StgMoveObject(stageController) {
+	_AddObjectClass<StgShotObject>(this);
+	_AddObjectClass<StgMoveObject>(this);
+	_AddObjectClass<StgIntersectionObject>(this);
+	pObjectBase_ = this;
 	frameWork_ = 0;
 	posX_ = 0;
 	posY_ = 0;
@@ -849,6 +1115,11 @@ void StgShotObject::_Move() {
 	SetX(posX_);
 	SetY(posY_);
 }
+bool StgShotObject::IsSimpleMovement() {
+	if (IsDeleted() || !listTransformationShotAct_.empty()) return false;
+	if (delay_.time > 0 && !bEnableMotionDelay_) return false;
+	return StgMoveObject::IsSimpleMovement();
+}
 void StgShotObject::_DeleteInLife() {
 	if (IsDeleted() || life_ > 0) return;
 
@@ -1402,6 +1673,7 @@ float StgShotObject::DelayParameter::_CalculateValue(D3DXVECTOR3* param, lerp_fu
 //StgNormalShotObject
 //****************************************************************************
 StgNormalShotObject::StgNormalShotObject(StgStageController* stageController) : StgShotObject(stageController) {
+	_AddObjectClass<StgNormalShotObject>(this);
 	typeObject_ = TypeObject::Shot;
 	angularVelocity_ = 0;
 	bFixedAngle_ = false;
@@ -1596,70 +1868,50 @@ void StgShotObject::_DefaultShotRender(StgShotData* shotData, StgShotDataFrame*
 	}
 }
 
-void StgNormalShotObject::Render(BlendMode targetBlend) {
-	//if (!IsVisible()) return;
-	StgShotManager* shotManager = stageController_->GetShotManager();
-
+bool StgNormalShotObject::_LoadRenderParameter(RenderParameter* param) {
 	StgShotData* shotData = _GetShotData();
-	if (shotData == nullptr) return;
+	if (shotData == nullptr) return false;
 
-	FLOAT sposx = position_.x;
-	FLOAT sposy = position_.y;
+	param->position = D3DXVECTOR2(position_.x, position_.y);
 	if (bRoundingPosition_) {
-		sposx = roundf(sposx);
-		sposy = roundf(sposy);
+		param->position.x = roundf(param->position.x);
+		param->position.y = roundf(param->position.y);
 	}
 
-	float scaleX = 1.0f;
-	float scaleY = 1.0f;
-	D3DCOLOR color;
-
-	auto _Render = [&](StgShotData* pData, StgShotDataFrame* pFrame) {
-		if (pData == nullptr || pFrame == nullptr) return;
-
-		D3DXMATRIX matTransform(
-			scaleX * move_.x, scaleX * move_.y, 0, 0,
-			scaleY * -move_.y, scaleY * move_.x, 0, 0,
-			0, 0, 1, 0,
-			sposx, sposy, 0, 1
-		);
-		_DefaultShotRender(pData, pFrame, matTransform, color);
-	};
-
 	if (delay_.time > 0) {
 		BlendMode objBlendType = GetDelayBlendType();
-		objBlendType = objBlendType == MODE_BLEND_NONE ? shotData->GetDelayRenderType() : objBlendType;
-		if (objBlendType != targetBlend) return;
+		param->blend = objBlendType == MODE_BLEND_NONE ? shotData->GetDelayRenderType() : objBlendType;
 
 		StgShotData* delayData = _GetShotData(delay_.id >= 0 ? delay_.id : shotData->GetDefaultDelayID());
-		if (delayData) {
-			StgShotDataFrame* delayFrame = delayData ? delayData->GetFrame(frameWork_) : nullptr;
+		if (delayData == nullptr) return false;
 
-			scaleX = scaleY = delay_.GetScale();
-			if (delay_.scaleMix) {
-				scaleX *= scale_.x;
-				scaleY *= scale_.y;
-			}
+		param->data = delayData;
+		param->frame = delayData->GetFrame(frameWork_);
 
-			color = (delay_.colorRep != 0) ? delay_.colorRep : shotData->GetDelayColor();
-			if (delay_.colorMix) ColorAccess::MultiplyColor(color, color_);
-			{
-				byte alpha = ColorAccess::ClampColorRet(((color >> 24) & 0xff) * delay_.GetAlpha());
-				color = (color & 0x00ffffff) | (alpha << 24);
-			}
+		float scale = delay_.GetScale();
+		param->scale = D3DXVECTOR2(scale, scale);
+		if (delay_.scaleMix) {
+			param->scale.x *= scale_.x;
+			param->scale.y *= scale_.y;
+		}
 
-			_Render(delayData, delayFrame);
+		D3DCOLOR color = (delay_.colorRep != 0) ? delay_.colorRep : shotData->GetDelayColor();
+		if (delay_.colorMix) ColorAccess::MultiplyColor(color, color_);
+		{
+			byte alpha = ColorAccess::ClampColorRet(((color >> 24) & 0xff) * delay_.GetAlpha());
+			color = (color & 0x00ffffff) | (alpha << 24);
 		}
+		param->color = color;
 	}
 	else {
 		BlendMode objBlendType = GetBlendType();
-		objBlendType = objBlendType == MODE_BLEND_NONE ? shotData->GetRenderType() : objBlendType;
-		if (objBlendType != targetBlend) return;
+		param->blend = objBlendType == MODE_BLEND_NONE ? shotData->GetRenderType() : objBlendType;
 
-		scaleX = scale_.x;
-		scaleY = scale_.y;
-		color = color_;
+		param->data = shotData;
+		param->frame = shotData->GetFrame(frameWork_);
+		param->scale = D3DXVECTOR2(scale_.x, scale_.y);
 
+		D3DCOLOR color = color_;
 		{
 			float alphaRate = shotData->GetAlpha() / 255.0f;
 			if (frameFadeDelete_ >= 0)
@@ -1667,13 +1919,48 @@ void StgNormalShotObject::Render(BlendMode targetBlend) {
 			byte alpha = ColorAccess::ClampColorRet(((color >> 24) & 0xff) * alphaRate);
 			color = (color & 0x00ffffff) | (alpha << 24);
 		}
-
-		StgShotDataFrame* shotFrame = shotData->GetFrame(frameWork_);
-		_Render(shotData, shotFrame);
+		param->color = color;
 	}
 
+	return param->frame != nullptr;
+}
+void StgNormalShotObject::Render(BlendMode targetBlend) {
+	//if (!IsVisible()) return;
+	RenderParameter param;
+	if (!_LoadRenderParameter(&param)) return;
+	if (param.blend != targetBlend) return;
+
+	D3DXMATRIX matTransform(
+		param.scale.x * move_.x, param.scale.x * move_.y, 0, 0,
+		param.scale.y * -move_.y, param.scale.y * move_.x, 0, 0,
+		0, 0, 1, 0,
+		param.position.x, param.position.y, 0, 1
+	);
+	_DefaultShotRender(param.data, param.frame, matTransform, param.color);
+
 	//if (bIntersected_) color = D3DCOLOR_ARGB(255, 255, 0, 0);
 }
+bool StgNormalShotObject::GetRenderInstance(StgShotRenderInstance* pInstance) {
+	//Custom shaders and render targets need the per-shot path
+	if (shader_ != nullptr || !renderTarget_.expired()) return false;
+
+	RenderParameter param;
+	if (!_LoadRenderParameter(&param)) {
+		pInstance->frame = nullptr;
+		return true;
+	}
+
+	//The instancing shader rotates by the negated Z angle, see ParticleRendererBase::AddInstance
+	float angle = atan2f(move_.y, move_.x);
+
+	pInstance->blend = param.blend;
+	pInstance->frame = param.frame;
+	pInstance->instance.diffuse_color = param.color;
+	pInstance->instance.xyz_pos_x_scale = D3DXVECTOR4(param.position.x, param.position.y, 0, param.scale.x);
+	pInstance->instance.yz_scale_xy_ang = D3DXVECTOR4(param.scale.y, 1, 0, 0);
+	pInstance->instance.z_ang_extra = D3DXVECTOR4(-angle, 0, 0, 0);
+	return true;
+}
 
 void StgNormalShotObject::_SendDeleteEvent(TypeDelete type) {
 	if (typeOwner_ != OWNER_ENEMY) return;
@@ -1748,6 +2035,7 @@ void StgNormalShotObject::SetShotDataID(int id) {
 //StgLaserObject(レーザー基本部)
 //****************************************************************************
 StgLaserObject::StgLaserObject(StgStageController* stageController) : StgShotObject(stageController) {
+	_AddObjectClass<StgLaserObject>(this);
 	life_ = 9999999;
 	bSpellResist_ = true;
 
@@ -1794,11 +2082,13 @@ void StgLaserObject::_AddIntersectionRelativeTarget() {
 	ClearIntersected();
 
 	bool res = GetIntersectionTargetList_NoVector(shotData);
-	if (res) {
-		for (auto& iTarget : listIntersectionTarget_) {
-			if (iTarget.first && iTarget.second != nullptr)
-				intersectionManager->AddTarget(iTarget.second);
-		}
+	if (res)
+		_RegistIntersectionTargetList(intersectionManager);
+}
+void StgLaserObject::_RegistIntersectionTargetList(StgIntersectionManager* manager) {
+	for (auto& iTarget : listIntersectionTarget_) {
+		if (iTarget.first && iTarget.second != nullptr)
+			manager->AddTarget(iTarget.second);
 	}
 }
 StgIntersectionObject::IntersectionListType StgLaserObject::GetIntersectionTargetList() {
@@ -2082,6 +2372,7 @@ void StgLooseLaserObject::_SendDeleteEvent(TypeDelete type) {
 //StgStraightLaserObject(設置型レーザー)
 //****************************************************************************
 StgStraightLaserObject::StgStraightLaserObject(StgStageController* stageController) : StgLaserObject(stageController) {
+	_AddObjectClass<StgStraightLaserObject>(this);
 	typeObject_ = TypeObject::StraightLaser;
 
 	angLaser_ = 0;
@@ -2354,6 +2645,7 @@ void StgStraightLaserObject::_SendDeleteEvent(TypeDelete type) {
 //StgCurveLaserObject(曲がる型レーザー)
 //****************************************************************************
 StgCurveLaserObject::StgCurveLaserObject(StgStageController* stageController) : StgLaserObject(stageController) {
+	_AddObjectClass<StgCurveLaserObject>(this);
 	typeObject_ = TypeObject::CurveLaser;
 	tipDecrement_ = 0.0f;
 
@@ -2364,6 +2656,14 @@ StgCurveLaserObject::StgCurveLaserObject(StgStageController* stageController) :
 
 	bCap_ = false;
 	posOrigin_ = D3DXVECTOR2(0, 0);
+
+	handleNext_ = _CreateNodeHandleBase();
+}
+
+//Every laser gets its own 2^32 handle range, so handles of one laser never resolve on another
+int64_t StgCurveLaserObject::_CreateNodeHandleBase() {
+	static uint32_t countLaser = 0;
+	return ((int64_t)(++countLaser) << 32) | 1;
 }
 
 void StgCurveLaserObject::Clone(DxScriptObjectBase* _src) {
@@ -2372,6 +2672,12 @@ void StgCurveLaserObject::Clone(DxScriptObjectBase* _src) {
 	auto src = (StgCurveLaserObject*)_src;
 
 	listPosition_ = src->listPosition_;
+	targetChain_ = nullptr;
+
+	//The copied nodes are this laser's now, oldest first
+	for (size_t i = listPosition_.size(); i > 0; --i)
+		listPosition_[i - 1].handle = handleNext_++;
+
 	vertexData_ = src->vertexData_;
 	listRectIncrement_ = src->listRectIncrement_;
 
@@ -2422,7 +2728,6 @@ void StgCurveLaserObject::_Move() {
 
 StgCurveLaserObject::LaserNode StgCurveLaserObject::CreateNode(const D3DXVECTOR2& pos, const D3DXVECTOR2& rFac, float widthMul, D3DCOLOR col) {
 	LaserNode node;
-	node.parent = this;
 	node.pos = pos;
 	{
 		float nx = rFac.x;
@@ -2434,28 +2739,55 @@ StgCurveLaserObject::LaserNode StgCurveLaserObject::CreateNode(const D3DXVECTOR2
 	node.color = col;
 	return node;
 }
-bool StgCurveLaserObject::GetNode(size_t indexNode, std::list<LaserNode>::iterator& res) {
-	//Search from whichever end is closer to the target node index
-	size_t listSizeMax = listPosition_.size();
-	if (indexNode >= listSizeMax) res = listPosition_.end();
-	if (indexNode < listSizeMax / 2U)
-		res = std::next(listPosition_.begin(), indexNode);
-	else
-		res = std::next(listPosition_.rbegin(), listSizeMax - indexNode).base();
-	return res != listPosition_.end();
-}
-void StgCurveLaserObject::GetNodePointerList(std::vector<LaserNode*>* listRes) {
-	listRes->resize(listPosition_.size(), nullptr);
-	size_t i = 0;
-	for (LaserNode& iNode : listPosition_) {
-		(*listRes)[i++] = &iNode;
-	}
-}
-std::list<StgCurveLaserObject::LaserNode>::iterator StgCurveLaserObject::PushNode(const LaserNode& node) {
-	listPosition_.push_front(node);
+StgCurveLaserObject::LaserNode* StgCurveLaserObject::GetNode(size_t indexNode) {
+	if (indexNode >= listPosition_.size()) return nullptr;
+	return &listPosition_[indexNode];
+}
+StgCurveLaserObject::LaserNode* StgCurveLaserObject::GetNodeFromHandle(int64_t handle) {
+	if (listPosition_.empty()) return nullptr;
+
+	uint64_t index = (uint64_t)listPosition_[0].handle - (uint64_t)handle;
+	if (index >= listPosition_.size()) return nullptr;
+
+	LaserNode* res = &listPosition_[index];
+	return res->handle == handle ? res : nullptr;
+}
+void StgCurveLaserObject::GetNodeHandleList(std::vector<int64_t>* listRes) {
+	size_t countNode = listPosition_.size();
+	listRes->resize(countNode, 0);
+	for (size_t i = 0; i < countNode; ++i)
+		(*listRes)[i] = listPosition_[i].handle;
+}
+StgCurveLaserObject::LaserNode* StgCurveLaserObject::PushNode(const LaserNode& node) {
+	listPosition_.reserve(std::max(length_, 1));
+	LaserNode* res = listPosition_.push_front(node);
+	res->handle = handleNext_++;
 	while (listPosition_.size() > length_)
 		listPosition_.pop_back();
-	return listPosition_.begin();
+	return res;
+}
+
+void StgCurveLaserObject::NodeBuffer::_Grow(size_t capacity) {
+	capacity = Math::GetNextPow2(capacity);
+
+	std::vector<LaserNode> data(capacity);
+	for (size_t i = 0; i < count_; ++i)
+		data[i] = (*this)[i];
+
+	data_ = MOVE(data);
+	head_ = 0;
+	mask_ = capacity - 1U;
+}
+StgCurveLaserObject::LaserNode* StgCurveLaserObject::NodeBuffer::push_front(const LaserNode& node) {
+	if (data_.empty()) _Grow(1U);
+
+	//When full, the new head takes the slot of the oldest node
+	head_ = (head_ - 1U) & mask_;
+	count_ = std::min(count_ + 1U, data_.size());
+
+	LaserNode* res = &data_[head_];
+	*res = node;
+	return res;
 }
 
 void StgCurveLaserObject::_DeleteInAutoClip() {
@@ -2468,15 +2800,13 @@ void StgCurveLaserObject::_DeleteInAutoClip() {
 		rcStgFrame->GetWidth() + rcClipBase->right,
 		rcStgFrame->GetHeight() + rcClipBase->bottom);
 
-	//Checks if the node is within the bounding rect
-	auto PredicateNodeInRect = [&](LaserNode& node) {
-		return rcDeleteClip.IsPointIntersected((float*)&node.pos);
-	};
-	std::list<LaserNode>::iterator itrFind = std::find_if(listPosition_.begin(), listPosition_.end(),
-		PredicateNodeInRect);
+	//Checks if any node is within the bounding rect
+	bool bInRect = false;
+	for (size_t iNode = 0; iNode < listPosition_.size() && !bInRect; ++iNode)
+		bInRect = rcDeleteClip.IsPointIntersected((float*)&listPosition_[iNode].pos);
 
 	//Can't find any node within the bounding rect
-	if (itrFind == listPosition_.end()) {
+	if (!bInRect) {
 		auto objectManager = stageController_->GetMainObjectManager();
 		objectManager->DeleteObject(this);
 	}
@@ -2503,8 +2833,7 @@ bool StgCurveLaserObject::GetIntersectionTargetList_NoVector(StgShotData* shotDa
 	int posInvalidE = (int)(countPos * iLengthE);
 	float iWidth = widthIntersection_ * hitboxScale_.x;
 
-	std::list<LaserNode>::iterator itr = listPosition_.begin();
-	for (size_t iPos = 0; iPos < countIntersection; ++iPos, ++itr) {
+	for (size_t iPos = 0; iPos < countIntersection; ++iPos) {
 		IntersectionPairType* pPair = &listIntersectionTarget_[iPos];
 
 		if ((int)iPos < posInvalidS || (int)iPos > posInvalidE) {
@@ -2519,9 +2848,8 @@ bool StgCurveLaserObject::GetIntersectionTargetList_NoVector(StgShotData* shotDa
 		}
 		pPair->first = true;
 
-		std::list<LaserNode>::iterator itrNext = std::next(itr);
-		D3DXVECTOR2* nodeS = &itr->pos;
-		D3DXVECTOR2* nodeE = &itrNext->pos;
+		D3DXVECTOR2* nodeS = &listPosition_[iPos].pos;
+		D3DXVECTOR2* nodeE = &listPosition_[iPos + 1U].pos;
 
 		DxWidthLine* pDstLine = &pTarget->GetLine();
 		*pDstLine = DxWidthLine(nodeS->x, nodeS->y, nodeE->x, nodeE->y, iWidth);
@@ -2534,6 +2862,25 @@ bool StgCurveLaserObject::GetIntersectionTargetList_NoVector(StgShotData* shotDa
 
 	return true;
 }
+void StgCurveLaserObject::_RegistIntersectionTargetList(StgIntersectionManager* manager) {
+	if (targetChain_ == nullptr)
+		targetChain_.reset(new StgIntersectionTarget_Chain());
+
+	StgIntersectionTarget_Chain* pChain = targetChain_.get();
+	pChain->ClearTarget();
+	for (auto& iTarget : listIntersectionTarget_) {
+		if (iTarget.first && iTarget.second != nullptr)
+			pChain->AddTarget(iTarget.second);
+	}
+	if (pChain->GetTargetCount() == 0) return;
+
+	pChain->SetTargetType(typeOwner_ == OWNER_PLAYER ?
+		StgIntersectionTarget::TYPE_PLAYER_SHOT : StgIntersectionTarget::TYPE_ENEMY_SHOT);
+	pChain->SetObject(pOwnReference_);
+	pChain->SetIntersectionSpace();
+
+	manager->AddTarget(targetChain_);
+}
 
 void StgCurveLaserObject::Render(BlendMode targetBlend) {
 	//if (!IsVisible()) return;
@@ -2627,13 +2974,12 @@ void StgCurveLaserObject::Render(BlendMode targetBlend) {
 					size_t iPos = 0;
 					float remLen = rcMidPt;
 
-					auto tryCap = [&](auto itr) -> bool {
+					auto tryCap = [&](size_t iNode, size_t iNodeNext) -> bool {
 						if (i > halfPos) // Auto-fails if cap crosses the half-way point
 							return false;
 
-						auto itrNext = std::next(itr);
-						D3DXVECTOR2* pos = &itr->pos;
-						D3DXVECTOR2* posNext = &itrNext->pos;
+						D3DXVECTOR2* pos = &listPosition_[iNode].pos;
+						D3DXVECTOR2* posNext = &listPosition_[iNodeNext].pos;
 						// D3DXVECTOR2* off = &itr->vertOff[0];
 						// float wid = std::max(hypotf(off->x, off->y) * 2, 1.0f);
 						float incDist = hypotf(posNext->x - pos->x, posNext->y - pos->y) * incDistFactor;
@@ -2647,20 +2993,15 @@ void StgCurveLaserObject::Render(BlendMode targetBlend) {
 						return true;
 					};
 
-					auto itrHead = listPosition_.begin();
-					auto itrTail = listPosition_.rbegin();
-					auto itrHeadEnd = listPosition_.rend();
-					auto itrTailEnd = listPosition_.end();
-
 					bCappable = true;
-					for (auto itr = itrHead; bCappable && remLen > 0 && itr != itrTailEnd; ++itr, ++i, ++iPos)
-						bCappable = tryCap(itr);
+					for (size_t iNode = 0; bCappable && remLen > 0 && iNode < countPos; ++iNode, ++i, ++iPos)
+						bCappable = tryCap(iNode, iNode + 1U);
 
 					i = 0;
 					iPos = countPos - 2; // Ends straight up do not work otherwise?
 					remLen = rcMidPt;
-					for (auto itr = itrTail; bCappable && remLen > 0 && itr != itrHeadEnd; ++itr, ++i, --iPos)
-						bCappable = tryCap(itr);
+					for (size_t iNode = countPos; bCappable && remLen > 0 && iNode > 0; --iNode, ++i, --iPos)
+						bCappable = tryCap(iNode - 1U, iNode - 2U);
 				}
 				if (!bCappable) // If capping fails (or is disabled), just use the regular increment
 					std::fill(listRectIncrement_.begin(), listRectIncrement_.end(), rcInc);
@@ -2671,8 +3012,9 @@ void StgCurveLaserObject::Render(BlendMode targetBlend) {
 			float inv_halfPos = 1.0f / halfPos, inv_halfPosDec = 1.0f / (halfPos - 1);
 			float halfWidthRender = widthRender_ / 2.0f;
 
-			size_t iPos = 0U;
-			for (auto itr = listPosition_.begin(); itr != listPosition_.end(); ++itr, ++iPos) {
+			for (size_t iPos = 0U; iPos < countPos; ++iPos) {
+				const LaserNode* pNode = &listPosition_[iPos];
+
 				float nodeAlpha = baseAlpha;
 				if (iPos > halfPos)
 					nodeAlpha = Math::Lerp::Linear(baseAlpha, tipAlpha, (iPos - halfPos + 1) * inv_halfPos);
@@ -2680,21 +3022,21 @@ void StgCurveLaserObject::Render(BlendMode targetBlend) {
 					nodeAlpha = Math::Lerp::Linear(tipAlpha, baseAlpha, iPos * inv_halfPosDec);
 				nodeAlpha = std::max(0.0f, nodeAlpha);
 
-				float renderWd = std::max(halfWidthRender * itr->widthMul, 1.0f) * scale_.x;
+				float renderWd = std::max(halfWidthRender * pNode->widthMul, 1.0f) * scale_.x;
 
 				D3DCOLOR thisColor = 0xffffffff;
 				{
 					byte alpha = ColorAccess::ClampColorRet(nodeAlpha * alphaRateShot);
 					thisColor = (thisColor & 0x00ffffff) | (alpha << 24);
 				}
-				if (itr->color != 0xffffffff) ColorAccess::MultiplyColor(thisColor, itr->color);
+				if (pNode->color != 0xffffffff) ColorAccess::MultiplyColor(thisColor, pNode->color);
 
 				for (size_t iVert = 0U; iVert < 2U; ++iVert) {
 					VERTEX_TLX* pv = &vertexData_[iPos * 2 + iVert];
 
 					_SetVertexUV(pv, ptrSrc[(iVert & 1) << 1] * texSizeInv.x, rectV);
-					_SetVertexPosition(pv, itr->pos.x + itr->vertOff[iVert].x * renderWd,
-						itr->pos.y + itr->vertOff[iVert].y * renderWd, position_.z);
+					_SetVertexPosition(pv, pNode->pos.x + pNode->vertOff[iVert].x * renderWd,
+						pNode->pos.y + pNode->vertOff[iVert].y * renderWd, position_.z);
 					_SetVertexColorARGB(pv, thisColor);
 				}
 
@@ -2818,12 +3160,9 @@ void StgCurveLaserObject::_SendDeleteEvent(TypeDelete type) {
 		};
 
 		float lengthAcc = 0.0;
-		for (std::list<LaserNode>::iterator itr = listPosition_.begin(); itr != listPosition_.end(); itr++) {
-			std::list<LaserNode>::iterator itrNext = std::next(itr);
-			if (itrNext == listPosition_.end()) break;
-
-			D3DXVECTOR2* pos = &itr->pos;
-			D3DXVECTOR2* posNext = &itrNext->pos;
+		for (size_t iNode = 0; iNode + 1U < listPosition_.size(); ++iNode) {
+			D3DXVECTOR2* pos = &listPosition_[iNode].pos;
+			D3DXVECTOR2* posNext = &listPosition_[iNode + 1U].pos;
 			float nodeDist = hypotf(posNext->x - pos->x, posNext->y - pos->y);
 			lengthAcc += nodeDist;
 
@@ -2843,6 +3182,7 @@ void StgCurveLaserObject::_SendDeleteEvent(TypeDelete type) {
 //StgShotPatternGeneratorObject (ECL-style bullets firing)
 //****************************************************************************
 StgShotPatternGeneratorObject::StgShotPatternGeneratorObject(StgStageController* stageController) : StgObjectBase(stageController) {
+	_AddObjectClass<StgShotPatternGeneratorObject>(this);
 	typeObject_ = TypeObject::ShotPattern;
 
 	idShotData_ = -1;
@@ -10,6 +10,52 @@ class StgShotData;
 struct StgShotDataFrame;
 class StgShotVertexBufferContainer;
 class StgShotObject;
+//*******************************************************************
+//StgShotRenderBatch
+//*******************************************************************
+struct StgShotRenderInstance {
+	BlendMode blend;
+	StgShotDataFrame* frame;	//nullptr if the shot has nothing to draw
+	VERTEX_INSTANCE instance;
+};
+//Device-free draw list of one render queue.
+//	Consecutive shots of the same graphic frame in a blend pass are merged into one instanced draw,
+//	so every pass draws in queue order. Shots that can't be instanced are drawn individually.
+class StgShotRenderBatch {
+public:
+	enum {
+		BLEND_SLOT_COUNT = MODE_BLEND_ALPHA_INV + 1,
+	};
+
+	struct DrawItem {
+		StgShotObject* pShot;		//Drawn individually with Render(BlendMode) if not null
+		StgShotDataFrame* pFrame;
+		size_t instanceStart;
+		size_t instanceCount;
+	};
+private:
+	struct _PendingInstance {
+		BlendMode blend;
+		size_t item;
+		VERTEX_INSTANCE instance;
+	};
+
+	std::array<std::vector<DrawItem>, BLEND_SLOT_COUNT> listDraw_;
+
+	std::vector<_PendingInstance> listPending_;
+	std::vector<VERTEX_INSTANCE> listInstance_;
+public:
+	void Clear();
+	void AddShot(StgShotObject* shot);
+	//pInstance is null if the shot is drawn individually
+	void AddItem(StgShotObject* shot, const StgShotRenderInstance* pInstance);
+	void Finalize();
+	void Build(StgShotObject* const* listShot, size_t count);
+
+	const std::vector<DrawItem>& GetDrawList(BlendMode blend) const { return listDraw_[blend]; }
+	std::vector<VERTEX_INSTANCE>& GetInstanceList() { return listInstance_; }
+};
+
 //*******************************************************************
 //StgShotManager
 //*******************************************************************
@@ -45,6 +91,7 @@ protected:
 	struct RenderQueue {
 		size_t count;
 		std::vector<StgShotObject*> listShot;
+		StgShotRenderBatch batch;
 	};
 protected:
 	StgStageController* stageController_;
@@ -52,7 +99,13 @@ protected:
 	unique_ptr<StgShotDataList> listPlayerShotData_;
 	unique_ptr<StgShotDataList> listEnemyShotData_;
 
-	std::list<ref_unsync_ptr<StgShotObject>> listObj_;
+	//Registered shots, index-aligned with hotData_
+	std::vector<ref_unsync_ptr<StgShotObject>> listObj_;
+	StgHotDataTable hotData_;
+	StgHotDataIndex hotIndex_;
+
+	StgMoveBatch moveBatch_;
+
 	std::vector<RenderQueue> listRenderQueuePlayer_;		//one for each render pri
 	std::vector<RenderQueue> listRenderQueueEnemy_;			//one for each render pri
 
@@ -65,12 +118,17 @@ protected:
 
 	ID3DXEffect* effectShot_;
 	D3DXMATRIX matProj_;
+
+	template<class Pred> void _DeleteInRegion(int typeDelete, int typeTo, int typeOwner, 
+		const DxRect<double>* pBound, Pred&& pred);
+	template<class Pred> std::vector<int> _GetShotIdInRegion(int typeOwner, const DxRect<double>* pBound, Pred&& pred);
 public:
 	IDirect3DTexture9* pLastTexture_;
 public:
 	StgShotManager(StgStageController* stageController);
 	virtual ~StgShotManager();
 
+	void PrepareMoveBatch();
 	void Work();
 	void Render(int targetPriority);
 	void LoadRenderQueue();
@@ -97,10 +155,17 @@ public:
 	}
 
 	void DeleteInCircle(int typeDelete, int typeTo, int typeOwner, int cx, int cy, optional<int> radius);
+	void DeleteInRect(int typeDelete, int typeTo, int typeOwner, const DxRect<double>& rect);
+	void DeleteInLine(int typeDelete, int typeTo, int typeOwner, double x1, double y1, double x2, double y2, double width);
 	std::vector<int> GetShotIdInCircle(int typeOwner, int cx, int cy, optional<int> radius);
+	std::vector<int> GetShotIdInRect(int typeOwner, const DxRect<double>& rect);
+	std::vector<int> GetShotIdInLine(int typeOwner, double x1, double y1, double x2, double y2, double width);
 	size_t GetShotCount(int typeOwner);
 	size_t GetShotCountAll() { return listObj_.size(); }
 
+	StgHotDataTable* GetHotDataTable() { return &hotData_; }
+	StgMoveBatch* GetMoveBatch() { return &moveBatch_; }
+
 	void SetDeleteEventEnableByType(int type, bool bEnable);
 	bool IsDeleteEventEnable(TypeDelete bit) { return listDeleteEventEnable_[(int)bit]; }
 };
@@ -238,6 +303,7 @@ struct StgShotPatternTransform;
 class StgShotObject : public DxScriptShaderObject, public StgMoveObject, public StgIntersectionObject {
 protected:
 	using TypeDelete = StgShotManager::TypeDelete;
+	DECLARE_OBJECT_CLASS(StgShotObject, TypeClass::Shot);
 public:
 	enum {
 		OWNER_PLAYER = 0,
@@ -361,6 +427,10 @@ protected:
 	virtual void _SendDeleteEvent(TypeDelete type) {}
 	void _RequestPlayerDeleteEvent(int hitObjectID);
 
+	virtual void _OnDelete() {
+		if (pHotTable_) pHotTable_->SetFlag(idxHotData_, StgHotDataTable::FLAG_DELETED, true);
+	}
+
 	inline void _DefaultShotRender(StgShotData* shotData, StgShotDataFrame* shotFrame, const D3DXMATRIX& matWorld, D3DCOLOR color);
 protected:
 	std::list<StgShotPatternTransform> listTransformationShotAct_;
@@ -381,6 +451,8 @@ public:
 
 	virtual void Render() {};
 	virtual void Render(BlendMode targetBlend) = 0;
+	//Returns false if the shot can't be instanced and must be drawn with Render(BlendMode)
+	virtual bool GetRenderInstance(StgShotRenderInstance* pInstance) { return false; }
 
 	virtual void SetRenderTarget(shared_ptr<Texture> texture) { renderTarget_ = texture; }
 
@@ -391,9 +463,11 @@ public:
 	virtual void ClearShotObject() { ClearIntersectionRelativeTarget(); }
 	virtual void RegistIntersectionTarget() = 0;
 
-	virtual void SetX(float x) { posX_ = x; DxScriptRenderObject::SetX(x); }
-	virtual void SetY(float y) { posY_ = y; DxScriptRenderObject::SetY(y); }
+	virtual void SetX(float x) { SetPositionX(x); DxScriptRenderObject::SetX(x); }
+	virtual void SetY(float y) { SetPositionY(y); DxScriptRenderObject::SetY(y); }
 	virtual void SetColor(int r, int g, int b);
+
+	virtual bool IsSimpleMovement();
 	virtual void SetAlpha(int alpha);
 	virtual void SetRenderState() {}
 
@@ -406,7 +480,10 @@ public:
 	int GetShotDataID() { return idShotData_; }
 	virtual void SetShotDataID(int id) { idShotData_ = id; }
 	int GetOwnerType() { return typeOwner_; }
-	void SetOwnerType(int type) { typeOwner_ = type; }
+	void SetOwnerType(int type) {
+		typeOwner_ = type;
+		if (pHotTable_) pHotTable_->listType[idxHotData_] = type;
+	}
 
 	void SetGrazeInvalidFrame(int frame) { frameGrazeInvalidStart_ = frame; }
 	int GetGrazeInvalidFrame() { return frameGrazeInvalidStart_; }
@@ -448,7 +525,10 @@ public:
 	bool IsSpellFactor() { return bSpellFactor_; }
 	void SetSpellFactor(bool bSpell) { bSpellFactor_ = bSpell; }
 	bool IsSpellResist() { return bSpellResist_; }
-	void SetSpellResist(bool bSpell) { bSpellResist_ = bSpell; }
+	void SetSpellResist(bool bSpell) {
+		bSpellResist_ = bSpell;
+		if (pHotTable_) pHotTable_->SetFlag(idxHotData_, StgHotDataTable::FLAG_SPELL_RESIST, bSpell);
+	}
 
 	void SetUserIntersectionMode(bool b) { bUserIntersectionMode_ = b; }
 	void SetIntersectionEnable(bool b) { bIntersectionEnable_ = b; }
@@ -470,12 +550,25 @@ public:
 //*******************************************************************
 class StgNormalShotObject : public StgShotObject {
 	friend StgShotObject;
+protected:
+	struct RenderParameter {
+		BlendMode blend;
+		StgShotData* data;
+		StgShotDataFrame* frame;
+		D3DXVECTOR2 position;
+		D3DXVECTOR2 scale;
+		D3DCOLOR color;
+	};
 protected:
 	double angularVelocity_;
 	bool bFixedAngle_;
 
+	bool _LoadRenderParameter(RenderParameter* param);
+
 	void _AddIntersectionRelativeTarget();
 	virtual void _SendDeleteEvent(TypeDelete type);
+	DECLARE_POOL_ALLOCATOR(StgNormalShotObject, "Shot");
+	DECLARE_OBJECT_CLASS(StgNormalShotObject, TypeClass::NormalShot);
 public:
 	StgNormalShotObject(StgStageController* stageController);
 	virtual ~StgNormalShotObject();
@@ -484,6 +577,7 @@ public:
 
 	virtual void Work();
 	virtual void Render(BlendMode targetBlend);
+	virtual bool GetRenderInstance(StgShotRenderInstance* pInstance);
 
 	virtual void ClearShotObject() {
 		ClearIntersectionRelativeTarget();
@@ -518,6 +612,8 @@ protected:
 	float itemDistance_;
 
 	void _AddIntersectionRelativeTarget();
+	virtual void _RegistIntersectionTargetList(StgIntersectionManager* manager);
+	DECLARE_OBJECT_CLASS(StgLaserObject, TypeClass::Laser);
 public:
 	StgLaserObject(StgStageController* stageController);
 
@@ -563,6 +659,7 @@ protected:
 	virtual void _DeleteInAutoClip();
 	virtual void _Move();
 	virtual void _SendDeleteEvent(TypeDelete type);
+	DECLARE_POOL_ALLOCATOR(StgLooseLaserObject, "Shot");
 public:
 	StgLooseLaserObject(StgStageController* stageController);
 
@@ -596,6 +693,8 @@ protected:
 
 	virtual void _DeleteInAutoClip();
 	virtual void _SendDeleteEvent(TypeDelete type);
+	DECLARE_POOL_ALLOCATOR(StgStraightLaserObject, "Shot");
+	DECLARE_OBJECT_CLASS(StgStraightLaserObject, TypeClass::StraightLaser);
 public:
 	StgStraightLaserObject(StgStageController* stageController);
 
@@ -624,9 +723,11 @@ public:
 //StgCurveLaserObject (curvy lasers)
 //*******************************************************************
 class StgCurveLaserObject : public StgLaserObject {
+	DECLARE_POOL_ALLOCATOR(StgCurveLaserObject, "Shot");
+	DECLARE_OBJECT_CLASS(StgCurveLaserObject, TypeClass::CurveLaser);
 public:
 	struct LaserNode {
-		StgCurveLaserObject* parent;
+		int64_t handle = 0;		//Given to scripts in place of the node's address, 0 until the node is pushed
 		D3DXVECTOR2 pos;
 		D3DXVECTOR2 vertOff[2];
 		D3DCOLOR color;
@@ -636,8 +737,34 @@ public:
 		MAP_NORMAL,
 		MAP_CAPPED
 	};
+
+	//Contiguous ring of nodes, index 0 is the newest (head) node
+	//	Slots are reused and the storage can move, so scripts refer to nodes by handle, never by address
+	class NodeBuffer {
+		std::vector<LaserNode> data_;
+		size_t head_;
+		size_t count_;
+		size_t mask_;
+
+		void _Grow(size_t capacity);
+	public:
+		NodeBuffer() : head_(0), count_(0), mask_(0) {}
+
+		size_t size() const { return count_; }
+		bool empty() const { return count_ == 0; }
+		size_t capacity() const { return data_.size(); }
+
+		LaserNode& operator[](size_t index) { return data_[(head_ + index) & mask_]; }
+		const LaserNode& operator[](size_t index) const { return data_[(head_ + index) & mask_]; }
+
+		void clear() { head_ = 0; count_ = 0; }
+		void reserve(size_t capacity) { if (capacity > data_.size()) _Grow(capacity); }
+
+		LaserNode* push_front(const LaserNode& node);
+		void pop_back() { if (count_ > 0) --count_; }
+	};
 protected:
-	std::list<LaserNode> listPosition_;
+	NodeBuffer listPosition_;
 	std::vector<VERTEX_TLX> vertexData_;
 	std::vector<float> listRectIncrement_;
 
@@ -649,9 +776,17 @@ protected:
 
 	D3DXVECTOR2 posOrigin_;
 
+	//Handles are consecutive in push order, so a handle's ring index is its distance from the head's
+	int64_t handleNext_;
+	static int64_t _CreateNodeHandleBase();
+
+	//Groups the segment targets so the broad-phase sees one bound per laser
+	ref_unsync_ptr<StgIntersectionTarget_Chain> targetChain_;
+
 	virtual void _DeleteInAutoClip();
 	virtual void _Move();
 	virtual void _SendDeleteEvent(TypeDelete type);
+	virtual void _RegistIntersectionTargetList(StgIntersectionManager* manager);
 public:
 	StgCurveLaserObject(StgStageController* stageController);
 
@@ -666,9 +801,11 @@ public:
 	void SetTipCapping(bool enable) { bCap_ = enable; }
 
 	LaserNode CreateNode(const D3DXVECTOR2& pos, const D3DXVECTOR2& rFac, float widthMul, D3DCOLOR col = 0xffffffff);
-	bool GetNode(size_t indexNode, std::list<LaserNode>::iterator& res);
-	void GetNodePointerList(std::vector<LaserNode*>* listRes);
-	std::list<LaserNode>::iterator PushNode(const LaserNode& node);
+	LaserNode* GetNode(size_t indexNode);
+	//Returns nullptr if the node was dropped or belongs to another laser
+	LaserNode* GetNodeFromHandle(int64_t handle);
+	void GetNodeHandleList(std::vector<int64_t>* listRes);
+	LaserNode* PushNode(const LaserNode& node);
 };
 
 
@@ -676,6 +813,7 @@ public:
 //StgShotPatternGeneratorObject (ECL-style bullets firing)
 //*******************************************************************
 class StgShotPatternGeneratorObject : public DxScriptObjectBase, public StgObjectBase {
+	DECLARE_OBJECT_CLASS(StgShotPatternGeneratorObject, TypeClass::ShotPattern);
 public:
 	enum {
 		PATTERN_TYPE_FAN = 0,
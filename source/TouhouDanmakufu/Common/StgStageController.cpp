@@ -9,6 +9,10 @@
 StgStageController::StgStageController(StgSystemController* systemController) {
 	systemController_ = systemController;
 	infoSystem_ = systemController_->GetSystemInformation();
+
+	bReplayDesync_ = false;
+	frameReplayDesync_ = 0;
+	partReplayDesync_ = 0;
 }
 StgStageController::~StgStageController() {
 	if (scriptManager_) {
@@ -79,6 +83,8 @@ void StgStageController::Initialize(ref_count_ptr<StgStageStartData> startData)
 	if (!infoStage_->IsReplay()) {
 		uint32_t randSeed = infoStage_->GetRandProvider()->GetSeed();
 		replayStageData->SetRandSeed(randSeed);
+		replayStageData->SetStateDigestFormat(DnhConfiguration::GetInstance()->replayDigestInterval_,
+			StgStateDigest::PART_COUNT);
 		
 		if (infoLog)
 			infoLog->SetInfo(11, "Rand seed", StringUtility::Format("%08x", randSeed));
@@ -345,6 +351,7 @@ void StgStageController::Work() {
 
 			//Skip all this if the stage has already ended
 			if (infoStage_->IsEnd()) return;
+			shotManager_->PrepareMoveBatch();
 			objectManagerMain_->WorkObject();
 
 			enemyManager_->Work();
@@ -369,6 +376,7 @@ void StgStageController::Work() {
 					replayStageData->AddFramePerSecond(framePerSecond);
 				}
 			}
+			_UpdateStateDigest();
 
 			infoStage_->AdvanceFrame();
 		}
@@ -380,9 +388,25 @@ void StgStageController::Work() {
 	ELogger* logger = ELogger::GetInstance();
 	auto infoLog = logger->GetInfoPanel();
 
-	infoLog->SetInfo(6, "Shot count", std::to_string(shotManager_->GetShotCountAll()));
+	{
+		StgMoveBatch* moveBatch = shotManager_->GetMoveBatch();
+		infoLog->SetInfo(6, "Shot count", StringUtility::Format("%u (batched move: %u/%u)",
+			(uint32_t)shotManager_->GetShotCountAll(),
+			(uint32_t)moveBatch->GetAppliedCount(), (uint32_t)moveBatch->GetCount()));
+	}
 	infoLog->SetInfo(7, "Enemy count", std::to_string(enemyManager_->GetEnemyCount()));
 	infoLog->SetInfo(8, "Item count", std::to_string(itemManager_->GetItemCount()));
+
+	{
+		std::string poolInfo;
+		for (const char* group : { "Shot", "Item", "Target", "Move" }) {
+			size_t used, capacity;
+			ObjectPoolBase::GetGroupUsage(group, &used, &capacity);
+			if (poolInfo.size() > 0) poolInfo += ", ";
+			poolInfo += StringUtility::Format("%s: %u/%u", group, (uint32_t)used, (uint32_t)capacity);
+		}
+		infoLog->SetInfo(10, "Object pools", poolInfo);
+	}
 }
 void StgStageController::Render() {
 	bool bPause = infoStage_->IsPause();
@@ -398,6 +422,98 @@ void StgStageController::Render() {
 		pauseManager_->Render();
 	}
 }
+void StgStageController::_UpdateStateDigest() {
+	ref_count_ptr<ReplayInformation::StageData> replayStageData = infoStage_->GetReplayData();
+	uint32_t interval = replayStageData->GetStateDigestInterval();
+	if (interval == 0 || bReplayDesync_) return;
+
+	DWORD stageFrame = infoStage_->GetCurrentFrame();
+	if (stageFrame % interval != 0) return;
+
+	StgStateDigest digest;
+	ComputeStateDigest(&digest);
+
+	if (!infoStage_->IsReplay()) {
+		replayStageData->AddStateDigest(digest.listHash.data());
+		return;
+	}
+
+	//Recorded past the end of the replay, or with a different part layout
+	const uint64_t* listRecorded = replayStageData->GetStateDigest(stageFrame / interval);
+	if (listRecorded == nullptr) return;
+	size_t countPart = std::min<size_t>(replayStageData->GetStateDigestPartCount(), StgStateDigest::PART_COUNT);
+
+	for (size_t iPart = 0; iPart < countPart; ++iPart) {
+		if (listRecorded[iPart] == digest.listHash[iPart]) continue;
+
+		//Only the first divergence is meaningful, everything after it follows from it
+		bReplayDesync_ = true;
+		frameReplayDesync_ = stageFrame;
+		partReplayDesync_ = iPart;
+
+		std::string msg = StringUtility::Format("Frame %u (%s)", stageFrame, StgStateDigest::GetPartName(iPart));
+		Logger::WriteTop(ILogger::LogType::Warning, "Replay desync: " + msg);
+		if (auto infoLog = ELogger::GetInstance()->GetInfoPanel())
+			infoLog->SetInfo(12, "Replay desync", msg);
+		break;
+	}
+}
+void StgStageController::ComputeStateDigest(StgStateDigest* digest) {
+	auto& listHash = digest->listHash;
+	listHash.fill(StgStateDigest::HASH_INIT);
+
+	{
+		uint64_t& hash = listHash[StgStateDigest::PART_PLAYER];
+		hash = StgStateDigest::HashValue(infoStage_->GetScore(), hash);
+		hash = StgStateDigest::HashValue(infoStage_->GetGraze(), hash);
+		hash = StgStateDigest::HashValue(infoStage_->GetPoint(), hash);
+		if (ref_unsync_ptr<StgPlayerObject> objPlayer = GetPlayerObject()) {
+			hash = StgStateDigest::HashValue(objPlayer->GetX(), hash);
+			hash = StgStateDigest::HashValue(objPlayer->GetY(), hash);
+			hash = StgStateDigest::HashValue(objPlayer->GetState(), hash);
+			hash = StgStateDigest::HashValue(objPlayer->GetLife(), hash);
+			hash = StgStateDigest::HashValue(objPlayer->GetSpell(), hash);
+			hash = StgStateDigest::HashValue(objPlayer->GetPower(), hash);
+		}
+	}
+
+	listHash[StgStateDigest::PART_SHOT] = StgStateDigest::HashTable(shotManager_->GetHotDataTable(),
+		listHash[StgStateDigest::PART_SHOT]);
+	listHash[StgStateDigest::PART_ITEM] = StgStateDigest::HashTable(itemManager_->GetHotDataTable(),
+		listHash[StgStateDigest::PART_ITEM]);
+
+	{
+		uint64_t& hash = listHash[StgStateDigest::PART_ENEMY];
+		for (ref_unsync_ptr<StgEnemyObject>& obj : enemyManager_->GetEnemyList()) {
+			if (obj == nullptr || obj->IsDeleted()) continue;
+			hash = StgStateDigest::HashValue(obj->GetObjectID(), hash);
+			hash = StgStateDigest::HashValue(obj->GetPositionX(), hash);
+			hash = StgStateDigest::HashValue(obj->GetPositionY(), hash);
+			hash = StgStateDigest::HashValue(obj->GetLife(), hash);
+		}
+	}
+
+	{
+		uint64_t& hash = listHash[StgStateDigest::PART_RAND];
+		hash = StgStateDigest::Hash(infoStage_->GetRandProvider()->GetState(), sizeof(uint64_t) * 4, hash);
+	}
+
+	{
+		//Only the areas restored from the replay are guaranteed to match
+		uint64_t& hash = listHash[StgStateDigest::PART_COMMON_DATA];
+		ScriptCommonDataManager* commonDataManager = systemController_->GetCommonDataManager();
+		for (const std::string& area : infoStage_->GetReplayData()->GetCommonDataAreaList()) {
+			ScriptCommonDataArea* pArea = commonDataManager->GetArea(area);
+			if (pArea == nullptr) continue;
+
+			hash = StgStateDigest::Hash(area.data(), area.size(), hash);
+			for (auto& [key, val] : *pArea) {
+				hash = StgStateDigest::Hash(key.data(), key.size(), hash);
+				hash = StgStateDigest::HashScriptValue(val, hash);
+			}
+		}
+	}
+}
 void StgStageController::RenderToTransitionTexture() {
 	DirectGraphics* graphics = DirectGraphics::GetBase();
 	TextureManager* textureManager = ETextureManager::GetInstance();
@@ -35,7 +35,13 @@ private:
 	unique_ptr<StgItemManager> itemManager_;
 	unique_ptr<StgIntersectionManager> intersectionManager_;
 
+	//First frame whose state digest did not match the replay, and the part that differed
+	bool bReplayDesync_;
+	DWORD frameReplayDesync_;
+	size_t partReplayDesync_;
+
 	void _SetupReplayTargetCommonDataArea(shared_ptr<ManagedScript> pScript);
+	void _UpdateStateDigest();
 public:
 	StgStageController(StgSystemController* systemController);
 	virtual ~StgStageController();
@@ -48,6 +54,11 @@ public:
 
 	void RenderToTransitionTexture();
 
+	void ComputeStateDigest(StgStateDigest* digest);
+	bool IsReplayDesync() { return bReplayDesync_; }
+	DWORD GetReplayDesyncFrame() { return frameReplayDesync_; }
+	size_t GetReplayDesyncPart() { return partReplayDesync_; }
+
 	StgSystemController* GetSystemController() { return systemController_; }
 	ref_count_ptr<StgSystemInformation> GetSystemInformation() { return infoSystem_; }
 
@@ -311,6 +311,8 @@ static const std::vector<function> stgStageFunction = {
 	//STG共通関数：弾
 	{ "DeleteShotAll", StgStageScript::Func_DeleteShotAll, 2 },
 	{ "DeleteShotInCircle", StgStageScript::Func_DeleteShotInCircle, 5 },
+	{ "DeleteShotInRect", StgStageScript::Func_DeleteShotInRect, 6 },
+	{ "DeleteShotInLine", StgStageScript::Func_DeleteShotInLine, 7 },
 	{ "CreateShotA1", StgStageScript::Func_CreateShotA1, 6 },
 	{ "CreateShotA2", StgStageScript::Func_CreateShotA2, 8 }, //Deprecated, exists for compatibility
 	{ "CreateShotA2", StgStageScript::Func_CreateShotA2, 9 },
@@ -329,6 +331,10 @@ static const std::vector<function> stgStageFunction = {
 	{ "GetAllShotID", StgStageScript::Func_GetAllShotID, 1 },
 	{ "GetShotIdInCircleA1", StgStageScript::Func_GetShotIdInCircleA1, 3 },
 	{ "GetShotIdInCircleA2", StgStageScript::Func_GetShotIdInCircleA2, 4 },
+	{ "GetShotIdInRectA1", StgStageScript::Func_GetShotIdInRectA1, 4 },
+	{ "GetShotIdInRectA2", StgStageScript::Func_GetShotIdInRectA2, 5 },
+	{ "GetShotIdInLineA1", StgStageScript::Func_GetShotIdInLineA1, 5 },
+	{ "GetShotIdInLineA2", StgStageScript::Func_GetShotIdInLineA2, 6 },
 	{ "GetShotCount", StgStageScript::Func_GetShotCount, 1 },
 	{ "SetShotAutoDeleteClip", StgStageScript::Func_SetShotAutoDeleteClip, 4 },
 	{ "GetShotDataInfoA1", StgStageScript::Func_GetShotDataInfoA1, 3 },
@@ -351,6 +357,10 @@ static const std::vector<function> stgStageFunction = {
 	{ "GetAllItemID", StgStageScript::Func_GetAllItemID, 0 },
 	{ "GetItemIdInCircleA1", StgStageScript::Func_GetItemIdInCircleA1, 3 },
 	{ "GetItemIdInCircleA2", StgStageScript::Func_GetItemIdInCircleA2, 4 },
+	{ "GetItemIdInRectA1", StgStageScript::Func_GetItemIdInRectA1, 4 },
+	{ "GetItemIdInRectA2", StgStageScript::Func_GetItemIdInRectA2, 5 },
+	{ "GetItemIdInLineA1", StgStageScript::Func_GetItemIdInLineA1, 5 },
+	{ "GetItemIdInLineA2", StgStageScript::Func_GetItemIdInLineA2, 6 },
 	{ "SetItemAutoDeleteClip", StgStageScript::Func_SetItemAutoDeleteClip, 4 },
 	{ "SetItemTextureFilter", StgStageScript::Func_SetItemTextureFilter, 2 },
 
@@ -1529,6 +1539,61 @@ gstd::value StgStageScript::Func_DeleteShotInCircle(gstd::script_machine* machin
 
 	return value();
 }
+gstd::value StgStageScript::Func_DeleteShotInRect(gstd::script_machine* machine, int argc, const gstd::value* argv) {
+	StgStageScript* script = (StgStageScript*)machine->data;
+	StgStageController* stageController = script->stageController_;
+
+	int typeDel = argv[0].as_int();
+	int typeTo = argv[1].as_int();
+	DxRect<double> rect(argv[2].as_float(), argv[3].as_float(), 
+		argv[4].as_float(), argv[5].as_float());
+
+	switch (typeDel) {
+	case TYPE_ALL:typeDel = StgShotManager::DEL_TYPE_ALL; break;
+	case TYPE_SHOT:typeDel = StgShotManager::DEL_TYPE_SHOT; break;
+	case TYPE_CHILD:typeDel = StgShotManager::DEL_TYPE_CHILD; break;
+	}
+
+	switch (typeTo) {
+	case TYPE_IMMEDIATE:typeTo = StgShotManager::TO_TYPE_IMMEDIATE; break;
+	case TYPE_FADE:typeTo = StgShotManager::TO_TYPE_FADE; break;
+	case TYPE_ITEM:typeTo = StgShotManager::TO_TYPE_ITEM; break;
+	}
+
+	stageController->GetShotManager()->DeleteInRect(typeDel, typeTo, 
+		StgShotObject::OWNER_ENEMY, rect);
+
+	return value();
+}
+gstd::value StgStageScript::Func_DeleteShotInLine(gstd::script_machine* machine, int argc, const gstd::value* argv) {
+	StgStageScript* script = (StgStageScript*)machine->data;
+	StgStageController* stageController = script->stageController_;
+
+	int typeDel = argv[0].as_int();
+	int typeTo = argv[1].as_int();
+	double x1 = argv[2].as_float();
+	double y1 = argv[3].as_float();
+	double x2 = argv[4].as_float();
+	double y2 = argv[5].as_float();
+	double width = argv[6].as_float();
+
+	switch (typeDel) {
+	case TYPE_ALL:typeDel = StgShotManager::DEL_TYPE_ALL; break;
+	case TYPE_SHOT:typeDel = StgShotManager::DEL_TYPE_SHOT; break;
+	case TYPE_CHILD:typeDel = StgShotManager::DEL_TYPE_CHILD; break;
+	}
+
+	switch (typeTo) {
+	case TYPE_IMMEDIATE:typeTo = StgShotManager::TO_TYPE_IMMEDIATE; break;
+	case TYPE_FADE:typeTo = StgShotManager::TO_TYPE_FADE; break;
+	case TYPE_ITEM:typeTo = StgShotManager::TO_TYPE_ITEM; break;
+	}
+
+	stageController->GetShotManager()->DeleteInLine(typeDel, typeTo, 
+		StgShotObject::OWNER_ENEMY, x1, y1, x2, y2, width);
+
+	return value();
+}
 gstd::value StgStageScript::Func_CreateShotA1(gstd::script_machine* machine, int argc, const gstd::value* argv) {
 	StgStageScript* script = (StgStageScript*)machine->data;
 	StgStageController* stageController = script->stageController_;
@@ -2090,6 +2155,74 @@ gstd::value StgStageScript::Func_GetShotIdInCircleA2(gstd::script_machine* machi
 	std::vector<int> listID = shotManager->GetShotIdInCircle(typeOwner, px, py, radius);
 	return script->CreateIntArrayValue(listID);
 }
+gstd::value StgStageScript::Func_GetShotIdInRectA1(gstd::script_machine* machine, int argc, const gstd::value* argv) {
+	StgStageScript* script = (StgStageScript*)machine->data;
+	StgStageController* stageController = script->stageController_;
+
+	StgShotManager* shotManager = stageController->GetShotManager();
+	DxRect<double> rect(argv[0].as_float(), argv[1].as_float(), 
+		argv[2].as_float(), argv[3].as_float());
+	int typeOwner = script->GetScriptType() == TYPE_PLAYER ? StgShotObject::OWNER_PLAYER : StgShotObject::OWNER_ENEMY;
+
+	std::vector<int> listID = shotManager->GetShotIdInRect(typeOwner, rect);
+	return script->CreateIntArrayValue(listID);
+}
+gstd::value StgStageScript::Func_GetShotIdInRectA2(gstd::script_machine* machine, int argc, const gstd::value* argv) {
+	StgStageScript* script = (StgStageScript*)machine->data;
+	StgStageController* stageController = script->stageController_;
+
+	StgShotManager* shotManager = stageController->GetShotManager();
+	DxRect<double> rect(argv[0].as_float(), argv[1].as_float(), 
+		argv[2].as_float(), argv[3].as_float());
+	int target = argv[4].as_int();
+
+	int typeOwner = StgShotObject::OWNER_NULL;
+	switch (target) {
+	case TARGET_ALL:typeOwner = StgShotObject::OWNER_NULL; break;
+	case TARGET_PLAYER:typeOwner = StgShotObject::OWNER_PLAYER; break;
+	case TARGET_ENEMY:typeOwner = StgShotObject::OWNER_ENEMY; break;
+	}
+
+	std::vector<int> listID = shotManager->GetShotIdInRect(typeOwner, rect);
+	return script->CreateIntArrayValue(listID);
+}
+gstd::value StgStageScript::Func_GetShotIdInLineA1(gstd::script_machine* machine, int argc, const gstd::value* argv) {
+	StgStageScript* script = (StgStageScript*)machine->data;
+	StgStageController* stageController = script->stageController_;
+
+	StgShotManager* shotManager = stageController->GetShotManager();
+	double x1 = argv[0].as_float();
+	double y1 = argv[1].as_float();
+	double x2 = argv[2].as_float();
+	double y2 = argv[3].as_float();
+	double width = argv[4].as_float();
+	int typeOwner = script->GetScriptType() == TYPE_PLAYER ? StgShotObject::OWNER_PLAYER : StgShotObject::OWNER_ENEMY;
+
+	std::vector<int> listID = shotManager->GetShotIdInLine(typeOwner, x1, y1, x2, y2, width);
+	return script->CreateIntArrayValue(listID);
+}
+gstd::value StgStageScript::Func_GetShotIdInLineA2(gstd::script_machine* machine, int argc, const gstd::value* argv) {
+	StgStageScript* script = (StgStageScript*)machine->data;
+	StgStageController* stageController = script->stageController_;
+
+	StgShotManager* shotManager = stageController->GetShotManager();
+	double x1 = argv[0].as_float();
+	double y1 = argv[1].as_float();
+	double x2 = argv[2].as_float();
+	double y2 = argv[3].as_float();
+	double width = argv[4].as_float();
+	int target = argv[5].as_int();
+
+	int typeOwner = StgShotObject::OWNER_NULL;
+	switch (target) {
+	case TARGET_ALL:typeOwner = StgShotObject::OWNER_NULL; break;
+	case TARGET_PLAYER:typeOwner = StgShotObject::OWNER_PLAYER; break;
+	case TARGET_ENEMY:typeOwner = StgShotObject::OWNER_ENEMY; break;
+	}
+
+	std::vector<int> listID = shotManager->GetShotIdInLine(typeOwner, x1, y1, x2, y2, width);
+	return script->CreateIntArrayValue(listID);
+}
 gstd::value StgStageScript::Func_GetShotCount(gstd::script_machine* machine, int argc, const gstd::value* argv) {
 	StgStageScript* script = (StgStageScript*)machine->data;
 	StgStageController* stageController = script->stageController_;
@@ -2475,6 +2608,54 @@ gstd::value StgStageScript::Func_GetItemIdInCircleA2(gstd::script_machine* machi
 	std::vector<int> listID = itemManager->GetItemIdInCircle(px, py, radius, type);
 	return script->CreateIntArrayValue(listID);
 }
+gstd::value StgStageScript::Func_GetItemIdInRectA1(gstd::script_machine* machine, int argc, const gstd::value* argv) {
+	StgStageScript* script = (StgStageScript*)machine->data;
+	StgItemManager* itemManager = script->stageController_->GetItemManager();
+
+	DxRect<double> rect(argv[0].as_float(), argv[1].as_float(), 
+		argv[2].as_float(), argv[3].as_float());
+
+	std::vector<int> listID = itemManager->GetItemIdInRect(rect, {});
+	return script->CreateIntArrayValue(listID);
+}
+gstd::value StgStageScript::Func_GetItemIdInRectA2(gstd::script_machine* machine, int argc, const gstd::value* argv) {
+	StgStageScript* script = (StgStageScript*)machine->data;
+	StgItemManager* itemManager = script->stageController_->GetItemManager();
+
+	DxRect<double> rect(argv[0].as_float(), argv[1].as_float(), 
+		argv[2].as_float(), argv[3].as_float());
+	int type = argv[4].as_int();
+
+	std::vector<int> listID = itemManager->GetItemIdInRect(rect, type);
+	return script->CreateIntArrayValue(listID);
+}
+gstd::value StgStageScript::Func_GetItemIdInLineA1(gstd::script_machine* machine, int argc, const gstd::value* argv) {
+	StgStageScript* script = (StgStageScript*)machine->data;
+	StgItemManager* itemManager = script->stageController_->GetItemManager();
+
+	double x1 = argv[0].as_float();
+	double y1 = argv[1].as_float();
+	double x2 = argv[2].as_float();
+	double y2 = argv[3].as_float();
+	double width = argv[4].as_float();
+
+	std::vector<int> listID = itemManager->GetItemIdInLine(x1, y1, x2, y2, width, {});
+	return script->CreateIntArrayValue(listID);
+}
+gstd::value StgStageScript::Func_GetItemIdInLineA2(gstd::script_machine* machine, int argc, const gstd::value* argv) {
+	StgStageScript* script = (StgStageScript*)machine->data;
+	StgItemManager* itemManager = script->stageController_->GetItemManager();
+
+	double x1 = argv[0].as_float();
+	double y1 = argv[1].as_float();
+	double x2 = argv[2].as_float();
+	double y2 = argv[3].as_float();
+	double width = argv[4].as_float();
+	int type = argv[5].as_int();
+
+	std::vector<int> listID = itemManager->GetItemIdInLine(x1, y1, x2, y2, width, type);
+	return script->CreateIntArrayValue(listID);
+}
 gstd::value StgStageScript::Func_SetItemAutoDeleteClip(gstd::script_machine* machine, int argc, const gstd::value* argv) {
 	StgStageScript* script = (StgStageScript*)machine->data;
 	StgStageController* stageController = script->stageController_;
@@ -2699,8 +2880,7 @@ lab_return:
 gstd::value StgStageScript::Func_ObjMove_SetAngle(gstd::script_machine* machine, int argc, const gstd::value* argv) {
 	StgStageScript* script = (StgStageScript*)machine->data;
 	int id = argv[0].as_int();
-	DxScriptObjectBase* objBase = script->GetObjectPointer(id);
-	StgMoveObject* obj = dynamic_cast<StgMoveObject*>(objBase);
+	StgMoveObject* obj = script->GetObjectPointerAs<StgMoveObject>(id);
 	if (obj) {
 		double angle = Math::DegreeToRadian(argv[1].as_float());
 
@@ -4633,7 +4813,7 @@ gstd::value StgStageScript::Func_ObjShot_SetDelayScalingEnable(gstd::script_mach
 gstd::value StgStageScript::Func_ObjShot_SetGrazeInvalidFrame(gstd::script_machine* machine, int argc, const gstd::value* argv) {
 	StgStageScript* script = (StgStageScript*)machine->data;
 	int id = argv[0].as_int();
-	if (StgShotObject* obj = dynamic_cast<StgShotObject*>(script->GetObjectPointer(id))) {
+	if (StgShotObject* obj = script->GetObjectPointerAs<StgShotObject>(id)) {
 		int frame = argv[1].as_int();
 		obj->SetGrazeInvalidFrame(frame);
 	}
@@ -4642,7 +4822,7 @@ gstd::value StgStageScript::Func_ObjShot_SetGrazeInvalidFrame(gstd::script_machi
 gstd::value StgStageScript::Func_ObjShot_SetGrazeFrame(gstd::script_machine* machine, int argc, const gstd::value* argv) {
 	StgStageScript* script = (StgStageScript*)machine->data;
 	int id = argv[0].as_int();
-	if (StgShotObject* obj = dynamic_cast<StgShotObject*>(script->GetObjectPointer(id))) {
+	if (StgShotObject* obj = script->GetObjectPointerAs<StgShotObject>(id)) {
 		int frame = argv[1].as_int();
 		obj->SetGrazeFrame(frame);
 	}
@@ -4653,7 +4833,7 @@ gstd::value StgStageScript::Func_ObjShot_IsValidGraze(gstd::script_machine* mach
 	int id = argv[0].as_int();
 
 	bool res = false;
-	if (StgShotObject* obj = dynamic_cast<StgShotObject*>(script->GetObjectPointer(id)))
+	if (StgShotObject* obj = script->GetObjectPointerAs<StgShotObject>(id))
 		res = obj->IsValidGraze();
 
 	return script->CreateBooleanValue(res);
@@ -4661,7 +4841,7 @@ gstd::value StgStageScript::Func_ObjShot_IsValidGraze(gstd::script_machine* mach
 gstd::value StgStageScript::Func_ObjShot_SetPenetrateShotEnable(gstd::script_machine* machine, int argc, const gstd::value* argv) {
 	StgStageScript* script = (StgStageScript*)machine->data;
 	int id = argv[0].as_int();
-	if (StgShotObject* obj = dynamic_cast<StgShotObject*>(script->GetObjectPointer(id))) {
+	if (StgShotObject* obj = script->GetObjectPointerAs<StgShotObject>(id)) {
 		bool enable = argv[1].as_boolean();
 		obj->SetPenetrateShotEnable(enable);
 	}
@@ -4670,7 +4850,7 @@ gstd::value StgStageScript::Func_ObjShot_SetPenetrateShotEnable(gstd::script_mac
 gstd::value StgStageScript::Func_ObjShot_SetEnemyIntersectionInvalidFrame(gstd::script_machine* machine, int argc, const gstd::value* argv) {
 	StgStageScript* script = (StgStageScript*)machine->data;
 	int id = argv[0].as_int();
-	if (StgShotObject* obj = dynamic_cast<StgShotObject*>(script->GetObjectPointer(id))) {
+	if (StgShotObject* obj = script->GetObjectPointerAs<StgShotObject>(id)) {
 		int frame = argv[1].as_int();
 		obj->SetEnemyIntersectionInvalidFrame(frame);
 	}
@@ -4679,7 +4859,7 @@ gstd::value StgStageScript::Func_ObjShot_SetEnemyIntersectionInvalidFrame(gstd::
 gstd::value StgStageScript::Func_ObjShot_SetFixedAngle(gstd::script_machine* machine, int argc, const gstd::value* argv) {
 	StgStageScript* script = (StgStageScript*)machine->data;
 	int id = argv[0].as_int();
-	if (StgNormalShotObject* obj = dynamic_cast<StgNormalShotObject*>(script->GetObjectPointer(id))) {
+	if (StgNormalShotObject* obj = script->GetObjectPointerAs<StgNormalShotObject>(id)) {
 		bool bFix = argv[1].as_boolean();
 		obj->SetFixedAngle(bFix);
 	}
@@ -4688,7 +4868,7 @@ gstd::value StgStageScript::Func_ObjShot_SetFixedAngle(gstd::script_machine* mac
 gstd::value StgStageScript::Func_ObjShot_SetSpinAngularVelocity(gstd::script_machine* machine, int argc, const gstd::value* argv) {
 	StgStageScript* script = (StgStageScript*)machine->data;
 	int id = argv[0].as_int();
-	if (StgNormalShotObject* obj = dynamic_cast<StgNormalShotObject*>(script->GetObjectPointer(id))) {
+	if (StgNormalShotObject* obj = script->GetObjectPointerAs<StgNormalShotObject>(id)) {
 		double spin = argv[1].as_float();
 		obj->SetGraphicAngularVelocity(Math::DegreeToRadian(spin));
 	}
@@ -4697,7 +4877,7 @@ gstd::value StgStageScript::Func_ObjShot_SetSpinAngularVelocity(gstd::script_mac
 gstd::value StgStageScript::Func_ObjShot_SetDelayAngularVelocity(gstd::script_machine* machine, int argc, const gstd::value* argv) {
 	StgStageScript* script = (StgStageScript*)machine->data;
 	int id = argv[0].as_int();
-	if (StgShotObject* obj = dynamic_cast<StgShotObject*>(script->GetObjectPointer(id))) {
+	if (StgShotObject* obj = script->GetObjectPointerAs<StgShotObject>(id)) {
 		double wvel = argv[1].as_float();
 		obj->SetDelayAngularVelocity(Math::DegreeToRadian(wvel));
 	}
@@ -4878,30 +5058,29 @@ gstd::value StgStageScript::Func_ObjCrLaser_SetTipCapping(gstd::script_machine*
 gstd::value StgStageScript::Func_ObjCrLaser_GetNodePointer(gstd::script_machine* machine, int argc, const gstd::value* argv) {
 	StgStageScript* script = (StgStageScript*)machine->data;
 
-	StgCurveLaserObject::LaserNode* res = nullptr;
+	int64_t res = 0;
 
 	int id = argv[0].as_int();
 	StgCurveLaserObject* obj = script->GetObjectPointerAs<StgCurveLaserObject>(id);
 	if (obj) {
 		int index = argv[1].as_int();
 		if (index >= 0) {
-			std::list<StgCurveLaserObject::LaserNode>::iterator itr;
-			bool bValidIndex = obj->GetNode(index, itr);
-			res = bValidIndex ? &*itr : nullptr;
+			if (StgCurveLaserObject::LaserNode* node = obj->GetNode(index))
+				res = node->handle;
 		}
 	}
 
-	return script->CreateIntValue((int64_t)res);
+	return script->CreateIntValue(res);
 }
 gstd::value StgStageScript::Func_ObjCrLaser_GetNodePointerList(gstd::script_machine* machine, int argc, const gstd::value* argv) {
 	StgStageScript* script = (StgStageScript*)machine->data;
 
-	std::vector<StgCurveLaserObject::LaserNode*> res;
+	std::vector<int64_t> res;
 
 	int id = argv[0].as_int();
 	StgCurveLaserObject* obj = script->GetObjectPointerAs<StgCurveLaserObject>(id);
 	if (obj) {
-		obj->GetNodePointerList(&res);
+		obj->GetNodeHandleList(&res);
 	}
 
 	return script->CreateIntArrayValue(res);
@@ -4913,8 +5092,8 @@ gstd::value StgStageScript::Func_ObjCrLaser_GetNodePosition(gstd::script_machine
 	int id = argv[0].as_int();
 	StgCurveLaserObject* obj = script->GetObjectPointerAs<StgCurveLaserObject>(id);
 	if (obj) {
-		StgCurveLaserObject::LaserNode* ptr = (StgCurveLaserObject::LaserNode*)argv[1].as_int();
-		if (ptr && ptr->parent == obj) {
+		StgCurveLaserObject::LaserNode* ptr = obj->GetNodeFromHandle(argv[1].as_int());
+		if (ptr) {
 			res[0] = ptr->pos.x;
 			res[1] = ptr->pos.y;
 		}
@@ -4928,8 +5107,8 @@ gstd::value StgStageScript::Func_ObjCrLaser_GetNodeAngle(gstd::script_machine* m
 	int id = argv[0].as_int();
 	StgCurveLaserObject* obj = script->GetObjectPointerAs<StgCurveLaserObject>(id);
 	if (obj) {
-		StgCurveLaserObject::LaserNode* ptr = (StgCurveLaserObject::LaserNode*)argv[1].as_int();
-		if (ptr && ptr->parent == obj) {
+		StgCurveLaserObject::LaserNode* ptr = obj->GetNodeFromHandle(argv[1].as_int());
+		if (ptr) {
 			D3DXVECTOR2& vec = ptr->vertOff[0];
 			angle = Math::RadianToDegree(atan2(vec.y, vec.x)) + 90.0;
 		}
@@ -4943,8 +5122,8 @@ gstd::value StgStageScript::Func_ObjCrLaser_GetNodeWidthScale(gstd::script_machi
 	int id = argv[0].as_int();
 	StgCurveLaserObject* obj = script->GetObjectPointerAs<StgCurveLaserObject>(id);
 	if (obj) {
-		StgCurveLaserObject::LaserNode* ptr = (StgCurveLaserObject::LaserNode*)argv[1].as_int();
-		if (ptr && ptr->parent == obj) {
+		StgCurveLaserObject::LaserNode* ptr = obj->GetNodeFromHandle(argv[1].as_int());
+		if (ptr) {
 			width = ptr->widthMul;
 		}
 	}
@@ -4957,8 +5136,8 @@ gstd::value StgStageScript::Func_ObjCrLaser_GetNodeColor(gstd::script_machine* m
 	int id = argv[0].as_int();
 	StgCurveLaserObject* obj = script->GetObjectPointerAs<StgCurveLaserObject>(id);
 	if (obj) {
-		StgCurveLaserObject::LaserNode* ptr = (StgCurveLaserObject::LaserNode*)argv[1].as_int();
-		if (ptr && ptr->parent == obj) {
+		StgCurveLaserObject::LaserNode* ptr = obj->GetNodeFromHandle(argv[1].as_int());
+		if (ptr) {
 			color = ptr->color;
 		}
 	}
@@ -4974,8 +5153,8 @@ gstd::value StgStageScript::Func_ObjCrLaser_GetNodeColorHex(gstd::script_machine
 	int id = argv[0].as_int();
 	StgCurveLaserObject* obj = script->GetObjectPointerAs<StgCurveLaserObject>(id);
 	if (obj) {
-		StgCurveLaserObject::LaserNode* ptr = (StgCurveLaserObject::LaserNode*)argv[1].as_int();
-		if (ptr && ptr->parent == obj) {
+		StgCurveLaserObject::LaserNode* ptr = obj->GetNodeFromHandle(argv[1].as_int());
+		if (ptr) {
 			color = ptr->color;
 		}
 	}
@@ -4987,8 +5166,8 @@ gstd::value StgStageScript::Func_ObjCrLaser_SetNode(gstd::script_machine* machin
 	int id = argv[0].as_int();
 	StgCurveLaserObject* obj = script->GetObjectPointerAs<StgCurveLaserObject>(id);
 	if (obj) {
-		StgCurveLaserObject::LaserNode* ptr = (StgCurveLaserObject::LaserNode*)argv[1].as_int();
-		if (ptr && ptr->parent == obj) {
+		StgCurveLaserObject::LaserNode* ptr = obj->GetNodeFromHandle(argv[1].as_int());
+		if (ptr) {
 			float x = argv[2].as_float();
 			float y = argv[3].as_float();
 			float angle = Math::DegreeToRadian(argv[4].as_float());
@@ -4999,6 +5178,7 @@ gstd::value StgStageScript::Func_ObjCrLaser_SetNode(gstd::script_machine* machin
 			D3DXVECTOR2 rMove = D3DXVECTOR2(-sinf(angle), cosf(angle));
 
 			StgCurveLaserObject::LaserNode node = obj->CreateNode(D3DXVECTOR2(x, y), rMove, width, color);
+			node.handle = ptr->handle;
 			*ptr = node;
 		}
 	}
@@ -5009,8 +5189,8 @@ gstd::value StgStageScript::Func_ObjCrLaser_SetNodePosition(gstd::script_machine
 	int id = argv[0].as_int();
 	StgCurveLaserObject* obj = script->GetObjectPointerAs<StgCurveLaserObject>(id);
 	if (obj) {
-		StgCurveLaserObject::LaserNode* ptr = (StgCurveLaserObject::LaserNode*)argv[1].as_int();
-		if (ptr && ptr->parent == obj) {
+		StgCurveLaserObject::LaserNode* ptr = obj->GetNodeFromHandle(argv[1].as_int());
+		if (ptr) {
 			float x = argv[2].as_float();
 			float y = argv[3].as_float();
 			ptr->pos = D3DXVECTOR2(x, y);
@@ -5023,8 +5203,8 @@ gstd::value StgStageScript::Func_ObjCrLaser_SetNodeAngle(gstd::script_machine* m
 	int id = argv[0].as_int();
 	StgCurveLaserObject* obj = script->GetObjectPointerAs<StgCurveLaserObject>(id);
 	if (obj) {
-		StgCurveLaserObject::LaserNode* ptr = (StgCurveLaserObject::LaserNode*)argv[1].as_int();
-		if (ptr && ptr->parent == obj) {
+		StgCurveLaserObject::LaserNode* ptr = obj->GetNodeFromHandle(argv[1].as_int());
+		if (ptr) {
 			float angle = Math::DegreeToRadian(argv[2].as_float());
 			D3DXVECTOR2 rMove = D3DXVECTOR2(-sinf(angle), cosf(angle));
 
@@ -5039,8 +5219,8 @@ gstd::value StgStageScript::Func_ObjCrLaser_SetNodeWidthScale(gstd::script_machi
 	int id = argv[0].as_int();
 	StgCurveLaserObject* obj = script->GetObjectPointerAs<StgCurveLaserObject>(id);
 	if (obj) {
-		StgCurveLaserObject::LaserNode* ptr = (StgCurveLaserObject::LaserNode*)argv[1].as_int();
-		if (ptr && ptr->parent == obj) {
+		StgCurveLaserObject::LaserNode* ptr = obj->GetNodeFromHandle(argv[1].as_int());
+		if (ptr) {
 			float width = argv[2].as_float();
 			ptr->widthMul = width;
 		}
@@ -5052,8 +5232,8 @@ gstd::value StgStageScript::Func_ObjCrLaser_SetNodeColor(gstd::script_machine* m
 	int id = argv[0].as_int();
 	StgCurveLaserObject* obj = script->GetObjectPointerAs<StgCurveLaserObject>(id);
 	if (obj) {
-		StgCurveLaserObject::LaserNode* ptr = (StgCurveLaserObject::LaserNode*)argv[1].as_int();
-		if (ptr && ptr->parent == obj) {
+		StgCurveLaserObject::LaserNode* ptr = obj->GetNodeFromHandle(argv[1].as_int());
+		if (ptr) {
 			D3DCOLOR color = argv[2].as_int();
 			ptr->color = color;
 		}
@@ -5615,7 +5795,7 @@ gstd::value StgStageScript::Func_ObjCol_GetListOfIntersectedEnemyID(gstd::script
 		std::vector<ref_unsync_weak_ptr<StgIntersectionObject>>& listIntersection = obj->GetIntersectedIdList();
 		for (auto& wPtr : listIntersection) {
 			if (!wPtr.expired()) {
-				if (StgEnemyObject* objEnemy = dynamic_cast<StgEnemyObject*>(wPtr.get()))
+				if (StgEnemyObject* objEnemy = wPtr->GetObjectAs<StgEnemyObject>())
 					listObjectID.push_back(objEnemy->GetDxScriptObjectID());
 			}
 		}
@@ -5632,7 +5812,7 @@ gstd::value StgStageScript::Func_ObjCol_GetListOfIntersectedShotID(gstd::script_
 		std::vector<ref_unsync_weak_ptr<StgIntersectionObject>>& listIntersection = obj->GetIntersectedIdList();
 		for (auto& wPtr : listIntersection) {
 			if (!wPtr.expired()) {
-				if (StgShotObject* objShot = dynamic_cast<StgShotObject*>(wPtr.get())) {
+				if (StgShotObject* objShot = wPtr->GetObjectAs<StgShotObject>()) {
 					if (objShot->GetOwnerType() == type)
 						listObjectID.push_back(objShot->GetDxScriptObjectID());
 				}
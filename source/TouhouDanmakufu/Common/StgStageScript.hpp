@@ -260,6 +260,8 @@ public:
 	//STG共通関数：弾
 	static gstd::value Func_DeleteShotAll(gstd::script_machine* machine, int argc, const gstd::value* argv);
 	static gstd::value Func_DeleteShotInCircle(gstd::script_machine* machine, int argc, const gstd::value* argv);
+	DNH_FUNCAPI_DECL_(Func_DeleteShotInRect);
+	DNH_FUNCAPI_DECL_(Func_DeleteShotInLine);
 	static gstd::value Func_CreateShotA1(gstd::script_machine* machine, int argc, const gstd::value* argv);
 	static gstd::value Func_CreateShotA2(gstd::script_machine* machine, int argc, const gstd::value* argv);
 	static gstd::value Func_CreateShotOA1(gstd::script_machine* machine, int argc, const gstd::value* argv);
@@ -277,6 +279,10 @@ public:
 	DNH_FUNCAPI_DECL_(Func_GetAllShotID);
 	static gstd::value Func_GetShotIdInCircleA1(gstd::script_machine* machine, int argc, const gstd::value* argv);
 	static gstd::value Func_GetShotIdInCircleA2(gstd::script_machine* machine, int argc, const gstd::value* argv);
+	DNH_FUNCAPI_DECL_(Func_GetShotIdInRectA1);
+	DNH_FUNCAPI_DECL_(Func_GetShotIdInRectA2);
+	DNH_FUNCAPI_DECL_(Func_GetShotIdInLineA1);
+	DNH_FUNCAPI_DECL_(Func_GetShotIdInLineA2);
 	static gstd::value Func_GetShotCount(gstd::script_machine* machine, int argc, const gstd::value* argv);
 	static gstd::value Func_SetShotAutoDeleteClip(gstd::script_machine* machine, int argc, const gstd::value* argv);
 	static gstd::value Func_GetShotDataInfoA1(gstd::script_machine* machine, int argc, const gstd::value* argv);
@@ -299,6 +305,10 @@ public:
 	DNH_FUNCAPI_DECL_(Func_GetAllItemID);
 	DNH_FUNCAPI_DECL_(Func_GetItemIdInCircleA1);
 	DNH_FUNCAPI_DECL_(Func_GetItemIdInCircleA2);
+	DNH_FUNCAPI_DECL_(Func_GetItemIdInRectA1);
+	DNH_FUNCAPI_DECL_(Func_GetItemIdInRectA2);
+	DNH_FUNCAPI_DECL_(Func_GetItemIdInLineA1);
+	DNH_FUNCAPI_DECL_(Func_GetItemIdInLineA2);
 	DNH_FUNCAPI_DECL_(Func_SetItemAutoDeleteClip);
 	DNH_FUNCAPI_DECL_(Func_SetItemTextureFilter);
 
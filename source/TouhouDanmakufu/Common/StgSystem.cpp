@@ -144,7 +144,9 @@ void StgSystemController::Work() {
 		if (infoSystem_->IsError()) {
 			std::wstring error = infoSystem_->GetErrorMessage();
 			if (error.size() > 0) {
-				ErrorDialog::ShowErrorDialog(error);
+				//Headless runs report the error from DoEnd instead of blocking on a dialog
+				if (!DnhConfiguration::GetInstance()->bHeadless_)
+					ErrorDialog::ShowErrorDialog(error);
 			}
 			else {
 				bRetry = true;
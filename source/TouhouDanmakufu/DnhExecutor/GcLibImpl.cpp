@@ -11,6 +11,12 @@
 //*******************************************************************
 EApplication::EApplication() {
 	ptrGraphics = nullptr;
+
+	bHeadless_ = false;
+	exitCode_ = 0;
+	lastDigestStage_ = nullptr;
+	lastDigestFrame_ = 0;
+	countHeadlessFrame_ = 0;
 }
 EApplication::~EApplication() {
 }
@@ -20,10 +26,15 @@ bool EApplication::_Initialize() {
 	Logger::WriteTop("Initializing application.");
 
 	DnhConfiguration* config = DnhConfiguration::CreateInstance();
+	script_engine::optimize_enabled = config->bScriptOptimize_;
+	bHeadless_ = config->bHeadless_;
 
 	EFileManager* fileManager = EFileManager::CreateInstance();
 	fileManager->Initialize();
 
+	//Start the workers up front rather than on the first parallel loop
+	JobSystem::GetBase();
+
 	EFpsController* fpsController = EFpsController::CreateInstance();
 	fpsController->SetFastModeRate((size_t)config->fastModeSpeed_ * 60U);
 	
@@ -66,6 +77,8 @@ bool EApplication::_Initialize() {
 
 	EDirectSoundManager* soundManager = EDirectSoundManager::CreateInstance();
 	soundManager->Initialize(hWndDisplay);
+	if (bHeadless_)
+		soundManager->SetMute(true);
 
 	EDirectInput* input = EDirectInput::CreateInstance();
 	input->Initialize(hWndDisplay);
@@ -142,6 +155,18 @@ bool EApplication::_Initialize() {
 	logger->LoadState();
 	logger->SetWindowVisible(config->bLogWindow_);
 
+	if (bHeadless_) {
+		const std::wstring& pathHashLog = config->pathHeadlessHashLog_;
+		File::CreateFileDirectory(pathHashLog);
+
+		fileStateDigest_.reset(new File(pathHashLog));
+		if (!fileStateDigest_->Open(File::WRITEONLY))
+			throw gstd::wexception(L"Cannot open the state digest log: " + pathHashLog);
+
+		timeHeadlessStart_ = stdch::steady_clock::now();
+		Logger::WriteTop(L"Headless run: " + config->pathHeadlessReplay_);
+	}
+
 	SystemController* systemController = SystemController::CreateInstance();
 	systemController->Reset();
 
@@ -157,6 +182,9 @@ bool EApplication::_Loop() {
 	EDirectGraphics* graphics = EDirectGraphics::GetInstance();
 	DnhConfiguration* config = DnhConfiguration::GetInstance();
 
+	if (bHeadless_)
+		return _LoopHeadless();
+
 	HWND hWndFocused = ::GetForegroundWindow();
 	HWND hWndGraphics = graphics->GetWindowHandle();
 	HWND hWndLogger = logger->GetWindowHandle();
@@ -198,6 +226,9 @@ bool EApplication::_Loop() {
 			taskManager->CallWorkFunction();
 			taskManager->SetWorkTime(taskManager->GetTimeSpentOnLastFuncCall());
 
+			//Collected every frame so the figures always cover one logic frame
+			JobSystem::Statistics statJob = JobSystem::GetBase()->CollectStatistics();
+
 			if (logger->IsWindowVisible()) {
 				if (auto infoLog = logger->GetInfoPanel()) {
 					std::string fps = StringUtility::Format("Logic: %.2ffps, Render: %.2ffps",
@@ -218,6 +249,10 @@ bool EApplication::_Loop() {
 
 					infoLog->SetInfo(2, "Font cache",
 						std::to_string(EDxTextRenderer::GetInstance()->GetCacheCount()));
+					infoLog->SetInfo(3, "Parallel jobs", StringUtility::Format(
+						"%u dispatch(es), %u job(s), Wait: %.3fms, Work: %.3fms, Longest: %.3fms",
+						statJob.countDispatch, statJob.countJob,
+						statJob.timeWall, statJob.timeJob, statJob.timeJobMax));
 				}
 			}
 
@@ -256,6 +291,60 @@ bool EApplication::_Loop() {
 
 	return true;
 }
+bool EApplication::_LoopHeadless() {
+	ETaskManager* taskManager = ETaskManager::GetInstance();
+	EDirectInput* input = EDirectInput::GetInstance();
+
+	//No frame pacing and no rendering, the replay supplies all input
+	bWindowFocused_ = true;
+	input->ClearKeyState();
+
+	taskManager->CallWorkFunction();
+	taskManager->SetWorkTime(taskManager->GetTimeSpentOnLastFuncCall());
+
+	_WriteStateDigest();
+
+	if (countHeadlessFrame_ % 120 == 0)
+		taskManager->ArrangeTask();
+	++countHeadlessFrame_;
+
+	return true;
+}
+void EApplication::_WriteStateDigest() {
+	ETaskManager* taskManager = ETaskManager::GetInstance();
+
+	auto systemController = dptr_cast(StgSystemController, taskManager->GetTask(typeid(EStgSystemController)));
+	if (systemController == nullptr) return;
+	if (systemController->GetSystemInformation()->GetScene() != StgSystemInformation::SCENE_STG) return;
+
+	StgStageController* stageController = systemController->GetStageController();
+	if (stageController == nullptr) return;
+
+	//Exit code 2 marks a replay that played through but diverged from its recorded digests
+	if (stageController->IsReplayDesync() && exitCode_ == 0)
+		exitCode_ = 2;
+
+	//Paused or stalled stages do not advance the frame counter
+	DWORD frame = stageController->GetCurrentFrame();
+	if (stageController == lastDigestStage_ && frame == lastDigestFrame_) return;
+	lastDigestStage_ = stageController;
+	lastDigestFrame_ = frame;
+
+	StgStateDigest digest;
+	stageController->ComputeStateDigest(&digest);
+
+	std::string line = StringUtility::Format("%u %016llx", frame, digest.GetCombinedHash());
+	for (size_t iPart = 0; iPart < StgStateDigest::PART_COUNT; ++iPart)
+		line += StringUtility::Format(" %016llx", digest.listHash[iPart]);
+	line += "\n";
+
+	fileStateDigest_->WriteString(line);
+}
+void EApplication::AbortHeadless(const std::wstring& msg) {
+	Logger::WriteTop(L"Headless run aborted: " + msg);
+	exitCode_ = 1;
+	End();
+}
 void EApplication::_RenderDisplay() {
 	EDirectGraphics* graphics = EDirectGraphics::GetInstance();
 	IDirect3DDevice9* device = graphics->GetDevice();
@@ -405,6 +494,13 @@ bool EApplication::_Finalize() {
 	Logger::WriteTop("Finalizing application.");
 
 	secondaryBackBuffer_ = nullptr;
+
+	if (bHeadless_) {
+		double sec = stdch::duration<double>(stdch::steady_clock::now() - timeHeadlessStart_).count();
+		Logger::WriteTop(StringUtility::Format(L"Headless run finished: %llu frame(s) in %.3fs, exit code %d",
+			countHeadlessFrame_, sec, exitCode_));
+		fileStateDigest_ = nullptr;
+	}
 	//EDirectGraphics::GetBase()->ResetDisplaySettings();
 
 	ELogger* logger = ELogger::GetInstance();
@@ -464,8 +560,13 @@ bool EDirectGraphics::Initialize(const std::wstring& windowTitle) {
 	dxConfig.bUseRef = dnhConfig->bUseRef_;
 	dxConfig.typeMultiSample = dnhConfig->multiSamples_;
 	dxConfig.bBorderlessFullscreen = dnhConfig->bPseudoFullscreen_;
+	if (dnhConfig->bHeadless_) {
+		dxConfig.bShowWindow = false;
+		dxConfig.bUseNullDevice = true;
+		dxConfig.bVSync = false;
+	}
 
-	{
+	if (!dnhConfig->bHeadless_) {
 		RECT rcMonitor = WindowBase::GetPrimaryMonitorRect();
 
 		LONG monitorWd = rcMonitor.right - rcMonitor.left;
@@ -521,7 +622,8 @@ bool EDirectGraphics::Initialize(const std::wstring& windowTitle) {
 		SetWindowTitle(windowTitle);
 
 		ChangeScreenMode(screenMode, false);
-		SetWindowVisible(true);
+		if (!dnhConfig->bHeadless_)
+			SetWindowVisible(true);
 	}
 
 	return res;
@@ -11,6 +11,7 @@
 //EApplication
 //*******************************************************************
 class EDirectGraphics;
+class StgStageController;
 class EApplication : public Singleton<EApplication>, public Application {
 	friend Singleton<EApplication>;
 protected:
@@ -19,8 +20,19 @@ protected:
 	bool bWindowFocused_;
 
 	shared_ptr<Texture> secondaryBackBuffer_;
+
+	bool bHeadless_;
+	int exitCode_;
+	unique_ptr<File> fileStateDigest_;
+	StgStageController* lastDigestStage_;
+	DWORD lastDigestFrame_;
+	uint64_t countHeadlessFrame_;
+	stdch::steady_clock::time_point timeHeadlessStart_;
 protected:
 	void _RenderDisplay();
+
+	bool _LoopHeadless();
+	void _WriteStateDigest();
 public:
 	EApplication();
 	~EApplication();
@@ -33,6 +45,10 @@ public:
 
 	bool IsWindowFocused() { return bWindowFocused_; }
 
+	bool IsHeadless() { return bHeadless_; }
+	int GetExitCode() { return exitCode_; }
+	void AbortHeadless(const std::wstring& msg);
+
 	void SetSecondaryBackBuffer(shared_ptr<Texture> texture) { secondaryBackBuffer_ = texture; }
 };
 
@@ -7,6 +7,18 @@
 //EStgSystemController
 //*******************************************************************
 void EStgSystemController::DoEnd() {
+	EApplication* app = EApplication::GetInstance();
+	if (app->IsHeadless()) {
+		if (infoSystem_->IsError())
+			app->AbortHeadless(infoSystem_->GetErrorMessage());
+		else
+			app->End();
+
+		ETaskManager* taskManager = ETaskManager::GetInstance();
+		taskManager->RemoveTask(typeid(EStgSystemController));
+		return;
+	}
+
 	SystemController* systemController = SystemController::GetInstance();
 	systemController->GetSceneManager()->TransScriptSelectScene_Last();
 	systemController->ResetWindowTitle();
@@ -32,6 +32,11 @@ void SystemController::Reset() {
 	fileManager->ClearArchiveFileCache();
 
 	DnhConfiguration* config = DnhConfiguration::CreateInstance();
+	if (config->bHeadless_) {
+		_StartHeadlessReplay();
+		return;
+	}
+
 	const std::wstring& pathPackageScript = config->pathPackageScript_;
 	if (pathPackageScript.size() == 0) {
 		infoSystem_->UpdateFreePlayerScriptInformationList();
@@ -45,6 +50,27 @@ void SystemController::Reset() {
 			sceneManager_->TransPackageScene(info, true);
 	}
 }
+void SystemController::_StartHeadlessReplay() {
+	DnhConfiguration* config = DnhConfiguration::GetInstance();
+	const std::wstring& pathScript = config->pathHeadlessScript_;
+	const std::wstring& pathReplay = config->pathHeadlessReplay_;
+
+	infoSystem_->UpdateFreePlayerScriptInformationList();
+
+	ref_count_ptr<ScriptInformation> infoMain = ScriptInformation::CreateScriptInformation(pathScript, false);
+	if (infoMain == nullptr) {
+		ShowErrorDialog(L"Headless: " + ErrorUtility::GetFileNotFoundErrorMessage(pathScript, true));
+		return;
+	}
+
+	ref_count_ptr<ReplayInformation> infoReplay = ReplayInformation::CreateFromFile(pathReplay);
+	if (infoReplay == nullptr) {
+		ShowErrorDialog(L"Headless: " + ErrorUtility::GetFileNotFoundErrorMessage(pathReplay, true));
+		return;
+	}
+
+	sceneManager_->TransStgScene(infoMain, infoReplay);
+}
 void SystemController::ClearTaskWithoutSystem() {
 	std::set<const std::type_info*> listInfo;
 	listInfo.insert(&typeid(SystemTransitionEffectTask));
@@ -54,6 +80,12 @@ void SystemController::ClearTaskWithoutSystem() {
 	taskManager->RemoveTaskWithoutTypeInfo(listInfo);
 }
 void SystemController::ShowErrorDialog(const std::wstring& msg) {
+	EApplication* app = EApplication::GetInstance();
+	if (app->IsHeadless()) {
+		app->AbortHeadless(msg);
+		return;
+	}
+
 	HWND hParent = EDirectGraphics::GetInstance()->GetAttachedWindowHandle();
 	ErrorDialog dialog(hParent);
 	dialog.ShowModal(msg);
@@ -18,6 +18,8 @@ private:
 	unique_ptr<SceneManager> sceneManager_;
 	unique_ptr<TransitionManager> transitionManager_;
 	unique_ptr<SystemInformation> infoSystem_;
+
+	void _StartHeadlessReplay();
 public:
 	SystemController();
 	virtual ~SystemController();
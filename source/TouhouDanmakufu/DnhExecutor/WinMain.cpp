@@ -7,6 +7,8 @@
 //*******************************************************************
 int APIENTRY wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLine, int nCmdShow) {
 	HWND handleWindow = nullptr;
+	int exitCode = 0;
+	bool bHeadless = false;
 
 	try {
 		gstd::SystemUtility::InitializeCOM();
@@ -14,6 +16,7 @@ int APIENTRY wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmd
 
 		directx::EDirect3D9::CreateInstance();
 		DnhConfiguration* config = DnhConfiguration::CreateInstance();
+		bHeadless = config->bHeadless_;
 
 		ELogger* logger = ELogger::CreateInstance();
 		logger->Initialize(config->bLogFile_, config->bLogWindow_);
@@ -35,15 +38,20 @@ int APIENTRY wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmd
 			bool bFinalize = app->_Finalize();
 			if (!bFinalize)
 				throw gstd::wexception("Finalization failure.");
+			exitCode = app->GetExitCode();
 		}
 	}
 	catch (std::exception& e) {
-		MessageBox(handleWindow, StringUtility::ConvertMultiToWide(e.what()).c_str(),
-			L"Unexpected Error", MB_ICONERROR | MB_APPLMODAL | MB_OK);
+		exitCode = 1;
+		if (!bHeadless)
+			MessageBox(handleWindow, StringUtility::ConvertMultiToWide(e.what()).c_str(),
+				L"Unexpected Error", MB_ICONERROR | MB_APPLMODAL | MB_OK);
 	}
 	catch (gstd::wexception& e) {
-		MessageBox(handleWindow, e.what(), 
-			L"Engine Error", MB_ICONERROR | MB_APPLMODAL | MB_OK);
+		exitCode = 1;
+		if (!bHeadless)
+			MessageBox(handleWindow, e.what(), 
+				L"Engine Error", MB_ICONERROR | MB_APPLMODAL | MB_OK);
 	}
 
 	EApplication::DeleteInstance();
@@ -55,5 +63,5 @@ int APIENTRY wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmd
 	gstd::SystemUtility::UninitializeCOM();
 	gstd::DebugUtility::DumpMemoryLeaksOnExit();
 
-	return 0;
+	return exitCode;
 }